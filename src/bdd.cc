@@ -20,6 +20,11 @@
 
 #include "bdd.h"
 
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <unordered_set>
+
 #include <boost/multiprecision/miller_rabin.hpp>
 #include <boost/range/algorithm.hpp>
 
@@ -38,12 +43,40 @@ int GetPrimeNumber(int n) {
   return n;
 }
 
-Bdd::Bdd(const Pdag* graph, const Settings& settings)
+namespace {
+
+/// The minimum number of vertices in the unique table to trigger reordering.
+const int kReorderingThreshold = 1 << 12;
+
+/// @param[in] settings  The analysis settings with the BDD memory budget.
+/// @param[in] num_jobs  The number of jobs sharing the budget.
+///
+/// @returns The maximum number of entries in a single Apply cache table.
+template <class Table>
+int GetMaxCacheCapacity(const Settings& settings, int num_jobs) {
+  const std::size_t kNumTables = 2;  // AND and OR tables share the budget.
+  std::size_t max_capacity =
+      (std::size_t(settings.bdd_memory()) << 20) /
+      (num_jobs * kNumTables * sizeof(typename Table::value_type));
+  return std::min<std::size_t>(std::max<std::size_t>(max_capacity, 1),
+                               std::numeric_limits<int>::max());
+}
+
+}  // namespace
+
+Bdd::Bdd(const Settings& settings, int num_jobs)
     : kSettings_(settings),
-      coherent_(graph->coherent()),
+      coherent_(false),
+      and_table_(1000, GetMaxCacheCapacity<ComputeTable>(settings, num_jobs)),
+      or_table_(1000, GetMaxCacheCapacity<ComputeTable>(settings, num_jobs)),
       kOne_(new Terminal<Ite>(true)),
-      function_id_(2) {
+      function_id_(2),
+      reordering_threshold_(kReorderingThreshold),
+      convert_modules_(num_jobs == 1) {}
+
+Bdd::Bdd(const Pdag* graph, const Settings& settings) : Bdd(settings, 1) {
   TIMER(DEBUG3, "Converting PDAG into BDD");
+  coherent_ = graph->coherent();
   if (graph->IsTrivial()) {
     const Gate& top_gate = graph->root();
     assert(top_gate.args().size() == 1);
@@ -59,16 +92,21 @@ Bdd::Bdd(const Pdag* graph, const Settings& settings)
       index_to_order_.emplace(var.index(), var.order());
     }
   } else {
-    std::unordered_map<int, std::pair<Function, int>> gates;
-    root_ = ConvertGraph(graph->root(), &gates);
+    root_ = ConvertModules(graph->root());
     root_.complement ^= graph->complement();
   }
   ClearMarks(false);
   TestStructure(root_.vertex);
   LOG(DEBUG4) << "# of BDD vertices created: " << function_id_ - 1;
+  LOG(DEBUG4) << "Memory reserved for BDD vertices: "
+              << Ite::pool_capacity() / 1024 << " KiB";
   LOG(DEBUG4) << "# of entries in unique table: " << unique_table_.size();
   LOG(DEBUG4) << "# of entries in AND table: " << and_table_.size();
   LOG(DEBUG4) << "# of entries in OR table: " << or_table_.size();
+  LOG(DEBUG4) << "# of Apply cache hits: " << cache_statistics().hits;
+  LOG(DEBUG4) << "# of Apply cache misses: " << cache_statistics().misses;
+  LOG(DEBUG4) << "# of Apply cache evictions: "
+              << cache_statistics().evictions;
   ClearMarks(false);
   LOG(DEBUG4) << "# of ITE in BDD: " << CountIteNodes(root_.vertex);
   ClearMarks(false);
@@ -82,7 +120,7 @@ Bdd::Bdd(const Pdag* graph, const Settings& settings)
 Bdd::~Bdd() noexcept = default;
 
 void Bdd::Analyze(const Pdag* graph) noexcept {
-  zbdd_ = std::make_unique<Zbdd>(this, kSettings_);
+  zbdd_ = std::make_unique<Zbdd>(this, kSettings_, graph);
   zbdd_->Analyze(graph);
   if (!coherent_)  // The BDD has been used by the ZBDD.
     Freeze();
@@ -121,8 +159,8 @@ ItePtr Bdd::FindOrAddVertex(const Gate& gate, const VertexPtr& high,
                             const VertexPtr& low,
                             bool complement_edge) noexcept {
   assert(gate.module() && "Only module gates are expected for proxies.");
-  ItePtr in_table =
-      FindOrAddVertex(gate.index(), high, low, complement_edge, gate.order());
+  ItePtr in_table = FindOrAddVertex(gate.index(), high, low, complement_edge,
+                                    GetOrder(gate.index(), gate.order()));
   if (in_table->unique()) {
     in_table->module(gate.module());
     in_table->coherent(gate.coherent());
@@ -149,16 +187,18 @@ Bdd::Function Bdd::ConvertGraph(
   std::vector<Function> args;
   for (const Gate::ConstArg<Variable>& arg : gate.args<Variable>()) {
     args.push_back(
-        {arg.first < 0, FindOrAddVertex(arg.second.index(), kOne_, kOne_, true,
-                                        arg.second.order())});
-    index_to_order_.emplace(arg.second.index(), arg.second.order());
+        {arg.first < 0,
+         FindOrAddVertex(arg.second.index(), kOne_, kOne_, true,
+                         GetOrder(arg.second.index(), arg.second.order()))});
   }
   for (const Gate::ConstArg<Gate>& arg : gate.args<Gate>()) {
-    Function res = ConvertGraph(arg.second, gates);
     if (arg.second.module()) {
+      if (convert_modules_)
+        ConvertGraph(arg.second, gates);
       args.push_back(
           {arg.first < 0, FindOrAddVertex(arg.second, kOne_, kOne_, true)});
     } else {
+      Function res = ConvertGraph(arg.second, gates);
       bool complement = (arg.first < 0) ^ res.complement;
       args.push_back({complement, res.vertex});
     }
@@ -176,6 +216,7 @@ Bdd::Function Bdd::ConvertGraph(
                    it->complement);
   }
   ClearTables();
+  TryReorderVariables();
   assert(result.vertex);
   if (gate.module())
     modules_.emplace(gate.index(), result);
@@ -184,6 +225,307 @@ Bdd::Function Bdd::ConvertGraph(
   return result;
 }
 
+Bdd::Function Bdd::ConvertModules(const Gate& root) {
+  // The root gate is a module even without the flag.
+  std::vector<std::pair<const Gate*, int>> modules = {{&root, 0}};
+  std::unordered_set<int> visited = {root.index()};
+  for (int i = 0; i < modules.size() && kSettings_.num_jobs() > 1; ++i) {
+    std::vector<const Gate*> stack = {modules[i].first};
+    while (!stack.empty()) {
+      const Gate* gate = stack.back();
+      stack.pop_back();
+      modules[i].second += gate->args().size();  // The estimate of the size.
+      for (const Gate::ConstArg<Gate>& arg : gate->args<Gate>()) {
+        if (!visited.insert(arg.second.index()).second)
+          continue;
+        if (arg.second.module()) {
+          modules.push_back({&arg.second, 0});
+        } else {
+          stack.push_back(&arg.second);
+        }
+      }
+    }
+  }
+  int num_jobs = std::min<int>(kSettings_.num_jobs(), modules.size());
+  if (num_jobs == 1) {
+    std::unordered_map<int, std::pair<Function, int>> gates;
+    return ConvertGraph(root, &gates);
+  }
+  boost::stable_sort(modules, [](const std::pair<const Gate*, int>& lhs,
+                                 const std::pair<const Gate*, int>& rhs) {
+    return lhs.second > rhs.second;  // Larger modules start first.
+  });
+
+  LOG(DEBUG4) << "Converting " << modules.size() << " modules in " << num_jobs
+              << " jobs...";
+  Function result;
+  std::atomic<int> next_module = 0;
+  auto run_job = [&](Bdd* job) {
+    for (int i = next_module++; i < modules.size(); i = next_module++) {
+      std::unordered_map<int, std::pair<Function, int>> gates;
+      Function function = job->ConvertGraph(*modules[i].first, &gates);
+      if (modules[i].first == &root)
+        result = function;
+    }
+  };
+  std::vector<std::unique_ptr<Bdd>> jobs;
+  std::vector<std::thread> threads;
+  threads.reserve(num_jobs);
+  for (int i = 0; i < num_jobs; ++i) {
+    jobs.emplace_back(new Bdd(kSettings_, num_jobs));
+    threads.emplace_back(run_job, jobs.back().get());
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+  for (const std::unique_ptr<Bdd>& job : jobs)
+    Merge(job.get());
+  if (result.vertex->terminal())
+    result.vertex = kOne_;
+  return result;
+}
+
+void Bdd::Merge(Bdd* job) noexcept {
+  auto relink = [this](const VertexPtr& vertex) {
+    return vertex->terminal() ? VertexPtr(kOne_) : vertex;
+  };
+  std::vector<ItePtr> vertices = job->unique_table_.GatherVertices();
+  job->Freeze();  // The vertices leave the job tables.
+  unique_table_.reserve(unique_table_.size() + vertices.size());
+  for (const ItePtr& ite : vertices) {
+    ite->id(function_id_++);
+    if (ite->high()->terminal() || ite->low()->terminal()) {
+      bool module = ite->module();
+      bool coherent = ite->coherent();
+      ite->Rebind(ite->index(), ite->order(), relink(ite->high()),
+                  relink(ite->low()));
+      ite->module(module);
+      ite->coherent(coherent);
+    }
+  }
+  // The signatures are complete only after all the vertices are re-identified.
+  for (ItePtr& ite : vertices) {
+    IteWeakPtr& in_table = unique_table_.FindOrAdd(
+        ite->index(), get_high_id(*ite), get_low_id(*ite));
+    assert(in_table.expired() && "Modules with common vertices.");
+    in_table = ite;
+  }
+  for (const std::pair<const int, Function>& module : job->modules_)
+    modules_.emplace(module.first,
+                     Function{module.second.complement,
+                              relink(module.second.vertex)});
+  index_to_order_.insert(job->index_to_order_.begin(),
+                         job->index_to_order_.end());
+  job_statistics_ += job->cache_statistics();
+}
+
+void Bdd::TryReorderVariables() noexcept {
+  if (!kSettings_.reordering() || unique_table_.size() < reordering_threshold_)
+    return;
+  int num_vertices = ReorderVariables();
+  reordering_threshold_ =
+      2 * std::max({num_vertices, unique_table_.size(), kReorderingThreshold});
+}
+
+int Bdd::ReorderVariables() noexcept {
+  TIMER(DEBUG4, "Reordering BDD variables");
+  std::vector<std::pair<int, int>> ordering(index_to_order_.begin(),
+                                            index_to_order_.end());
+  boost::sort(ordering, [](const std::pair<int, int>& lhs,
+                           const std::pair<int, int>& rhs) {
+    return lhs.second < rhs.second;
+  });
+  std::vector<VariableLevel> levels;
+  std::unordered_map<int, int> order_to_position;
+  for (const std::pair<int, int>& entry : ordering) {
+    order_to_position.emplace(entry.second, levels.size());
+    levels.push_back({entry.first, false, false, {}});
+  }
+  int num_vertices = 0;
+  for (ItePtr& ite : unique_table_.GatherVertices()) {
+    VariableLevel& level = levels[order_to_position.at(ite->order())];
+    assert(level.index == ite->index() && "Inconsistent variable orders.");
+    level.module = ite->module();
+    level.coherent = ite->coherent();
+    level.vertices.push_back(std::move(ite));
+    ++num_vertices;
+  }
+  LOG(DEBUG5) << "# of BDD vertices before reordering: " << num_vertices;
+
+  // Variables of disjoint graphs (modules) never share paths,
+  // so the variables are sifted only among the levels of the same graph.
+  std::vector<int> roots(levels.size());  // Disjoint sets of levels.
+  std::iota(roots.begin(), roots.end(), 0);
+  auto find_root = [&roots](int position) {
+    while (roots[position] != position)
+      position = roots[position] = roots[roots[position]];
+    return position;
+  };
+  for (int i = 0; i < levels.size(); ++i) {
+    for (const ItePtr& ite : levels[i].vertices) {
+      for (const VertexPtr& child : {ite->high(), ite->low()}) {
+        if (child->terminal())
+          continue;
+        int position = order_to_position.at(Ite::Ref(child).order());
+        roots[find_root(position)] = find_root(i);
+      }
+    }
+  }
+  std::vector<std::vector<int>> groups(levels.size());
+  for (int i = 0; i < levels.size(); ++i) {
+    if (!levels[i].vertices.empty())
+      groups[find_root(i)].push_back(i);
+  }
+  for (const std::vector<int>& positions : groups) {
+    if (positions.size() < 2)
+      continue;
+    std::vector<int> orders;
+    std::vector<VariableLevel> group;
+    for (int position : positions) {
+      orders.push_back(ordering[position].second);
+      group.push_back(std::move(levels[position]));
+    }
+    num_vertices += SiftLevels(orders, &group);
+    for (int i = 0; i < group.size(); ++i)
+      index_to_order_[group[i].index] = orders[i];
+  }
+  LOG(DEBUG5) << "# of BDD vertices after reordering: " << num_vertices;
+  return num_vertices;
+}
+
+int Bdd::SiftLevels(const std::vector<int>& orders,
+                    std::vector<VariableLevel>* levels) noexcept {
+  int num_vertices = 0;
+  for (const VariableLevel& level : *levels)
+    num_vertices += level.vertices.size();
+  const int init_num_vertices = num_vertices;
+  const int last = levels->size() - 1;
+  auto swap = [&](int position) {
+    num_vertices += SwapLevels(orders[position], orders[position + 1],
+                               &(*levels)[position], &(*levels)[position + 1]);
+  };
+
+  std::vector<std::pair<int, int>> variables;  // Indices and level sizes.
+  for (const VariableLevel& level : *levels)
+    variables.emplace_back(level.index, level.vertices.size());
+  boost::stable_sort(variables, [](const std::pair<int, int>& lhs,
+                                   const std::pair<int, int>& rhs) {
+    return lhs.second > rhs.second;  // Sifting starts with the largest.
+  });
+  const double kMaxGrowth = 1.2;  // The limit on the temporary size increase.
+  for (const std::pair<int, int>& variable : variables) {
+    int position = std::distance(
+        levels->begin(),
+        boost::find_if(*levels, [&variable](const VariableLevel& level) {
+          return level.index == variable.first;
+        }));
+    int best_position = position;
+    int best_num_vertices = num_vertices;
+    auto sift = [&](int end) {
+      while (position != end && num_vertices <= kMaxGrowth * best_num_vertices) {
+        if (position < end) {
+          swap(position++);
+        } else {
+          swap(--position);
+        }
+        if (num_vertices < best_num_vertices) {
+          best_num_vertices = num_vertices;
+          best_position = position;
+        }
+      }
+    };
+    if (position > last / 2) {  // Closer to the bottom.
+      sift(last);
+      sift(0);
+    } else {
+      sift(0);
+      sift(last);
+    }
+    while (position < best_position)
+      swap(position++);
+    while (position > best_position)
+      swap(--position);
+    assert(num_vertices == best_num_vertices && "Non-canonical BDD.");
+  }
+  return num_vertices - init_num_vertices;
+}
+
+int Bdd::SwapLevels(int upper_order, int lower_order, VariableLevel* upper,
+                    VariableLevel* lower) noexcept {
+  int num_vertices = upper->vertices.size() + lower->vertices.size();
+  auto is_lower = [lower_order](const VertexPtr& vertex) {
+    return !vertex->terminal() && Ite::Ref(vertex).order() == lower_order;
+  };
+  // The cofactors of a function with respect to the lower variable.
+  auto get_cofactors = [&is_lower](const VertexPtr& vertex, bool complement) {
+    if (!is_lower(vertex))
+      return std::pair<Function, Function>{{complement, vertex},
+                                           {complement, vertex}};
+    const Ite& ite = Ite::Ref(vertex);
+    bool low_complement = complement ^ ite.complement_edge();
+    return std::pair<Function, Function>{{complement, ite.high()},
+                                         {low_complement, ite.low()}};
+  };
+
+  std::vector<ItePtr> swapped;  // The upper vertices with lower variables.
+  std::vector<ItePtr> moved;  // The upper vertices that move down as is.
+  for (ItePtr& ite : upper->vertices) {
+    if (is_lower(ite->high()) || is_lower(ite->low())) {
+      swapped.push_back(std::move(ite));
+    } else {
+      ite->order(lower_order);
+      moved.push_back(std::move(ite));
+    }
+  }
+  for (const ItePtr& ite : swapped) {
+    unique_table_.Erase(ite->index(), ite->high()->id(), get_low_id(*ite));
+    auto [high_high, high_low] = get_cofactors(ite->high(), false);
+    auto [low_high, low_low] =
+        get_cofactors(ite->low(), ite->complement_edge());
+    Function high =
+        GetReducedFunction(*upper, lower_order, high_high, low_high, &moved);
+    Function low =
+        GetReducedFunction(*upper, lower_order, high_low, low_low, &moved);
+    assert(!high.complement && "High edges are never complement.");
+    ite->Rebind(lower->index, upper_order, high.vertex, low.vertex);
+    ite->complement_edge(low.complement);
+    ite->module(lower->module);
+    ite->coherent(lower->coherent);
+    IteWeakPtr& in_table = unique_table_.FindOrAdd(
+        ite->index(), ite->high()->id(), get_low_id(*ite));
+    assert(in_table.expired() && "Duplicate vertex after the swap.");
+    in_table = ite;
+  }
+  for (ItePtr& ite : lower->vertices) {
+    if (ite->unique())  // Only the level keeps the vertex alive.
+      continue;
+    ite->order(upper_order);
+    swapped.push_back(std::move(ite));
+  }
+  upper->vertices = std::move(moved);
+  lower->vertices = std::move(swapped);  // Releases the dead vertices.
+  std::swap(*upper, *lower);
+  return static_cast<int>(upper->vertices.size() + lower->vertices.size()) -
+         num_vertices;
+}
+
+Bdd::Function Bdd::GetReducedFunction(const VariableLevel& level, int order,
+                                      const Function& high,
+                                      const Function& low,
+                                      std::vector<ItePtr>* created) noexcept {
+  if (high.vertex->id() == low.vertex->id() &&
+      high.complement == low.complement) {
+    return high;
+  }
+  ItePtr ite = FindOrAddVertex(level.index, high.vertex, low.vertex,
+                               high.complement ^ low.complement, order);
+  if (ite->unique()) {
+    ite->module(level.module);
+    ite->coherent(level.coherent);
+    created->push_back(ite);
+  }
+  return {high.complement, ite};
+}
+
 std::pair<int, int> Bdd::GetMinMaxId(const VertexPtr& arg_one,
                                      const VertexPtr& arg_two,
                                      bool complement_one,
@@ -21,9 +21,10 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 
 #include <algorithm>
-#include <forward_list>
+#include <limits>
 #include <memory>
 #include <unordered_map>
 #include <utility>
@@ -33,6 +34,7 @@
 #include <boost/noncopyable.hpp>
 #include <boost/smart_ptr/intrusive_ptr.hpp>
 
+#include "ext/pool.h"
 #include "pdag.h"
 #include "settings.h"
 
@@ -105,6 +107,30 @@ class WeakIntrusivePtr final : private boost::noncopyable {
     return *this;
   }
 
+  /// Moves the table entry of the vertex
+  /// for relocation of weak pointers in table containers.
+  ///
+  /// @param[in,out] other  The weak pointer to be expired.
+  WeakIntrusivePtr(WeakIntrusivePtr&& other) noexcept
+      : vertex_(other.vertex_) {
+    other.vertex_ = nullptr;
+    if (vertex_)
+      vertex_->table_ptr_ = this;
+  }
+
+  /// Move assignment for relocation of weak pointers.
+  ///
+  /// @param[in,out] other  The weak pointer to be expired.
+  ///
+  /// @returns Reference to this.
+  WeakIntrusivePtr& operator=(WeakIntrusivePtr&& other) noexcept {
+    if (this != &other) {
+      this->~WeakIntrusivePtr();
+      new (this) WeakIntrusivePtr(std::move(other));
+    }
+    return *this;
+  }
+
   /// Communicates the pointer destruction to the vertex.
   ~WeakIntrusivePtr() noexcept {
     if (vertex_)
@@ -172,6 +198,14 @@ class Vertex : private boost::noncopyable {
   /// @returns Identifier of the BDD graph rooted by this vertex.
   int id() const { return id_; }
 
+  /// Re-identifies the graph upon the transfer of the vertex into another BDD.
+  ///
+  /// @param[in] value  The identifier unique in the receiving BDD.
+  void id(int value) {
+    assert(!terminal() && value > 1 && "Terminal ids are fixed.");
+    id_ = value;
+  }
+
   /// @returns true if this vertex is terminal.
   bool terminal() const { return id_ < 2; }
 
@@ -272,6 +306,35 @@ class NonTerminal : public Vertex<T>, public IntrusivePtrCast<T> {
     return order_;
   }
 
+  /// Moves the vertex to another position in the variable ordering.
+  ///
+  /// @param[in] value  The new positive order of the vertex variable.
+  void order(int value) {
+    assert(value > 0);
+    order_ = value;
+  }
+
+  /// Replaces the variable and branches of this vertex in place
+  /// upon swapping of adjacent variables in the ordering.
+  /// The vertex keeps its id and parents
+  /// because the function of the vertex is not supposed to change.
+  ///
+  /// @param[in] index  The index of the new variable.
+  /// @param[in] order  The order of the new variable.
+  /// @param[in] high  The new high vertex.
+  /// @param[in] low  The new low vertex.
+  ///
+  /// @post The module and coherence flags are reset.
+  void Rebind(int index, int order, const VertexPtr& high,
+              const VertexPtr& low) {
+    index_ = index;
+    this->order(order);
+    high_ = high;
+    low_ = low;
+    module_ = false;
+    coherent_ = false;
+  }
+
   /// @returns true if this vertex represents a module gate.
   bool module() const { return module_; }
 
@@ -303,6 +366,33 @@ class NonTerminal : public Vertex<T>, public IntrusivePtrCast<T> {
   /// @param[in] flag  A flag with the meaning for the user of marks.
   void mark(bool flag) { mark_ = flag; }
 
+  /// Allocates vertices in contiguous memory blocks
+  /// without the overhead of the general-purpose allocator.
+  ///
+  /// @param[in] size  The size of the vertex object.
+  ///
+  /// @returns Memory for the vertex.
+  static void* operator new(std::size_t size) {
+    if (size != sizeof(T))  // Derived classes are not pooled.
+      return ::operator new(size);
+    return ext::fixed_size_pool<sizeof(T), alignof(T)>::allocate();
+  }
+
+  /// Returns the memory of the vertex back into the pool.
+  ///
+  /// @param[in] ptr  The memory of the vertex.
+  /// @param[in] size  The size of the vertex object.
+  static void operator delete(void* ptr, std::size_t size) noexcept {
+    if (size != sizeof(T))
+      return ::operator delete(ptr);
+    ext::fixed_size_pool<sizeof(T), alignof(T)>::deallocate(ptr);
+  }
+
+  /// @returns The memory in bytes reserved for vertices of this type.
+  static std::size_t pool_capacity() {
+    return ext::fixed_size_pool<sizeof(T), alignof(T)>::capacity();
+  }
+
  protected:
   ~NonTerminal() = default;
 
@@ -382,9 +472,15 @@ int GetPrimeNumber(int n);
 ///
 /// Each vertex must have a unique signature
 /// consisting of its index, special high and low ids.
-/// This signature is the key of the hash table;
-/// however, it is not duplicated in the table.
-/// The key is retrieved from the vertex as needed.
+/// This signature is the key of the hash table.
+/// The key is duplicated in the table entries
+/// so that probing does not dereference vertices scattered in memory.
+///
+/// The table uses open addressing with linear probing
+/// over a contiguous array of entries with a power-of-two capacity.
+/// The entries of deleted vertices (expired weak pointers)
+/// are tombstones to be reused by new vertices
+/// or dropped upon rehashing.
 ///
 /// High and low ids are retrieved through unqualified calls
 /// to get_high_id(const T&) and get_low_id(const T&).
@@ -394,29 +490,42 @@ int GetPrimeNumber(int n);
 /// @tparam T  The type of the main functional BDD vertex.
 template <class T>
 class UniqueTable {
-  /// Convenient aliases and customization points.
-  /// @{
-  using Bucket = std::forward_list<WeakIntrusivePtr<T>>;
-  using Table = std::vector<Bucket>;
-  /// @}
+  /// The table slot with the vertex signature.
+  /// Slots with 0 index have never been occupied.
+  struct Entry {
+    WeakIntrusivePtr<T> vertex;  ///< The vertex with the signature.
+    int index = 0;  ///< The index of the vertex variable.
+    int high_id = 0;  ///< The id of the high vertex.
+    int low_id = 0;  ///< The id of the low vertex.
+  };
+  using Table = std::vector<Entry>;  ///< The contiguous array of slots.
 
  public:
   /// Constructor for small graphs.
   ///
   /// @param[in] init_capacity  The starting capacity for the table.
-  explicit UniqueTable(int init_capacity = 1000)
-      : capacity_(core::GetPrimeNumber(init_capacity)),
+  explicit UniqueTable(int init_capacity = 1024)
+      : capacity_(GetCapacity(init_capacity)),
         size_(0),
         max_load_factor_(0.75),
         table_(capacity_) {}
 
-  /// @returns The current number of entries.
+  /// @returns The current number of occupied slots
+  ///          including the entries of deleted vertices.
   int size() const { return size_; }
 
+  /// Prepares the table for more vertices.
+  ///
+  /// @param[in] n  The number of expected live vertices.
+  void reserve(int n) {
+    if (n >= capacity_ / 2)
+      Rehash(GetCapacity(2 * n + 1));
+  }
+
   /// Erases all entries.
   void clear() {
-    for (Bucket& chain : table_)
-      chain.clear();
+    for (Entry& entry : table_)
+      entry = Entry();
     size_ = 0;
   }
 
@@ -432,6 +541,37 @@ class UniqueTable {
   ///       such as its size and capacity.
   void Release() { table_ = Table(); }
 
+  /// @returns Shared pointers to all live vertices in the table.
+  std::vector<IntrusivePtr<T>> GatherVertices() const {
+    std::vector<IntrusivePtr<T>> vertices;
+    for (const Entry& entry : table_) {
+      if (!entry.vertex.expired())
+        vertices.push_back(entry.vertex.lock());
+    }
+    return vertices;
+  }
+
+  /// Removes the vertex with the signature from the table
+  /// before changing the signature of the vertex in place.
+  ///
+  /// @param[in] index  Index of the variable.
+  /// @param[in] high_id  The id of the high vertex.
+  /// @param[in] low_id  The id of the low vertex.
+  ///
+  /// @pre The vertex with the signature is in the table.
+  void Erase(int index, int high_id, int low_id) noexcept {
+    for (int pos = Hash(index, high_id, low_id) & (capacity_ - 1);;
+         pos = (pos + 1) & (capacity_ - 1)) {
+      Entry& entry = table_[pos];
+      assert(entry.index && "The vertex is not in the table.");
+      if (!entry.vertex.expired() && entry.index == index &&
+          entry.high_id == high_id && entry.low_id == low_id) {
+        entry.vertex = WeakIntrusivePtr<T>();  // Leaves a tombstone.
+        return;
+      }
+    }
+  }
+
   /// Finds an existing BDD vertex or
   /// inserts a default constructed weak pointer for a new vertex.
   /// Proper initialization of the new vertex is responsibility of the BDD.
@@ -439,8 +579,8 @@ class UniqueTable {
   /// Insertion operation may trigger resizing and rehashing.
   /// Rehashing eliminates expired weak pointers.
   ///
-  /// Collision resolution may also (opportunistically) remove
-  /// expired pointers in the chain.
+  /// The slot of an expired pointer met during probing
+  /// is reused for the new vertex.
   ///
   /// @param[in] index  Index of the variable.
   /// @param[in] high_id  The id of the high vertex.
@@ -448,98 +588,95 @@ class UniqueTable {
   ///
   /// @returns Reference to the weak pointer.
   WeakIntrusivePtr<T>& FindOrAdd(int index, int high_id, int low_id) noexcept {
+    assert(index && "The index 0 marks empty slots.");
     if (size_ >= (max_load_factor_ * capacity_))
-      Rehash(GetNextCapacity(capacity_));
-
-    int bucket_number = Hash(index, high_id, low_id) % capacity_;
-    Bucket& chain = table_[bucket_number];
-    auto it_prev = chain.before_begin();  // Parent.
-    for (auto it_cur = chain.begin(), it_end = chain.end(); it_cur != it_end;) {
-      if (it_cur->expired()) {
-        it_cur = chain.erase_after(it_prev);
-        --size_;
-      } else {
-        T* vertex = it_cur->get();
-        if (index == vertex->index() && high_id == get_high_id(*vertex) &&
-            low_id == get_low_id(*vertex)) {
-          return *it_cur;
+      Rehash();
+
+    Entry* tombstone = nullptr;
+    for (int pos = Hash(index, high_id, low_id) & (capacity_ - 1);;
+         pos = (pos + 1) & (capacity_ - 1)) {
+      Entry& entry = table_[pos];
+      if (!entry.index) {  // The end of the probe sequence.
+        if (!tombstone) {
+          tombstone = &entry;
+          ++size_;
         }
-        it_prev = it_cur;
-        ++it_cur;
+        break;
+      }
+      if (entry.vertex.expired()) {
+        if (!tombstone)
+          tombstone = &entry;
+      } else if (entry.index == index && entry.high_id == high_id &&
+                 entry.low_id == low_id) {
+        return entry.vertex;
       }
     }
-    ++size_;
-    return *chain.emplace_after(it_prev);
+    tombstone->vertex = WeakIntrusivePtr<T>();
+    tombstone->index = index;
+    tombstone->high_id = high_id;
+    tombstone->low_id = low_id;
+    return tombstone->vertex;
   }
 
  private:
-  /// Rehashes the table for the new number of buckets.
-  /// Upon rehashing the expired nodes are not moved to the new table.
-  ///
-  /// @param[in] new_capacity  The desired number of buckets.
-  void Rehash(int new_capacity) {
-    int new_size = 0;
+  /// Rehashes the table without expired entries.
+  /// The capacity grows only if live entries fill the half of the table.
+  ///
+  /// @param[in] min_capacity  The minimum power-of-two capacity to rehash to.
+  void Rehash(int min_capacity = 0) {
+    int live_size = 0;
+    for (const Entry& entry : table_)
+      live_size += !entry.vertex.expired();
+    int new_capacity = std::max(capacity_, min_capacity);
+    while (live_size >= new_capacity / 2)
+      new_capacity *= 2;
+
     Table new_table(new_capacity);
-    for (Bucket& chain : table_) {
-      for (auto it_prev = chain.before_begin(), it_cur = chain.begin(),
-                it_end = chain.end();
-           it_cur != it_end;) {
-        if (it_cur->expired()) {
-          it_prev = it_cur;
-          ++it_cur;
-          continue;
-        }
-        ++new_size;
-        T* vertex = it_cur->get();
-        int bucket_number =
-            Hash(vertex->index(), get_high_id(*vertex), get_low_id(*vertex)) %
-            new_capacity;
-        Bucket& new_chain = new_table[bucket_number];
-        new_chain.splice_after(new_chain.before_begin(), chain, it_prev,
-                               ++it_cur);
-      }
+    for (Entry& entry : table_) {
+      if (entry.vertex.expired())
+        continue;
+      int pos =
+          Hash(entry.index, entry.high_id, entry.low_id) & (new_capacity - 1);
+      while (new_table[pos].index)
+        pos = (pos + 1) & (new_capacity - 1);
+      new_table[pos] = std::move(entry);
     }
     table_.swap(new_table);
-    size_ = new_size;
+    size_ = live_size;
     capacity_ = new_capacity;
   }
 
   /// Computes the hash value of the key.
+  /// The combined value is scrambled
+  /// so that the low bits are usable for power-of-two capacities.
   ///
   /// @param[in] index  Index of the variable.
   /// @param[in] high_id  The id of the high vertex.
   /// @param[in] low_id  The id of the low vertex.
   ///
   /// @returns The combined hash value of the argument numbers.
-  std::size_t Hash(int index, int high_id, int low_id) {
+  static std::size_t Hash(int index, int high_id, int low_id) {
     std::size_t seed = 0;
     boost::hash_combine(seed, index);
     boost::hash_combine(seed, high_id);
     boost::hash_combine(seed, low_id);
-    return seed;
+    std::uint64_t value = seed;  // Fibonacci hashing of the 64-bit value.
+    return (value * 0x9E3779B97F4A7C15) >> 32;
   }
 
-  /// Computes a new capacity for resizing.
-  ///
-  /// @param[in] prev_capacity  The current capacity.
+  /// @param[in] n  The requested capacity.
   ///
-  /// @returns The new capacity scaled by the growth factor function.
-  ///
-  /// @note The growth tries to take into account the growth patterns of BDD.
-  int GetNextCapacity(int prev_capacity) {
-    const int kMaxScaleCapacity = 1e8;
-    int scale_power = 1;  // The default power after the max scale capacity.
-    if (prev_capacity < kMaxScaleCapacity) {
-      scale_power += std::log10(kMaxScaleCapacity / prev_capacity);
-    }
-    int growth_factor = std::pow(2, scale_power);
-    int new_capacity = prev_capacity * growth_factor;
-    return core::GetPrimeNumber(new_capacity);
+  /// @returns The smallest power of two not less than n.
+  static int GetCapacity(int n) {
+    int capacity = 16;
+    while (capacity < n)
+      capacity *= 2;
+    return capacity;
   }
 
-  int capacity_;  ///< The total number of buckets in the table.
-  int size_;  ///< The total number of elements in the table.
-  double max_load_factor_;  ///< The limit on the avg. # of elements per bucket.
+  int capacity_;  ///< The total number of slots in the table.
+  int size_;  ///< The number of occupied slots with tombstones.
+  double max_load_factor_;  ///< The limit on the ratio of occupied slots.
 
   /// A table of unique vertices is stored with weak pointers
   /// so that this hash table does not interfere
@@ -547,6 +684,25 @@ class UniqueTable {
   Table table_;
 };
 
+/// Counters of lookups in computation caches.
+struct CacheStatistics {
+  /// Accumulates the counters of another cache.
+  ///
+  /// @param[in] other  The statistics of another cache.
+  ///
+  /// @returns Reference to this.
+  CacheStatistics& operator+=(const CacheStatistics& other) {
+    hits += other.hits;
+    misses += other.misses;
+    evictions += other.evictions;
+    return *this;
+  }
+
+  std::size_t hits = 0;  ///< Successful searches for computation results.
+  std::size_t misses = 0;  ///< Searches without results in the cache.
+  std::size_t evictions = 0;  ///< Results purged by colliding entries.
+};
+
 /// A hash table without collision resolution.
 /// Instead of resolving the collision,
 /// the existing value is purged and replaced by the new entry.
@@ -555,6 +711,11 @@ class UniqueTable {
 /// The implementation of the table
 /// is very much coupled with the BDD use cases.
 ///
+/// The table grows with the number of entries
+/// only up to its maximum capacity.
+/// After that, the table is a lossy direct-mapped cache
+/// of the fixed size.
+///
 /// @tparam V  The type of the value/result of BDD Apply.
 ///            The type must provide swap(), reset(), and operator bool().
 ///
@@ -579,15 +740,23 @@ class CacheTable {
 
   /// Constructor with average expectations for computations.
   ///
-  /// @param[in] init_capacity
-  explicit CacheTable(int init_capacity = 1000)
+  /// @param[in] init_capacity  The starting capacity for the table.
+  /// @param[in] max_capacity  The limit on the growth of the table.
+  explicit CacheTable(int init_capacity = 1000,
+                      int max_capacity = std::numeric_limits<int>::max())
       : size_(0),
         max_load_factor_(0.75),
-        table_(core::GetPrimeNumber(init_capacity)) {}
+        max_capacity_(max_capacity),
+        table_(std::min(core::GetPrimeNumber(init_capacity), max_capacity)) {
+    assert(max_capacity > 0 && "The cache must have some capacity.");
+  }
 
   /// @returns The number of entires in the table.
   int size() const { return size_; }
 
+  /// @returns The counters of lookups in this table.
+  const CacheStatistics& statistics() const { return statistics_; }
+
   /// Removes all entries from the table.
   void clear() {
     for (value_type& entry : table_) {
@@ -609,9 +778,9 @@ class CacheTable {
       table_ = decltype(table_)();
       return;
     }
-    if (n <= size_)
+    if (n <= size_ || capacity() == max_capacity_)
       return;
-    Rehash(core::GetPrimeNumber(n / max_load_factor_ + 1));
+    Rehash(GetNextCapacity(n / max_load_factor_ + 1));
   }
 
   /// Searches for existing entry.
@@ -623,8 +792,11 @@ class CacheTable {
   iterator find(const key_type& key) {
     int index = boost::hash_value(key) % table_.size();
     value_type& entry = table_[index];
-    if (!entry.second || entry.first != key)
+    if (!entry.second || entry.first != key) {
+      ++statistics_.misses;
       return table_.end();
+    }
+    ++statistics_.hits;
     return table_.begin() + index;
   }
 
@@ -642,18 +814,35 @@ class CacheTable {
   void emplace(const key_type& key, const mapped_type& value) {
     assert(value && "Empty computation results!");
 
-    if (size_ >= (max_load_factor_ * table_.size()))
-      Rehash(core::GetPrimeNumber(table_.size() * 2));
+    if (size_ >= (max_load_factor_ * table_.size()) &&
+        capacity() < max_capacity_) {
+      Rehash(GetNextCapacity(table_.size() * 2));
+    }
 
     int index = boost::hash_value(key) % table_.size();
     value_type& entry = table_[index];
-    if (!entry.second)
+    if (!entry.second) {
       ++size_;
-    entry.first = key;  // Key equality is unlikely for the use case.
+    } else if (entry.first != key) {
+      ++statistics_.evictions;
+    }
+    entry.first = key;
     entry.second = value;  // Might be purging another value.
   }
 
  private:
+  /// @param[in] n  The desired capacity.
+  ///
+  /// @returns The prime capacity within the maximum capacity.
+  int GetNextCapacity(std::size_t n) const {
+    if (n >= static_cast<std::size_t>(max_capacity_))
+      return max_capacity_;
+    return std::min(core::GetPrimeNumber(n), max_capacity_);
+  }
+
+  /// @returns The current size of the underlying container.
+  int capacity() const { return table_.size(); }
+
   /// Rehashes the table with a new capacity.
   ///
   /// @param[in] new_capacity  Desired size of the underlying container.
@@ -666,8 +855,11 @@ class CacheTable {
       int new_index = boost::hash_value(entry.first) % new_table.size();
       value_type& new_entry = new_table[new_index];
       new_entry.first = entry.first;
-      if (!new_entry.second)
+      if (!new_entry.second) {
         ++new_size;
+      } else {
+        ++statistics_.evictions;
+      }
       new_entry.second.swap(entry.second);
     }
     size_ = new_size;
@@ -676,7 +868,9 @@ class CacheTable {
 
   int size_;  ///< The total number of elements in the table.
   double max_load_factor_;  ///< The limit on (size / capacity) ratio.
+  int max_capacity_;  ///< The limit on the size of the container.
   std::vector<value_type> table_;  ///< The main container.
+  CacheStatistics statistics_;  ///< The counters of lookups.
 };
 
 class Zbdd;  // For analysis purposes.
@@ -735,6 +929,9 @@ class Bdd : private boost::noncopyable {
   /// @pre The PDAG has variable ordering.
   ///
   /// @note BDD construction may take considerable time.
+  /// @note If requested by the settings,
+  ///       the variables are reordered dynamically upon the construction,
+  ///       so the final ordering may differ from the PDAG ordering.
   Bdd(const Pdag* graph, const Settings& settings);
 
   /// To handle incomplete ZBDD type with unique pointers.
@@ -746,7 +943,8 @@ class Bdd : private boost::noncopyable {
   /// @returns Mapping of PDAG modules and BDD graph vertices.
   const std::unordered_map<int, Function>& modules() const { return modules_; }
 
-  /// @returns Mapping of variable indices to their orders.
+  /// @returns Mapping of variable (including module) indices
+  ///          to their final orders in the BDD.
   const std::unordered_map<int, int>& index_to_order() const {
     return index_to_order_;
   }
@@ -754,6 +952,15 @@ class Bdd : private boost::noncopyable {
   /// @returns true if the BDD has been constructed from a coherent PDAG.
   bool coherent() const { return coherent_; }
 
+  /// @returns The combined counters of the Apply computation caches
+  ///          including the caches of parallel jobs.
+  CacheStatistics cache_statistics() const {
+    CacheStatistics statistics = job_statistics_;
+    statistics += and_table_.statistics();
+    statistics += or_table_.statistics();
+    return statistics;
+  }
+
   /// Helper function to clear and set vertex marks.
   ///
   /// @param[in] mark  Desired mark for BDD vertices.
@@ -828,9 +1035,18 @@ class Bdd : private boost::noncopyable {
   ItePtr FindOrAddVertex(const Gate& gate, const VertexPtr& high,
                          const VertexPtr& low, bool complement_edge) noexcept;
 
+  /// Constructs an empty BDD
+  /// to convert PDAG modules in a parallel job.
+  ///
+  /// @param[in] settings  The analysis settings.
+  /// @param[in] num_jobs  The number of jobs sharing the memory budget.
+  Bdd(const Settings& settings, int num_jobs);
+
   /// Converts all gates in the PDAG
   /// into function BDD graphs.
   /// Registers processed gates.
+  /// Module arguments are converted recursively
+  /// unless modules are converted in separate jobs.
   ///
   /// @param[in] gate  The root or current parent gate of the graph.
   /// @param[in,out] gates  Processed gates with use counts.
@@ -842,6 +1058,24 @@ class Bdd : private boost::noncopyable {
       const Gate& gate,
       std::unordered_map<int, std::pair<Function, int>>* gates) noexcept;
 
+  /// Converts the modules of the PDAG into BDD graphs in parallel jobs.
+  /// Modules share no variables,
+  /// so each job builds its graphs
+  /// with private unique and computation tables.
+  /// The graphs are transferred into this BDD upon completion of the jobs.
+  ///
+  /// @param[in] root  The root gate of the PDAG.
+  ///
+  /// @returns The BDD function representing the root gate.
+  Function ConvertModules(const Gate& root);
+
+  /// Transfers all the vertices and module graphs of a job into this BDD.
+  ///
+  /// @param[in,out] job  The BDD with converted modules.
+  ///
+  /// @pre The job graphs are independent from the graphs of this BDD.
+  void Merge(Bdd* job) noexcept;
+
   /// Computes minimum and maximum ids for keys in computation tables.
   ///
   /// @param[in] arg_one  First argument function graph.
@@ -943,6 +1177,78 @@ class Bdd : private boost::noncopyable {
   /// @pre Non-terminal node marks are clear (false).
   void TestStructure(const VertexPtr& vertex) noexcept;
 
+  /// The vertices of a single variable in the ordering.
+  struct VariableLevel {
+    int index;  ///< The index of the variable.
+    bool module;  ///< The variable represents a module.
+    bool coherent;  ///< The variable represents a coherent module.
+    std::vector<ItePtr> vertices;  ///< All the live vertices of the variable.
+  };
+
+  /// @param[in] index  The index of a variable or module.
+  /// @param[in] order  The PDAG order of the variable.
+  ///
+  /// @returns The current order of the variable in the BDD,
+  ///          which may differ from the PDAG order after reordering.
+  int GetOrder(int index, int order) noexcept {
+    return index_to_order_.emplace(index, order).first->second;
+  }
+
+  /// Reorders variables dynamically
+  /// if the unique table has grown past the reordering threshold.
+  ///
+  /// @pre No Apply operations are in progress,
+  ///      and the computation tables are clear.
+  void TryReorderVariables() noexcept;
+
+  /// Reorders variables with Rudell's sifting.
+  /// Each variable is moved across all levels
+  /// with swaps of adjacent levels
+  /// and left at the level with the minimum number of vertices.
+  ///
+  /// The vertices are changed in place;
+  /// that is, all pointers to the vertices and functions stay valid.
+  ///
+  /// @returns The number of vertices after the reordering.
+  ///
+  /// @pre The computation tables are clear.
+  int ReorderVariables() noexcept;
+
+  /// Sifts variables of a single graph (module).
+  ///
+  /// @param[in] orders  The increasing orders of the level positions.
+  /// @param[in,out] levels  The levels of the graph variables.
+  ///
+  /// @returns The change in the number of vertices.
+  int SiftLevels(const std::vector<int>& orders,
+                 std::vector<VariableLevel>* levels) noexcept;
+
+  /// Swaps the variables of adjacent levels of a graph.
+  /// The levels are adjacent if no other vertex in the graph
+  /// has an order between the level orders.
+  ///
+  /// @param[in] upper_order  The order of the upper level.
+  /// @param[in] lower_order  The order of the lower level.
+  /// @param[in,out] upper  The upper level to become the lower level.
+  /// @param[in,out] lower  The lower level to become the upper level.
+  ///
+  /// @returns The change in the number of vertices.
+  int SwapLevels(int upper_order, int lower_order, VariableLevel* upper,
+                 VariableLevel* lower) noexcept;
+
+  /// Finds or adds a reduced function with the variable on top.
+  ///
+  /// @param[in] level  The level of the variable.
+  /// @param[in] order  The order of the variable.
+  /// @param[in] high  The function for the true variable.
+  /// @param[in] low  The function for the false variable.
+  /// @param[in,out] created  New vertices of the variable.
+  ///
+  /// @returns The function with the regular high edge of the vertex.
+  Function GetReducedFunction(const VariableLevel& level, int order,
+                              const Function& high, const Function& low,
+                              std::vector<ItePtr>* created) noexcept;
+
   /// Clears all memoization tables.
   void ClearTables() noexcept {
     and_table_.clear();
@@ -971,6 +1277,7 @@ class Bdd : private boost::noncopyable {
   UniqueTable<Ite> unique_table_;
 
   /// Tables of processed computations over functions.
+  /// The sizes of the tables are limited by the memory budget of the settings.
   /// The argument functions are recorded with their IDs (not vertex indices).
   /// In order to keep only unique computations,
   /// the argument IDs must be ordered.
@@ -980,10 +1287,13 @@ class Bdd : private boost::noncopyable {
   ComputeTable or_table_;
   /// @}
 
+  CacheStatistics job_statistics_;  ///< The counters of parallel job caches.
   std::unordered_map<int, Function> modules_;  ///< Module graphs.
   std::unordered_map<int, int> index_to_order_;  ///< Indices and orders.
   const TerminalPtr kOne_;  ///< Terminal True.
   int function_id_;  ///< Identification assignment for new function graphs.
+  int reordering_threshold_;  ///< The # of vertices to trigger reordering.
+  bool convert_modules_;  ///< Recursive conversion of module arguments.
   std::unique_ptr<Zbdd> zbdd_;  ///< ZBDD as a result of analysis.
 };
 
@@ -145,7 +145,6 @@ class CcfGroup : public Id {
   /// @pre The CCF is validated.
   void ApplyModel();
 
- protected:
   /// Mapping expressions and their application levels.
   using ExpressionMap = std::vector<std::pair<int, Expression*>>;
 
@@ -155,6 +154,7 @@ class CcfGroup : public Id {
   /// @returns CCF factors of the model.
   const ExpressionMap& factors() const { return factors_; }
 
+ protected:
   /// Registers a new expression for ownership by the group.
   /// @{
   template <class T, typename... Ts>
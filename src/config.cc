@@ -108,9 +108,15 @@ void Config::GatherOptions(const xml::Element& root) {
       } else if (name == "prime-implicants") {
         settings_.prime_implicants(true);
 
+      } else if (name == "reordering") {
+        settings_.reordering(true);
+
       } else if (name == "approximation") {
         settings_.approximation(option_group.attribute("name"));
 
+      } else if (name == "sampling") {
+        settings_.sampling(option_group.attribute("name"));
+
       } else if (name == "limits") {
         SetLimits(option_group);
       }
@@ -161,15 +167,33 @@ void Config::SetLimits(const xml::Element& limits) {
     } else if (name == "time-step") {
       settings_.time_step(limit.text<double>());
 
+    } else if (name == "time-tolerance") {
+      settings_.time_tolerance(limit.text<double>());
+
     } else if (name == "number-of-trials") {
       settings_.num_trials(limit.text<int>());
 
+    } else if (name == "mean-error") {
+      settings_.mean_error(limit.text<double>());
+
+    } else if (name == "quantile-error") {
+      settings_.quantile_error(limit.text<double>());
+
     } else if (name == "number-of-quantiles") {
       settings_.num_quantiles(limit.text<int>());
 
     } else if (name == "number-of-bins") {
       settings_.num_bins(limit.text<int>());
 
+    } else if (name == "number-of-jobs") {
+      settings_.num_jobs(limit.text<int>());
+
+    } else if (name == "bdd-memory") {
+      settings_.bdd_memory(limit.text<int>());
+
+    } else if (name == "merge-budget") {
+      settings_.merge_budget(limit.text<int>());
+
     } else if (name == "seed") {
       settings_.seed(limit.text<int>());
     }
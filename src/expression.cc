@@ -28,25 +28,37 @@
 
 namespace scram::mef {
 
+thread_local int Expression::sampling_context_ = 0;
+
 Expression::Expression(std::vector<Expression*> args)
-    : args_(std::move(args)), sampled_value_(0), sampled_(false) {}
+    : args_(std::move(args)), samples_(1) {}
 
 double Expression::Sample() noexcept {
-  if (!sampled_) {
-    sampled_ = true;
-    sampled_value_ = this->DoSample();
+  SampleState& state = samples_[sampling_context_];
+  if (!state.sampled) {
+    state.sampled = true;
+    state.value = this->DoSample();
   }
-  return sampled_value_;
+  return state.value;
 }
 
 void Expression::Reset() noexcept {
-  if (!sampled_)
+  SampleState& state = samples_[sampling_context_];
+  if (!state.sampled)
     return;
-  sampled_ = false;
+  state.sampled = false;
   for (Expression* arg : args_)
     arg->Reset();
 }
 
+void Expression::ReserveSamplingContexts(int num_contexts) {
+  if (samples_.size() >= static_cast<std::size_t>(num_contexts))
+    return;
+  samples_.resize(num_contexts);
+  for (Expression* arg : args_)
+    arg->ReserveSamplingContexts(num_contexts);
+}
+
 bool Expression::IsDeviate() noexcept {
   return ext::any_of(args_, [](Expression* arg) { return arg->IsDeviate(); });
 }
@@ -105,7 +105,8 @@ class Expression : private boost::noncopyable {
   ///          may yield silent failure.
   virtual bool IsDeviate() noexcept;
 
-  /// @returns A sampled value of this expression.
+  /// @returns A sampled value of this expression
+  ///          in the current sampling context.
   double Sample() noexcept;
 
   /// This routine resets the sampling to get new values.
@@ -114,6 +115,22 @@ class Expression : private boost::noncopyable {
   /// its arguments are not going to get any calls.
   void Reset() noexcept;
 
+  /// Prepares independent sampling states
+  /// for the expression and all its arguments.
+  /// Each concurrent sampler must work in its own context.
+  ///
+  /// @param[in] num_contexts  The number of sampling contexts.
+  ///
+  /// @pre No concurrent sampling is in progress.
+  void ReserveSamplingContexts(int num_contexts);
+
+  /// Sets the sampling context for the calling thread.
+  ///
+  /// @param[in] context  The index of the reserved sampling context.
+  static void sampling_context(int context) noexcept {
+    sampling_context_ = context;
+  }
+
  protected:
   /// Registers an additional argument expression.
   ///
@@ -127,9 +144,17 @@ class Expression : private boost::noncopyable {
   /// @returns A sampled value of this expression.
   virtual double DoSample() noexcept = 0;
 
+  /// The sampling state within a single sampling context.
+  struct SampleState {
+    double value = 0;  ///< The sampled value.
+    bool sampled = false;  ///< Indication if the expression is already sampled.
+  };
+
+  /// The sampling context of the current thread.
+  static thread_local int sampling_context_;
+
   std::vector<Expression*> args_;  ///< Expression's arguments.
-  double sampled_value_;  ///< The sampled value.
-  bool sampled_;  ///< Indication if the expression is already sampled.
+  std::vector<SampleState> samples_;  ///< The states per sampling context.
 };
 
 /// CRTP for Expressions with the same formula to evaluate and sample.
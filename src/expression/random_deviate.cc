@@ -36,7 +36,19 @@
 
 namespace scram::mef {
 
-std::mt19937 RandomDeviate::rng_;
+thread_local std::mt19937 RandomDeviate::rng_;
+thread_local RandomDeviate::UniformSource* RandomDeviate::source_ = nullptr;
+
+namespace {
+
+/// @param[in] p  The cumulative probability in (0, 1).
+///
+/// @returns The quantile of the standard normal distribution.
+double StandardNormalQuantile(double p) noexcept {
+  return -std::sqrt(2) * boost::math::erfc_inv(2 * p);
+}
+
+}  // namespace
 
 UniformDeviate::UniformDeviate(Expression* min, Expression* max)
     : RandomDeviate({min, max}), min_(*min), max_(*max) {}
@@ -48,7 +60,12 @@ void UniformDeviate::Validate() const {
   }
 }
 
-double UniformDeviate::DoSample() noexcept {
+double UniformDeviate::Quantile(double p) noexcept {
+  double min = min_.value();
+  return min + p * (max_.value() - min);
+}
+
+double UniformDeviate::Draw() noexcept {
   return std::uniform_real_distribution(min_.value(),
                                         max_.value())(RandomDeviate::rng());
 }
@@ -62,7 +79,11 @@ void NormalDeviate::Validate() const {
   }
 }
 
-double NormalDeviate::DoSample() noexcept {
+double NormalDeviate::Quantile(double p) noexcept {
+  return mean_.value() + sigma_.value() * StandardNormalQuantile(p);
+}
+
+double NormalDeviate::Draw() noexcept {
   return std::normal_distribution(mean_.value(),
                                   sigma_.value())(RandomDeviate::rng());
 }
@@ -88,7 +109,12 @@ void LognormalDeviate::Logarithmic::Validate() const {
   }
 }
 
-double LognormalDeviate::DoSample() noexcept {
+double LognormalDeviate::Quantile(double p) noexcept {
+  return std::exp(flavor_->location() +
+                  flavor_->scale() * StandardNormalQuantile(p));
+}
+
+double LognormalDeviate::Draw() noexcept {
   return std::lognormal_distribution(flavor_->location(),
                                      flavor_->scale())(RandomDeviate::rng());
 }
@@ -99,8 +125,7 @@ Interval LognormalDeviate::interval() noexcept {
 }
 
 double LognormalDeviate::Logarithmic::scale() noexcept {
-  double z = -std::sqrt(2) * boost::math::erfc_inv(2 * level_.value());
-  return std::log(ef_.value()) / z;
+  return std::log(ef_.value()) / StandardNormalQuantile(level_.value());
 }
 
 double LognormalDeviate::Logarithmic::location() noexcept {
@@ -139,7 +164,11 @@ Interval GammaDeviate::interval() noexcept {
   return Interval::left_open(0, high_estimate);
 }
 
-double GammaDeviate::DoSample() noexcept {
+double GammaDeviate::Quantile(double p) noexcept {
+  return boost::math::gamma_p_inv(k_.value(), p) * theta_.value();
+}
+
+double GammaDeviate::Draw() noexcept {
   return std::gamma_distribution(k_.value())(RandomDeviate::rng()) *
          theta_.value();
 }
@@ -165,7 +194,11 @@ Interval BetaDeviate::interval() noexcept {
   return Interval::closed(0, high_estimate);
 }
 
-double BetaDeviate::DoSample() noexcept {
+double BetaDeviate::Quantile(double p) noexcept {
+  return boost::math::ibeta_inv(alpha_.value(), beta_.value(), p);
+}
+
+double BetaDeviate::Draw() noexcept {
   return boost::random::beta_distribution(alpha_.value(),
                                           beta_.value())(RandomDeviate::rng());
 }
@@ -225,7 +258,25 @@ auto make_sampler(const Iterator& it) {
 
 }  // namespace
 
-double Histogram::DoSample() noexcept {
+double Histogram::Quantile(double p) noexcept {
+  double sum_weights = 0;
+  for (const auto& weight : weights_)
+    sum_weights += weight->value();
+  double target = p * sum_weights;
+  auto it_b = boundaries_.begin();
+  double lower_bound = (*it_b)->value();
+  for (const auto& weight : weights_) {
+    double cur_weight = weight->value();
+    double upper_bound = (*++it_b)->value();
+    if (target < cur_weight)
+      return lower_bound + target / cur_weight * (upper_bound - lower_bound);
+    target -= cur_weight;
+    lower_bound = upper_bound;
+  }
+  return lower_bound;  // Round-off at the upper boundary.
+}
+
+double Histogram::Draw() noexcept {
   // clang-format off
   return std::piecewise_constant_distribution<double>(
       make_sampler(boundaries_.begin()),
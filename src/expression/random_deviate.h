@@ -34,30 +34,89 @@ namespace scram::mef {
 /// Abstract base class for all deviate expressions.
 /// These expressions provide quantification for uncertainty and sensitivity.
 ///
-/// @note Only single RNG is embedded for convenience.
-///       All the distributions share this RNG.
-///       This is not suitable for parallelized simulations!!!
+/// @note Only single RNG per thread is embedded for convenience.
+///       All the distributions share this RNG within a thread.
+///       Parallel simulations must seed each thread's RNG explicitly.
 ///
 /// @todo Parametrize with RNG (requires mef::Expression interface change).
 class RandomDeviate : public Expression {
  public:
+  /// Provider of uniform numbers in (0, 1) for the deviates
+  /// to replace independent pseudo-random draws
+  /// with stratified or low-discrepancy points.
+  /// The deviates transform the numbers with their quantile functions.
+  class UniformSource {
+   public:
+    virtual ~UniformSource() = default;
+
+    /// Advances the source to the next trial.
+    virtual void NextTrial() noexcept = 0;
+
+    /// @param[in] deviate  The deviate requesting its number.
+    ///
+    /// @returns The number in (0, 1) for the deviate in the current trial.
+    virtual double Next(const RandomDeviate& deviate) noexcept = 0;
+  };
+
   using Expression::Expression;
 
   bool IsDeviate() noexcept override { return true; }
 
+  /// Computes the inverse of the cumulative distribution function.
+  ///
+  /// @param[in] p  The cumulative probability in (0, 1).
+  ///
+  /// @returns The value of the distribution at the given probability.
+  virtual double Quantile(double p) noexcept = 0;
+
+  /// Sets the uniform number source for sampling in the calling thread.
+  ///
+  /// @param[in] source  The source for the deviates
+  ///                    or nullptr to draw with the RNG.
+  ///
+  /// @note This is static! Used by all the deriving deviates.
+  static void uniform_source(UniformSource* source) noexcept {
+    source_ = source;
+  }
+
+  /// Starts a new trial with the uniform source of the calling thread.
+  static void StartTrial() noexcept {
+    if (source_)
+      source_->NextTrial();
+  }
+
   /// Sets the seed of the underlying random number generator.
   ///
   /// @param[in] seed  The seed for RNGs.
   ///
   /// @note This is static! Used by all the deriving deviates.
+  /// @note Only the RNG of the calling thread is affected.
+  /// @{
   static void seed(unsigned seed) noexcept { rng_.seed(seed); }
+  static void seed(std::seed_seq& seq) { rng_.seed(seq); }
+  /// @}
+
+  /// Draws a new seed from the RNG of the calling thread
+  /// to initialize independent streams of random numbers.
+  ///
+  /// @returns A seed value for other RNGs.
+  static unsigned GenerateSeed() noexcept { return rng_(); }
 
  protected:
   /// @returns RNG to be used by derived classes.
   std::mt19937& rng() { return rng_; }
 
  private:
-  static std::mt19937 rng_;  ///< The random number generator.
+  double DoSample() noexcept final {
+    return source_ ? Quantile(source_->Next(*this)) : Draw();
+  }
+
+  /// @returns A pseudo-random value drawn with the RNG.
+  virtual double Draw() noexcept = 0;
+
+  static thread_local std::mt19937 rng_;  ///< The random number generator.
+  /// The source of uniform numbers replacing the RNG.
+  static thread_local UniformSource* source_;
 };
 
 /// Uniform distribution.
@@ -77,8 +136,10 @@ class UniformDeviate : public RandomDeviate {
     return Interval::closed(min_.value(), max_.value());
   }
 
+  double Quantile(double p) noexcept override;
+
  private:
-  double DoSample() noexcept override;
+  double Draw() noexcept override;
 
   Expression& min_;  ///< Minimum value of the distribution.
   Expression& max_;  ///< Maximum value of the distribution.
@@ -104,8 +165,10 @@ class NormalDeviate : public RandomDeviate {
     return Interval::closed(mean - delta, mean + delta);
   }
 
+  double Quantile(double p) noexcept override;
+
  private:
-  double DoSample() noexcept override;
+  double Draw() noexcept override;
 
   Expression& mean_;  ///< Mean value of normal distribution.
   Expression& sigma_;  ///< Standard deviation of normal distribution.
@@ -139,8 +202,10 @@ class LognormalDeviate : public RandomDeviate {
   /// The high is 99.9 percentile estimate.
   Interval interval() noexcept override;
 
+  double Quantile(double p) noexcept override;
+
  private:
-  double DoSample() noexcept override;
+  double Draw() noexcept override;
 
   /// Support for parametrization differences.
   struct Flavor {
@@ -209,8 +274,10 @@ class GammaDeviate : public RandomDeviate {
   /// The high is 99 percentile.
   Interval interval() noexcept override;
 
+  double Quantile(double p) noexcept override;
+
  private:
-  double DoSample() noexcept override;
+  double Draw() noexcept override;
 
   Expression& k_;  ///< The shape parameter of the gamma distribution.
   Expression& theta_;  ///< The scale factor of the gamma distribution.
@@ -236,8 +303,10 @@ class BetaDeviate : public RandomDeviate {
   /// @returns 99 percentile.
   Interval interval() noexcept override;
 
+  double Quantile(double p) noexcept override;
+
  private:
-  double DoSample() noexcept override;
+  double Draw() noexcept override;
 
   Expression& alpha_;  ///< The alpha shape parameter.
   Expression& beta_;  ///< The beta shape parameter.
@@ -268,13 +337,14 @@ class Histogram : public RandomDeviate {
     return Interval::closed((*boundaries_.begin())->value(),
                             (*std::prev(boundaries_.end()))->value());
   }
+  double Quantile(double p) noexcept override;
 
  private:
   /// Access to args.
   using IteratorRange =
       boost::iterator_range<std::vector<Expression*>::const_iterator>;
 
-  double DoSample() noexcept override;
+  double Draw() noexcept override;
 
   IteratorRange boundaries_;  ///< Boundaries of the intervals.
   IteratorRange weights_;  ///< Weights of the intervals.
@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the expression tape compilation and evaluation.
+
+#include "tape.h"
+
+#include <cassert>
+
+#include <algorithm>
+#include <iterator>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+
+#include "boolean.h"
+#include "exponential.h"
+#include "numerical.h"
+#include "random_deviate.h"
+#include "src/ext/algorithm.h"
+#include "src/parameter.h"
+
+namespace scram::mef {
+
+namespace {  // The native operations of the tape.
+
+using Instruction = ExpressionTape::Instruction;
+
+/// Applies a unary operation to the argument lanes.
+template <typename F>
+void Run(NaryExpression<F, 1>*, const Instruction& instruction, int num_lanes,
+         double* values, int stride) noexcept {
+  const double* arg = values + instruction.args[0] * stride;
+  double* result = values + instruction.slot * stride;
+  for (int i = 0; i < num_lanes; ++i)
+    result[i] = F()(arg[i]);
+}
+
+/// Applies a binary operation to the argument lanes.
+template <typename F>
+void Run(NaryExpression<F, 2>*, const Instruction& instruction, int num_lanes,
+         double* values, int stride) noexcept {
+  const double* arg_one = values + instruction.args[0] * stride;
+  const double* arg_two = values + instruction.args[1] * stride;
+  double* result = values + instruction.slot * stride;
+  for (int i = 0; i < num_lanes; ++i)
+    result[i] = F()(arg_one[i], arg_two[i]);
+}
+
+/// Folds the argument lanes with the operation from left to right.
+template <typename F>
+void Run(NaryExpression<F, -1>*, const Instruction& instruction, int num_lanes,
+         double* values, int stride) noexcept {
+  double* result = values + instruction.slot * stride;
+  std::copy_n(values + instruction.args.front() * stride, num_lanes, result);
+  for (auto it = std::next(instruction.args.begin());
+       it != instruction.args.end(); ++it) {
+    const double* arg = values + *it * stride;
+    for (int i = 0; i < num_lanes; ++i)
+      result[i] = F()(result[i], arg[i]);
+  }
+}
+
+/// Averages the argument lanes.
+void Run(Mean*, const Instruction& instruction, int num_lanes, double* values,
+         int stride) noexcept {
+  double* result = values + instruction.slot * stride;
+  std::fill_n(result, num_lanes, 0);
+  for (int slot : instruction.args) {
+    const double* arg = values + slot * stride;
+    for (int i = 0; i < num_lanes; ++i)
+      result[i] += arg[i];
+  }
+  double num_args = instruction.args.size();
+  for (int i = 0; i < num_lanes; ++i)
+    result[i] /= num_args;
+}
+
+/// Computes the formula of the expression
+/// with the arguments in the order of the formula parameters.
+template <class T, std::size_t... Is>
+void RunFormula(T* expression, const Instruction& instruction, int num_lanes,
+                double* values, int stride,
+                std::index_sequence<Is...>) noexcept {
+  assert(instruction.args.size() == sizeof...(Is));
+  const double* args[] = {(values + instruction.args[Is] * stride)...};
+  double* result = values + instruction.slot * stride;
+  for (int i = 0; i < num_lanes; ++i)
+    result[i] = expression->Compute(args[Is][i]...);
+}
+
+/// Computes the exponential expression.
+void Run(Exponential* expression, const Instruction& instruction,
+         int num_lanes, double* values, int stride) noexcept {
+  RunFormula(expression, instruction, num_lanes, values, stride,
+             std::make_index_sequence<2>());
+}
+
+/// Computes the GLM expression.
+void Run(Glm* expression, const Instruction& instruction, int num_lanes,
+         double* values, int stride) noexcept {
+  RunFormula(expression, instruction, num_lanes, values, stride,
+             std::make_index_sequence<4>());
+}
+
+/// Computes the Weibull expression.
+void Run(Weibull* expression, const Instruction& instruction, int num_lanes,
+         double* values, int stride) noexcept {
+  RunFormula(expression, instruction, num_lanes, values, stride,
+             std::make_index_sequence<4>());
+}
+
+/// Dispatches the instruction to the operation of its expression type.
+///
+/// @tparam T  The exact type of the instruction expression.
+template <class T>
+void Execute(const Instruction& instruction, int num_lanes, double* values,
+             int stride) noexcept {
+  Run(static_cast<T*>(instruction.expression), instruction, num_lanes, values,
+      stride);
+}
+
+/// The native operations of the expression types.
+using OperationTable =
+    std::unordered_map<std::type_index, Instruction::Operation>;
+
+/// @tparam Ts  The expression types with native operations.
+///
+/// @returns The operation table with the given types.
+template <class... Ts>
+OperationTable MakeOperationTable() {
+  return {{typeid(Ts), &Execute<Ts>}...};
+}
+
+/// @param[in] expression  The expression to be placed on the tape.
+///
+/// @returns The native operation for the exact type of the expression.
+/// @returns nullptr if the expression must be evaluated with virtual calls.
+Instruction::Operation GetOperation(Expression* expression) noexcept {
+  static const OperationTable table =
+      MakeOperationTable<Neg, Add, Sub, Mul, Div, Abs, Acos, Asin, Atan, Cos,
+                         Sin, Tan, Cosh, Sinh, Tanh, Exp, Log, Log10, Mod, Pow,
+                         Sqrt, Ceil, Floor, Min, Max, Mean, Not, And, Or, Eq,
+                         Df, Lt, Gt, Leq, Geq, Exponential, Glm, Weibull>();
+  auto it = table.find(typeid(*expression));
+  return it == table.end() ? nullptr : it->second;
+}
+
+}  // namespace
+
+struct ExpressionTape::Compilation {
+  std::unordered_map<Expression*, bool> varying;  ///< Dependence on the input.
+  std::unordered_map<Expression*, int> slots;  ///< The compiled expressions.
+  std::unordered_map<Expression*, int> constants;  ///< The folded expressions.
+};
+
+ExpressionTape::ExpressionTape(const std::vector<Expression*>& outputs,
+                               MissionTime* mission_time, int num_lanes)
+    : mission_time_(mission_time), num_lanes_(num_lanes) {
+  assert(mission_time_ && "The tape without input.");
+  Compile(outputs);
+}
+
+ExpressionTape::ExpressionTape(const std::vector<Expression*>& outputs,
+                               int num_lanes)
+    : mission_time_(nullptr), num_lanes_(num_lanes) {
+  Compile(outputs);
+}
+
+void ExpressionTape::Compile(const std::vector<Expression*>& outputs) {
+  assert(num_lanes_ > 0);
+  Compilation compilation;
+  outputs_.reserve(outputs.size());
+  for (Expression* output : outputs)
+    outputs_.push_back(Compile(output, &compilation));
+
+  values_.resize(num_slots_ * num_lanes_);
+  for (const auto& [expression, slot] : compilation.constants)
+    std::fill_n(&values_[slot * num_lanes_], num_lanes_, expression->value());
+}
+
+int ExpressionTape::Compile(Expression* expression, Compilation* compilation) {
+  if (!IsVarying(expression, compilation))
+    return -1;
+  if (auto it = compilation->slots.find(expression);
+      it != compilation->slots.end()) {
+    return it->second;
+  }
+  int slot = -1;
+  if (expression == mission_time_) {
+    slot = input_ = num_slots_++;
+  } else if (dynamic_cast<Parameter*>(expression)) {
+    slot = Compile(expression->args().front(), compilation);
+  } else if (Instruction::Operation operation = GetOperation(expression)) {
+    Instruction instruction{operation, expression, -1, {}};
+    for (Expression* arg : expression->args()) {
+      int arg_slot = Compile(arg, compilation);
+      instruction.args.push_back(arg_slot < 0 ? Fold(arg, compilation)
+                                              : arg_slot);
+    }
+    slot = instruction.slot = num_slots_++;
+    instructions_.push_back(std::move(instruction));
+  } else {
+    slot = num_slots_++;
+    leaves_.emplace_back(expression, slot);
+  }
+  compilation->slots.emplace(expression, slot);
+  return slot;
+}
+
+bool ExpressionTape::IsVarying(Expression* expression,
+                               Compilation* compilation) {
+  if (auto it = compilation->varying.find(expression);
+      it != compilation->varying.end()) {
+    return it->second;
+  }
+  bool varying = [this, expression, compilation] {
+    if (mission_time_) {
+      if (expression == mission_time_)
+        return true;
+    } else if (!dynamic_cast<Parameter*>(expression) &&
+               !GetOperation(expression)) {
+      return expression->IsDeviate();  // Opaque to the tape.
+    }
+    return ext::any_of(expression->args(),
+                       [this, compilation](Expression* arg) {
+                         return IsVarying(arg, compilation);
+                       });
+  }();
+  compilation->varying.emplace(expression, varying);
+  return varying;
+}
+
+int ExpressionTape::Fold(Expression* expression, Compilation* compilation) {
+  auto [it, inserted] = compilation->constants.emplace(expression, num_slots_);
+  if (inserted)
+    ++num_slots_;
+  return it->second;
+}
+
+void ExpressionTape::Evaluate(const double* times, int num_lanes) noexcept {
+  assert(mission_time_ && "The tape is compiled for sampling.");
+  assert(num_lanes <= num_lanes_);
+  if (input_ >= 0)
+    std::copy_n(times, num_lanes, &values_[input_ * num_lanes_]);
+
+  if (!leaves_.empty()) {
+    double mission_time = mission_time_->value();
+    for (int i = 0; i < num_lanes; ++i) {
+      mission_time_->value(times[i]);
+      for (const auto& [expression, slot] : leaves_)
+        values_[slot * num_lanes_ + i] = expression->value();
+    }
+    mission_time_->value(mission_time);
+  }
+  Execute(num_lanes);
+}
+
+void ExpressionTape::Sample(int num_lanes) noexcept {
+  assert(!mission_time_ && "The tape is compiled for the mission time.");
+  assert(num_lanes <= num_lanes_);
+  for (int i = 0; i < num_lanes; ++i) {
+    RandomDeviate::StartTrial();
+    for (const auto& leaf : leaves_)
+      leaf.first->Reset();
+    for (const auto& [expression, slot] : leaves_)
+      values_[slot * num_lanes_ + i] = expression->Sample();
+  }
+  Execute(num_lanes);
+}
+
+void ExpressionTape::Execute(int num_lanes) noexcept {
+  for (const Instruction& instruction : instructions_)
+    instruction.operation(instruction, num_lanes, values_.data(), num_lanes_);
+}
+
+}  // namespace scram::mef
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Flat evaluation of expression trees over batches of inputs.
+
+#pragma once
+
+#include <vector>
+
+#include "src/expression.h"
+
+namespace scram::mef {
+
+class MissionTime;  // The input of the time-dependent evaluation.
+
+/// Expressions compiled into a flat tape of operations
+/// evaluated lane-by-lane over a batch of inputs.
+///
+/// Only the parts of the expressions varying with the input
+/// are placed on the tape;
+/// the invariant subexpressions are folded into constants.
+/// Shared subexpressions and parameters are evaluated only once per lane.
+///
+/// The arithmetic, logical, and exponential expressions
+/// are executed natively by the tape.
+/// Other expressions (e.g., conditionals, tests, extern functions)
+/// are evaluated with their own virtual calls
+/// as opaque leaves of the tape.
+///
+/// The tape is bound to the state of its expressions;
+/// that is, the expressions must outlive the tape
+/// and must not change after the compilation.
+class ExpressionTape {
+ public:
+  /// Compiles expressions for evaluation over mission time points.
+  ///
+  /// @param[in] outputs  The expressions to evaluate.
+  /// @param[in] mission_time  The mission time input of the expressions.
+  /// @param[in] num_lanes  The maximum number of inputs per batch.
+  ExpressionTape(const std::vector<Expression*>& outputs,
+                 MissionTime* mission_time, int num_lanes);
+
+  /// Compiles expressions for sampling of their random deviates.
+  ///
+  /// @param[in] outputs  The expressions to sample.
+  /// @param[in] num_lanes  The maximum number of trials per batch.
+  ExpressionTape(const std::vector<Expression*>& outputs, int num_lanes);
+
+  /// @returns The number of operations on the tape.
+  int size() const { return instructions_.size() + leaves_.size(); }
+
+  /// Evaluates the outputs at a batch of mission time points.
+  ///
+  /// @param[in] times  The mission time values.
+  /// @param[in] num_lanes  The number of the time values.
+  ///
+  /// @pre The tape is compiled for the mission time input.
+  /// @pre num_lanes does not exceed the tape lanes.
+  ///
+  /// @post The mission time is restored to its original value.
+  void Evaluate(const double* times, int num_lanes) noexcept;
+
+  /// Samples the outputs for a batch of independent trials
+  /// in the current sampling context.
+  ///
+  /// The random numbers are drawn in the same order
+  /// as with sequential sampling of the outputs trial after trial.
+  /// Each trial starts a new trial of the deviate uniform source if any.
+  ///
+  /// @param[in] num_lanes  The number of trials.
+  ///
+  /// @pre The tape is compiled for sampling.
+  /// @pre num_lanes does not exceed the tape lanes.
+  void Sample(int num_lanes) noexcept;
+
+  /// @param[in] output  The index of the output expression.
+  ///
+  /// @returns The lanes of the last evaluated values of the output.
+  /// @returns nullptr if the output value does not vary with the input.
+  const double* lanes(int output) const {
+    int slot = outputs_[output];
+    return slot < 0 ? nullptr : &values_[slot * num_lanes_];
+  }
+
+  /// The operation on the tape.
+  struct Instruction {
+    /// Executes the expression operation over the lanes of the tape.
+    using Operation = void (*)(const Instruction& instruction, int num_lanes,
+                               double* values, int stride);
+
+    Operation operation;  ///< The native operation of the expression.
+    Expression* expression;  ///< The expression with the operation.
+    int slot;  ///< The destination of the result lanes.
+    std::vector<int> args;  ///< The slots of the expression arguments.
+  };
+
+ private:
+  /// The compilation state of the tape.
+  struct Compilation;
+
+  /// Compiles the output expressions onto the tape.
+  ///
+  /// @param[in] outputs  The output expressions.
+  void Compile(const std::vector<Expression*>& outputs);
+
+  /// Places the expression and its varying arguments onto the tape.
+  ///
+  /// @param[in] expression  The expression to compile.
+  /// @param[in,out] compilation  The compilation state.
+  ///
+  /// @returns The slot of the expression values.
+  /// @returns -1 for expressions invariant to the input.
+  int Compile(Expression* expression, Compilation* compilation);
+
+  /// @param[in] expression  The expression to test.
+  /// @param[in,out] compilation  The compilation state.
+  ///
+  /// @returns true if the expression value depends on the input.
+  bool IsVarying(Expression* expression, Compilation* compilation);
+
+  /// Places the invariant value of the expression onto the tape.
+  ///
+  /// @param[in] expression  The invariant expression.
+  /// @param[in,out] compilation  The compilation state.
+  ///
+  /// @returns The slot with the expression value in all its lanes.
+  int Fold(Expression* expression, Compilation* compilation);
+
+  /// Runs the native operations of the tape.
+  ///
+  /// @param[in] num_lanes  The number of lanes to compute.
+  void Execute(int num_lanes) noexcept;
+
+  MissionTime* mission_time_;  ///< The input for time-dependent evaluation.
+  int num_lanes_;  ///< The maximum number of lanes.
+  int num_slots_ = 0;  ///< The number of value slots.
+  int input_ = -1;  ///< The slot of the mission time input.
+  std::vector<Instruction> instructions_;  ///< The native operations.
+  /// The expressions evaluated with virtual calls and their slots.
+  std::vector<std::pair<Expression*, int>> leaves_;
+  std::vector<int> outputs_;  ///< The slots of the output expressions.
+  std::vector<double> values_;  ///< The lanes of all slots.
+};
+
+}  // namespace scram::mef
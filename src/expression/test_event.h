@@ -58,6 +58,9 @@ class TestInitiatingEvent : public TestEvent {
   TestInitiatingEvent(std::string name, const Context* context)
       : TestEvent(context), name_(std::move(name)) {}
 
+  /// @returns The name of the initiating event to test.
+  const std::string& name() const { return name_; }
+
   /// @returns true if the initiating event has occurred in the event-tree walk.
   double value() noexcept override;
 
@@ -75,6 +78,12 @@ class TestFunctionalEvent : public TestEvent {
                       const Context* context)
       : TestEvent(context), name_(std::move(name)), state_(std::move(state)) {}
 
+  /// @returns The name of the functional event to test.
+  const std::string& name() const { return name_; }
+
+  /// @returns The state of the functional event to test.
+  const std::string& state() const { return state_; }
+
   /// @returns true if the functional event has occurred and is in given state.
   double value() noexcept override;
 
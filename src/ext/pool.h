@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Memory pool of fixed-size slots in contiguous blocks.
+
+#pragma once
+
+#include <cstddef>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ext {
+
+/// Memory pool of fixed-size slots carved out of large contiguous blocks.
+/// The slots are handed out in the address order of the blocks,
+/// so consecutively allocated objects are close in memory,
+/// and there is no per-object bookkeeping overhead of general allocators.
+///
+/// Each thread allocates from its own list of free slots without locking.
+/// Slots can be deallocated by any thread.
+/// The free slots of an exiting thread are handed over
+/// to the shared list for other threads to reuse.
+/// The blocks are released only at the program exit.
+///
+/// @tparam Size  The size of objects in bytes.
+/// @tparam Align  The alignment of objects.
+template <std::size_t Size, std::size_t Align>
+class fixed_size_pool {
+  static_assert(Align <= alignof(std::max_align_t), "Over-aligned objects.");
+
+  /// The free slot in the intrusive singly-linked list.
+  struct Slot {
+    Slot* next;  ///< The next free slot.
+  };
+
+  /// The size of slots for objects and the free list links.
+  static constexpr std::size_t kSlotSize =
+      ((Size > sizeof(Slot) ? Size : sizeof(Slot)) + Align - 1) / Align * Align;
+  /// The number of slots in a single block.
+  static constexpr std::size_t kBlockSlots =
+      kSlotSize < (1 << 16) ? (1 << 16) / kSlotSize : 1;
+
+  /// The blocks and free slots shared by all threads.
+  struct Shared {
+    std::mutex mutex;  ///< The guard for the shared state.
+    std::vector<std::unique_ptr<char[]>> blocks;  ///< All allocated blocks.
+    Slot* free_list = nullptr;  ///< The free slots of exited threads.
+  };
+
+  /// The free slots of a single thread.
+  struct Local {
+    /// Hands the free slots over to other threads.
+    ~Local() noexcept {
+      if (!free_list)
+        return;
+      Slot* tail = free_list;
+      while (tail->next)
+        tail = tail->next;
+      Shared& pool = shared();
+      std::lock_guard<std::mutex> lock(pool.mutex);
+      tail->next = pool.free_list;
+      pool.free_list = free_list;
+    }
+
+    Slot* free_list = nullptr;  ///< The free slots for allocation.
+  };
+
+ public:
+  /// @returns Memory for a single object of the Size.
+  ///
+  /// @throws std::bad_alloc  The memory cannot be allocated.
+  static void* allocate() {
+    Local& pool = local();
+    if (!pool.free_list)
+      pool.free_list = Refill();
+    Slot* slot = pool.free_list;
+    pool.free_list = slot->next;
+    return slot;
+  }
+
+  /// Returns the memory of an object back into the pool.
+  ///
+  /// @param[in] ptr  The memory allocated by this pool.
+  static void deallocate(void* ptr) noexcept {
+    Local& pool = local();
+    Slot* slot = static_cast<Slot*>(ptr);
+    slot->next = pool.free_list;
+    pool.free_list = slot;
+  }
+
+  /// @returns The total memory in bytes reserved by the pool.
+  static std::size_t capacity() {
+    Shared& pool = shared();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    return pool.blocks.size() * kBlockSlots * kSlotSize;
+  }
+
+ private:
+  /// @returns The free slots taken from other threads or a new block.
+  static Slot* Refill() {
+    Shared& pool = shared();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    if (Slot* free_list = pool.free_list) {
+      pool.free_list = nullptr;
+      return free_list;
+    }
+    pool.blocks.emplace_back(new char[kBlockSlots * kSlotSize]);
+    char* block = pool.blocks.back().get();
+    Slot* free_list = nullptr;
+    for (std::size_t i = kBlockSlots; i > 0; --i) {  // Allocate in order.
+      Slot* slot = reinterpret_cast<Slot*>(block + (i - 1) * kSlotSize);
+      slot->next = free_list;
+      free_list = slot;
+    }
+    return free_list;
+  }
+
+  /// @returns The state shared by all threads.
+  static Shared& shared() {
+    static Shared pool;
+    return pool;
+  }
+
+  /// @returns The free slots of the calling thread.
+  static Local& local() {
+    static thread_local Local pool;
+    return pool;
+  }
+};
+
+}  // namespace ext
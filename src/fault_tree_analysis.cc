@@ -98,6 +98,13 @@ double Product::p() const {
   return p;
 }
 
+double Product::p(const Pdag::IndexMap<double>& p_vars) const noexcept {
+  double p = 1;
+  for (int index : data_)
+    p *= index < 0 ? 1 - p_vars[-index] : p_vars[index];
+  return p;
+}
+
 FaultTreeAnalysis::FaultTreeAnalysis(const mef::Gate& root,
                                      const Settings& settings,
                                      const mef::Model* model)
@@ -107,7 +114,7 @@ void FaultTreeAnalysis::Analyze() noexcept {
   CLOCK(analysis_time);
   graph_ = std::make_unique<Pdag>(top_event_,
                                   Analysis::settings().ccf_analysis(), model_);
-  this->Preprocess(graph_.get());
+  preprocessor_profile_ = this->Preprocess(graph_.get());
 #ifndef NDEBUG
   if (Analysis::settings().preprocessor)
     return;  // Preprocessor only option.
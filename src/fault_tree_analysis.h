@@ -23,6 +23,8 @@
 #include <cstdlib>
 
 #include <memory>
+#include <optional>
+#include <type_traits>
 #include <unordered_set>
 #include <vector>
 
@@ -87,6 +89,12 @@ class Product {
   /// @pre Events are initialized with expressions.
   double p() const;
 
+  /// @param[in] p_vars  Probabilities of variables mapped by their indices.
+  ///
+  /// @returns The product of the literal probabilities
+  ///          without the evaluation of event expressions.
+  double p(const Pdag::IndexMap<double>& p_vars) const noexcept;
+
   /// @returns A read proxy iterator that points to the first element.
   auto begin() const {
     return boost::make_transform_iterator(data_.begin(),
@@ -151,6 +159,10 @@ class ProductContainer {
   /// @returns The product distribution by order.
   const std::vector<int>& distribution() const { return distribution_; }
 
+  /// @returns The estimate of the total probability of products
+  ///          discarded by the cut-off probability.
+  double truncation_error() const { return products_.truncation_error(); }
+
  private:
   const Zbdd& products_;  ///< Container of analysis results.
   const Pdag& graph_;  ///< The analysis graph.
@@ -237,6 +249,17 @@ class FaultTreeAnalysis : public Analysis {
     return *products_;
   }
 
+  /// @returns The counters of the BDD Apply computation caches
+  ///          if the analysis algorithm uses the caches.
+  virtual std::optional<CacheStatistics> cache_statistics() const {
+    return {};
+  }
+
+  /// @returns The profiles of the preprocessing passes on the graph.
+  const std::vector<PassProfile>& preprocessor_profile() const {
+    return preprocessor_profile_;
+  }
+
  protected:
   /// @returns Pointer to the PDAG representing the fault tree.
   const Pdag* graph() const { return graph_.get(); }
@@ -246,8 +269,10 @@ class FaultTreeAnalysis : public Analysis {
   ///
   /// @param[in,out] graph  A valid PDAG for analysis.
   ///
+  /// @returns The profiles of the applied preprocessing passes.
+  ///
   /// @post The graph transformation is semantically equivalent/isomorphic.
-  virtual void Preprocess(Pdag* graph) noexcept = 0;
+  virtual std::vector<PassProfile> Preprocess(Pdag* graph) noexcept = 0;
 
   /// Generates a sum of products from a preprocessed PDAG.
   ///
@@ -270,6 +295,7 @@ class FaultTreeAnalysis : public Analysis {
   const mef::Model* model_;  ///< The optional Model with substitutions.
   std::unique_ptr<Pdag> graph_;  ///< PDAG of the fault tree.
   std::unique_ptr<const ProductContainer> products_;  ///< Container of results.
+  std::vector<PassProfile> preprocessor_profile_;  ///< Preprocessing passes.
 };
 
 /// Fault tree analysis facility with specific algorithms.
@@ -288,9 +314,19 @@ class FaultTreeAnalyzer : public FaultTreeAnalysis {
   Algorithm* algorithm() { return algorithm_.get(); }
   /// @}
 
+  std::optional<CacheStatistics> cache_statistics() const override {
+    if constexpr (std::is_same_v<Algorithm, Bdd>) {
+      if (algorithm_)
+        return algorithm_->cache_statistics();
+    }
+    return {};
+  }
+
  private:
-  void Preprocess(Pdag* graph) noexcept override {
-    CustomPreprocessor<Algorithm>{graph}();
+  std::vector<PassProfile> Preprocess(Pdag* graph) noexcept override {
+    CustomPreprocessor<Algorithm> preprocessor(graph, Analysis::settings());
+    preprocessor();
+    return preprocessor.profile();
   }
 
   const Zbdd& GenerateProducts(const Pdag* graph) noexcept override {
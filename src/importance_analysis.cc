@@ -38,16 +38,18 @@ void ImportanceAnalysis::Analyze() noexcept {
   double p_total = this->p_total();
   const std::vector<const mef::BasicEvent*>& basic_events =
       this->basic_events();
+  const std::vector<double>& p_vars = this->p_vars();
 
   std::vector<int> occurrences = this->occurrences();
+  std::vector<double> mifs = this->CalculateMifs(occurrences);
   for (int i = 0; i < basic_events.size(); ++i) {
     if (occurrences[i] == 0)
       continue;
     const mef::BasicEvent& event = *basic_events[i];
-    double p_var = event.p();
+    double p_var = p_vars[i];
     ImportanceFactors imp{};
     imp.occurrence = occurrences[i];
-    imp.mif = this->CalculateMif(i);
+    imp.mif = mifs[i];
     if (p_total != 0) {
       imp.cif = p_var * imp.mif / p_total;
       imp.raw = 1 + (1 - p_var) * imp.mif / p_total;
@@ -55,7 +57,7 @@ void ImportanceAnalysis::Analyze() noexcept {
       if (p_total != p_var * imp.mif)
         imp.rrw = p_total / (p_total - p_var * imp.mif);
     }
-    importance_.push_back({event, imp});
+    importance_.push_back({event, imp, p_var});
   }
   LOG(DEBUG3) << "Calculated importance factors in " << DUR(imp_time);
   Analysis::AddAnalysisTime(DUR(imp_time));
@@ -70,54 +72,33 @@ std::vector<int> ImportanceAnalyzerBase::occurrences() noexcept {
   return result;
 }
 
-double ImportanceAnalyzer<Bdd>::CalculateMif(int index) noexcept {
-  index += Pdag::kVariableStartIndex;
-  const Bdd::VertexPtr& root = bdd_graph_->root().vertex;
-  if (root->terminal())
-    return 0;
-  bool original_mark = Ite::Ref(root).mark();
+std::vector<double> ImportanceAnalyzer<Bdd>::CalculateMifs(
+    const std::vector<int>& occurrences) noexcept {
+  std::vector<double> mifs(occurrences.size());
+  const Bdd::Function& root = bdd_graph_->root();
+  if (root.vertex->terminal())
+    return mifs;
+  bool original_mark = Ite::Ref(root.vertex).mark();
+  std::vector<Ite*> vertices;
+  GatherVertices(root.vertex, !original_mark, &vertices);
 
-  int order = bdd_graph_->index_to_order().find(index)->second;
-  double mif = CalculateMif(root, order, !original_mark);
-  bdd_graph_->ClearMarks(original_mark);
-  return mif;
-}
-
-double ImportanceAnalyzer<Bdd>::CalculateMif(const Bdd::VertexPtr& vertex,
-                                             int order, bool mark) noexcept {
-  if (vertex->terminal())
-    return 0;
-  Ite& ite = Ite::Ref(vertex);
-  if (ite.mark() == mark)
-    return ite.factor();
-  ite.mark(mark);
-  if (ite.order() > order) {
-    if (!ite.module()) {
-      ite.factor(0);
-    } else {  /// @todo Detect if the variable is in the module.
-      // The assumption is
-      // that the order of a module is always larger
-      // than the order of its variables.
-      double high = RetrieveProbability(ite.high());
-      double low = RetrieveProbability(ite.low());
-      if (ite.complement_edge())
-        low = 1 - low;
-      const Bdd::Function& res =
-          bdd_graph_->modules().find(ite.index())->second;
-      double mif = CalculateMif(res.vertex, order, mark);
-      if (res.complement)
-        mif = -mif;
-      ite.factor((high - low) * mif);
+  auto propagate = [](const Bdd::VertexPtr& vertex, double adjoint) {
+    if (!vertex->terminal()) {
+      Ite& ite = Ite::Ref(vertex);
+      ite.factor(ite.factor() + adjoint);
     }
-  } else if (ite.order() == order) {
-    assert(!ite.module() && "A variable can't be a module.");
+  };
+  Ite::Ref(root.vertex).factor(root.complement ? -1 : 1);
+  // Parents are processed before their children in reverse post-order.
+  for (auto it = vertices.rbegin(); it != vertices.rend(); ++it) {
+    Ite& ite = **it;
+    ite.mark(original_mark);  // Restore the marks for probability analyzers.
+    double adjoint = ite.factor();
     double high = RetrieveProbability(ite.high());
     double low = RetrieveProbability(ite.low());
     if (ite.complement_edge())
       low = 1 - low;
-    ite.factor(high - low);
-  } else {
-    assert(ite.order() < order);
+    double derivative = adjoint * (high - low);
     double p_var = 0;
     if (ite.module()) {
       const Bdd::Function& res =
@@ -125,16 +106,35 @@ double ImportanceAnalyzer<Bdd>::CalculateMif(const Bdd::VertexPtr& vertex,
       p_var = RetrieveProbability(res.vertex);
       if (res.complement)
         p_var = 1 - p_var;
+      propagate(res.vertex, res.complement ? -derivative : derivative);
     } else {
       p_var = prob_analyzer()->p_vars()[ite.index()];
+      mifs[ite.index() - Pdag::kVariableStartIndex] += derivative;
     }
-    double high = CalculateMif(ite.high(), order, mark);
-    double low = CalculateMif(ite.low(), order, mark);
-    if (ite.complement_edge())
-      low = -low;
-    ite.factor(p_var * high + (1 - p_var) * low);
+    propagate(ite.high(), adjoint * p_var);
+    double low_adjoint = adjoint * (1 - p_var);
+    propagate(ite.low(), ite.complement_edge() ? -low_adjoint : low_adjoint);
+  }
+  return mifs;
+}
+
+void ImportanceAnalyzer<Bdd>::GatherVertices(
+    const Bdd::VertexPtr& vertex, bool mark,
+    std::vector<Ite*>* vertices) noexcept {
+  if (vertex->terminal())
+    return;
+  Ite& ite = Ite::Ref(vertex);
+  if (ite.mark() == mark)
+    return;
+  ite.mark(mark);
+  ite.factor(0);
+  if (ite.module()) {
+    const Bdd::Function& res = bdd_graph_->modules().find(ite.index())->second;
+    GatherVertices(res.vertex, mark, vertices);
   }
-  return ite.factor();
+  GatherVertices(ite.high(), mark, vertices);
+  GatherVertices(ite.low(), mark, vertices);
+  vertices->push_back(&ite);
 }
 
 double ImportanceAnalyzer<Bdd>::RetrieveProbability(
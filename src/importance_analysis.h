@@ -47,6 +47,7 @@ struct ImportanceFactors {
 struct ImportanceRecord {
   const mef::BasicEvent& event;  ///< The event occurring in products.
   const ImportanceFactors factors;  ///< The importance factors of the event.
+  const double p;  ///< The probability of the event in the analysis.
 };
 
 class Zbdd;  // The container of products to be queries for important events.
@@ -82,15 +83,20 @@ class ImportanceAnalysis : public Analysis {
   /// @returns All basic event candidates for importance calculations.
   virtual const std::vector<const mef::BasicEvent*>&
   basic_events() noexcept = 0;
+  /// @returns Probabilities of the basic event candidates in the same order.
+  virtual const std::vector<double>& p_vars() noexcept = 0;
   /// @returns Occurrences of basic events in products.
   virtual std::vector<int> occurrences() noexcept = 0;
 
-  /// Calculates Marginal Importance Factor.
+  /// Calculates Marginal Importance Factors of basic events.
   ///
-  /// @param[in] index  The position index of an event in events vector.
+  /// @param[in] occurrences  Occurrences of basic events in products.
   ///
-  /// @returns Calculated value for MIF.
-  virtual double CalculateMif(int index) noexcept = 0;
+  /// @returns Calculated values for MIF
+  ///          mapped by the position indices of events in events vector.
+  ///          The values for events without occurrences are unspecified.
+  virtual std::vector<double>
+  CalculateMifs(const std::vector<int>& occurrences) noexcept = 0;
 
   /// Container of important events and their importance factors.
   std::vector<ImportanceRecord> importance_;
@@ -119,6 +125,9 @@ class ImportanceAnalyzerBase : public ImportanceAnalysis {
   const std::vector<const mef::BasicEvent*>& basic_events() noexcept override {
     return prob_analyzer_->graph()->basic_events();
   }
+  const std::vector<double>& p_vars() noexcept override {
+    return prob_analyzer_->p_vars();
+  }
   std::vector<int> occurrences() noexcept override;
 
   /// Calculator of the total probability.
@@ -138,10 +147,31 @@ class ImportanceAnalyzer : public ImportanceAnalyzerBase {
         p_vars_(prob_analyzer->p_vars()) {}
 
  private:
-  double CalculateMif(int index) noexcept override;
+  std::vector<double>
+  CalculateMifs(const std::vector<int>& occurrences) noexcept override;
+
+  /// Calculates Marginal Importance Factor
+  /// with conditional total probabilities.
+  ///
+  /// @param[in] index  The position index of an event in events vector.
+  ///
+  /// @returns Calculated value for MIF.
+  double CalculateMif(int index) noexcept;
+
   Pdag::IndexMap<double> p_vars_;  ///< A copy of variable probabilities.
 };
 
+template <class Calculator>
+std::vector<double> ImportanceAnalyzer<Calculator>::CalculateMifs(
+    const std::vector<int>& occurrences) noexcept {
+  std::vector<double> mifs(occurrences.size());
+  for (int i = 0; i < occurrences.size(); ++i) {
+    if (occurrences[i])
+      mifs[i] = CalculateMif(i);
+  }
+  return mifs;
+}
+
 template <class Calculator>
 double ImportanceAnalyzer<Calculator>::CalculateMif(int index) noexcept {
   index += Pdag::kVariableStartIndex;
@@ -170,21 +200,29 @@ class ImportanceAnalyzer<Bdd> : public ImportanceAnalyzerBase {
         bdd_graph_(prob_analyzer->bdd_graph()) {}
 
  private:
-  double CalculateMif(int index) noexcept override;
+  /// Calculates Marginal Importance Factors of all variables at once
+  /// with a single backward (adjoint) pass over the BDD.
+  /// The partial derivatives of the total probability
+  /// are propagated from the root down to the variable vertices
+  /// and into modules.
+  ///
+  /// @copydetails ImportanceAnalysis::CalculateMifs
+  ///
+  /// @pre Vertex probabilities are calculated with the original values.
+  ///
+  /// @note Probability factor fields are used to save partial derivatives.
+  std::vector<double>
+  CalculateMifs(const std::vector<int>& occurrences) noexcept override;
 
-  /// Calculates Marginal Importance Factor of a variable.
+  /// Gathers vertices of the BDD with its modules in topological order.
   ///
   /// @param[in] vertex  The root vertex of a function graph.
-  /// @param[in] order  The identifying order of the variable.
   /// @param[in] mark  A flag to mark traversed vertices.
+  /// @param[in,out] vertices  The vertices in reverse topological order.
   ///
-  /// @returns Importance factor value.
-  ///
-  /// @note Probability factor fields are used to save results.
-  /// @note The graph needs cleaning its marks after this function
-  ///       because the graph gets continuously-but-partially marked.
-  double CalculateMif(const Bdd::VertexPtr& vertex, int order,
-                      bool mark) noexcept;
+  /// @post The factor fields of the gathered vertices are reset.
+  void GatherVertices(const Bdd::VertexPtr& vertex, bool mark,
+                      std::vector<Ite*>* vertices) noexcept;
 
   /// Retrieves memorized probability values for BDD function graphs.
   ///
@@ -20,8 +20,13 @@
 
 #include "initializer.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <functional>  // std::mem_fn
+#include <optional>
 #include <sstream>
+#include <thread>
 #include <type_traits>
 
 #include <boost/exception/errinfo_at_line.hpp>
@@ -31,6 +36,8 @@
 #include <boost/range/adaptor/indirected.hpp>
 #include <boost/range/algorithm.hpp>
 
+#include <libxml/parser.h>
+
 #include "cycle.h"
 #include "env.h"
 #include "error.h"
@@ -43,6 +50,7 @@
 #include "expression/test_event.h"
 #include "ext/algorithm.h"
 #include "ext/find_iterator.h"
+#include "ext/scope_guard.h"
 #include "logger.h"
 
 namespace scram::mef {
@@ -195,22 +203,47 @@ void Initializer::ProcessInputFiles(const std::vector<std::string>& xml_files) {
   LOG(DEBUG1) << "Processing input files";
   CheckFileExistence(xml_files);
   CheckDuplicateFiles(xml_files);
-  for (const auto& xml_file : xml_files) {
-    CLOCK(parse_time);
-    LOG(DEBUG3) << "Parsing " << xml_file << " ...";
-    xml::Document document(xml_file, &validator);
-    if (extra_validator_)
-      extra_validator_->validate(document);
-    documents_.emplace_back(std::move(document));
-    LOG(DEBUG3) << "Parsed " << xml_file << " in " << DUR(parse_time);
+  std::optional<ModelCache> cache;
+  if (!settings_.model_cache().empty() && !extra_validator_) {
+    cache.emplace(settings_.model_cache(), xml_files);
+    if (LoadModelCache(*cache)) {
+      LOG(DEBUG1) << "Input files are loaded from the model snapshot in "
+                  << DUR(input_time);
+      SetupForAnalysis();
+      EnsureNoCcfSubstitutions();
+      EnsureSubstitutionsWithApproximations();
+      return;
+    }
   }
   CLOCK(def_time);
-  for (const xml::Document& document : documents_) {
-    try {
-      ProcessInputFile(document);
-    } catch (ValidityError& err) {
-      err << boost::errinfo_file_name(document.root().filename());
-      throw;
+  if (settings_.stream_input() && !extra_validator_) {
+    for (const auto& xml_file : xml_files) {
+      CLOCK(stream_time);
+      LOG(DEBUG3) << "Streaming " << xml_file << " ...";
+      xml::Reader reader(xml_file, &validator);
+      tbd_streams_.push_back({xml_file, {}});
+      reader_ = &reader;
+      SCOPE_EXIT([this] { reader_ = nullptr; });
+      try {
+        ProcessInputStream(&reader);
+      } catch (ValidityError& err) {
+        err << boost::errinfo_file_name(xml_file);
+        throw;
+      }
+      documents_.emplace_back(reader.Release());
+      LOG(DEBUG3) << "Streamed " << xml_file << " in " << DUR(stream_time);
+    }
+  } else {
+    BLOG(WARNING, settings_.stream_input())
+        << "Input streaming is incompatible with extra validation";
+    ParseInputFiles(xml_files, validator);
+    for (const xml::Document& document : documents_) {
+      try {
+        ProcessInputFile(document);
+      } catch (ValidityError& err) {
+        err << boost::errinfo_file_name(document.root().filename());
+        throw;
+      }
     }
   }
   ProcessTbdElements();
@@ -222,6 +255,8 @@ void Initializer::ProcessInputFiles(const std::vector<std::string>& xml_files) {
   // Check if the initialization is successful.
   ValidateInitialization();
   LOG(DEBUG1) << "Validation is finished in " << DUR(valid_time);
+  if (cache)
+    cache->Save(*model_);
 
   CLOCK(setup_time);
   LOG(DEBUG1) << "Setting up for the analysis";
@@ -232,6 +267,82 @@ void Initializer::ProcessInputFiles(const std::vector<std::string>& xml_files) {
   LOG(DEBUG1) << "Setup time " << DUR(setup_time);
 }
 
+bool Initializer::LoadModelCache(const ModelCache& cache) {
+  std::unique_ptr<Model> model = cache.Load();
+  if (!model)
+    return false;
+  // The snapshot may be shared by analyses with different requirements.
+  if (settings_.probability_analysis() &&
+      ext::any_of(model->basic_events(), [](const BasicEvent& basic_event) {
+        return !basic_event.HasExpression();
+      })) {
+    LOG(DEBUG1) << "The model snapshot lacks probabilities for the analysis";
+    return false;
+  }
+  model_ = std::move(model);
+  model_->mission_time().value(settings_.mission_time());
+  return true;
+}
+
+void Initializer::ParseInputFiles(const std::vector<std::string>& xml_files,
+                                  const xml::Validator& validator) {
+  auto parse_file = [this, &validator](const std::string& xml_file) {
+    CLOCK(parse_time);
+    LOG(DEBUG3) << "Parsing " << xml_file << " ...";
+    xml::Document document(xml_file, &validator);
+    if (extra_validator_)
+      extra_validator_->validate(document);
+    LOG(DEBUG3) << "Parsed " << xml_file << " in " << DUR(parse_time);
+    return document;
+  };
+
+  int num_jobs = std::min<int>(settings_.num_jobs(), xml_files.size());
+  if (num_jobs < 2) {
+    for (const auto& xml_file : xml_files)
+      documents_.emplace_back(parse_file(xml_file));
+    return;
+  }
+
+  LOG(DEBUG2) << "Parsing " << xml_files.size() << " files in " << num_jobs
+              << " jobs...";
+  xmlInitParser();  // The library global state must precede the threads.
+  std::vector<std::optional<xml::Document>> documents(xml_files.size());
+  std::vector<std::exception_ptr> errors(xml_files.size());
+  std::atomic<int> next_file = 0;
+  auto run_job = [&] {
+    for (int i = next_file++; i < xml_files.size(); i = next_file++) {
+      try {
+        documents[i].emplace(parse_file(xml_files[i]));
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    }
+  };
+  std::vector<std::thread> jobs;
+  jobs.reserve(num_jobs);
+  for (int i = 0; i < num_jobs; ++i)
+    jobs.emplace_back(run_job);
+  for (std::thread& job : jobs)
+    job.join();
+
+  for (const std::exception_ptr& error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+  for (std::optional<xml::Document>& document : documents)
+    documents_.emplace_back(std::move(*document));
+}
+
+template <class T>
+void Initializer::Defer(T* element, const xml::Element& xml_element) {
+  if (reader_) {
+    tbd_streams_.back().elements.emplace_back(element,
+                                              reader_->Locate(xml_element));
+  } else {
+    tbd_.emplace_back(element, xml_element);
+  }
+}
+
 template <class T>
 void Initializer::Register(std::unique_ptr<T> element,
                            const xml::Element& xml_element) {
@@ -254,7 +365,7 @@ Gate* Initializer::Register(const xml::Element& gate_node,
   auto* gate = ptr.get();
   Register(std::move(ptr), gate_node);
   path_gates_.insert(gate);
-  tbd_.emplace_back(gate, gate_node);
+  Defer(gate, gate_node);
   return gate;
 }
 
@@ -267,7 +378,7 @@ BasicEvent* Initializer::Register(const xml::Element& event_node,
   auto* basic_event = ptr.get();
   Register(std::move(ptr), event_node);
   path_basic_events_.insert(basic_event);
-  tbd_.emplace_back(basic_event, event_node);
+  Defer(basic_event, event_node);
   return basic_event;
 }
 
@@ -297,7 +408,7 @@ Parameter* Initializer::Register(const xml::Element& param_node,
   auto* parameter = ptr.get();
   Register(std::move(ptr), param_node);
   path_parameters_.insert(parameter);
-  tbd_.emplace_back(parameter, param_node);
+  Defer(parameter, param_node);
 
   // Attach units.
   std::string_view unit = param_node.attribute("unit");
@@ -332,7 +443,7 @@ CcfGroup* Initializer::Register(const xml::Element& ccf_node,
 
   ProcessCcfMembers(*ccf_node.child("members"), ccf_group);
 
-  tbd_.emplace_back(ccf_group, ccf_node);
+  Defer(ccf_group, ccf_node);
   return ccf_group;
 }
 
@@ -343,7 +454,7 @@ Sequence* Initializer::Register(const xml::Element& xml_node,
   std::unique_ptr<Sequence> ptr = ConstructElement<Sequence>(xml_node);
   auto* sequence = ptr.get();
   Register(std::move(ptr), xml_node);
-  tbd_.emplace_back(sequence, xml_node);
+  Defer(sequence, xml_node);
   return sequence;
 }
 /// @}
@@ -357,53 +468,86 @@ void Initializer::ProcessInputFile(const xml::Document& document) {
     model_->mission_time().value(settings_.mission_time());
   }
 
-  for (const xml::Element& node : root.children()) {
-    if (node.name() == "define-initiating-event") {
-      std::unique_ptr<InitiatingEvent> initiating_event =
-          ConstructElement<InitiatingEvent>(node);
-      auto* ref_ptr = initiating_event.get();
-      Register(std::move(initiating_event), node);
-      tbd_.emplace_back(ref_ptr, node);
+  for (const xml::Element& node : root.children())
+    ProcessDefinition(node);
+}
 
-    } else if (node.name() == "define-rule") {
-      std::unique_ptr<Rule> rule = ConstructElement<Rule>(node);
-      auto* ref_ptr = rule.get();
-      Register(std::move(rule), node);
-      tbd_.emplace_back(ref_ptr, node);
+void Initializer::ProcessDefinition(const xml::Element& node) {
+  if (node.name() == "define-initiating-event") {
+    std::unique_ptr<InitiatingEvent> initiating_event =
+        ConstructElement<InitiatingEvent>(node);
+    auto* ref_ptr = initiating_event.get();
+    Register(std::move(initiating_event), node);
+    Defer(ref_ptr, node);
 
-    } else if (node.name() == "define-event-tree") {
-      DefineEventTree(node);
+  } else if (node.name() == "define-rule") {
+    std::unique_ptr<Rule> rule = ConstructElement<Rule>(node);
+    auto* ref_ptr = rule.get();
+    Register(std::move(rule), node);
+    Defer(ref_ptr, node);
 
-    } else if (node.name() == "define-fault-tree") {
-      DefineFaultTree(node);
+  } else if (node.name() == "define-event-tree") {
+    DefineEventTree(node);
 
-    } else if (node.name() == "define-CCF-group") {
-      Register<CcfGroup>(node, "", RoleSpecifier::kPublic);
+  } else if (node.name() == "define-fault-tree") {
+    DefineFaultTree(node);
 
-    } else if (node.name() == "define-alignment") {
-      std::unique_ptr<Alignment> alignment = ConstructElement<Alignment>(node);
-      auto* address = alignment.get();
-      Register(std::move(alignment), node);
-      tbd_.emplace_back(address, node);
+  } else if (node.name() == "define-CCF-group") {
+    Register<CcfGroup>(node, "", RoleSpecifier::kPublic);
 
-    } else if (node.name() == "define-substitution") {
-      std::unique_ptr<Substitution> substitution =
-          ConstructElement<Substitution>(node);
-      auto* address = substitution.get();
-      Register(std::move(substitution), node);
-      tbd_.emplace_back(address, node);
+  } else if (node.name() == "define-alignment") {
+    std::unique_ptr<Alignment> alignment = ConstructElement<Alignment>(node);
+    auto* address = alignment.get();
+    Register(std::move(alignment), node);
+    Defer(address, node);
 
-    } else if (node.name() == "model-data") {
-      ProcessModelData(node);
+  } else if (node.name() == "define-substitution") {
+    std::unique_ptr<Substitution> substitution =
+        ConstructElement<Substitution>(node);
+    auto* address = substitution.get();
+    Register(std::move(substitution), node);
+    Defer(address, node);
 
-    } else if (node.name() == "define-extern-library") {
-      if (!allow_extern_) {
-        SCRAM_THROW(
-            IllegalOperation("Loading external libraries is disallowed!"))
-            << boost::errinfo_file_name(node.filename())
-            << boost::errinfo_at_line(node.line());
-      }
-      DefineExternLibraries(node);
+  } else if (node.name() == "model-data") {
+    ProcessModelData(node);
+
+  } else if (node.name() == "define-extern-library") {
+    if (!allow_extern_) {
+      SCRAM_THROW(IllegalOperation("Loading external libraries is disallowed!"))
+          << boost::errinfo_file_name(node.filename())
+          << boost::errinfo_at_line(node.line());
+    }
+    DefineExternLibraries(node);
+  }
+}
+
+void Initializer::ProcessInputStream(xml::Reader* reader) {
+  xml::Element root = reader->Enter();
+  assert(root.name() == "opsa-mef");
+
+  if (!model_) {  // Create only one model for multiple files.
+    model_ = ConstructElement<Model>(root);
+    model_->mission_time().value(settings_.mission_time());
+  }
+
+  while (std::optional<std::string_view> name = reader->Next()) {
+    if (*name == "define-fault-tree") {
+      xml::Element ft_node = reader->Enter();
+      std::unique_ptr<FaultTree> fault_tree =
+          ConstructElement<FaultTree>(ft_node);
+      StreamFaultTreeData(reader, fault_tree->name(), fault_tree.get());
+      Register(std::move(fault_tree), ft_node);
+
+    } else if (*name == "model-data") {
+      reader->Enter();
+      while (reader->Next())
+        RegisterModelData(reader->Expand());
+
+    } else if (*name == "define-extern-function") {
+      reader->Retain(reader->Expand());  // Defined with the TBD elements.
+
+    } else {
+      ProcessDefinition(reader->Expand());
     }
   }
 }
@@ -615,6 +759,59 @@ void Initializer::ProcessTbdElements() {
       throw;
     }
   }
+
+  for (const TbdStream& tbd_stream : tbd_streams_) {
+    try {
+      DefineStreamedElements(tbd_stream);
+    } catch (ValidityError& err) {
+      err << boost::errinfo_file_name(tbd_stream.xml_file);
+      throw;
+    }
+  }
+}
+
+void Initializer::DefineStreamedElements(const TbdStream& tbd_stream) {
+  CLOCK(stream_time);
+  LOG(DEBUG3) << "Streaming " << tbd_stream.xml_file << " for definitions...";
+  xml::Reader reader(tbd_stream.xml_file);  // Validated upon registration.
+  reader.Enter();
+  int depth = 1;  // The number of entered elements.
+  auto it = tbd_stream.elements.begin();
+  while (it != tbd_stream.elements.end()) {
+    std::optional<std::string_view> name = reader.Next();
+    if (!name) {  // The end of an entered element.
+      assert(depth > 1 && "Definitions are not found in the file.");
+      if (--depth == 0)
+        break;
+      continue;
+    }
+    // The containers are entered as upon the registration
+    // to reproduce the reading order of elements.
+    if (*name == "define-fault-tree" || *name == "define-component" ||
+        *name == "model-data") {
+      reader.Enter();
+      ++depth;
+      continue;
+    }
+    if (reader.index() < it->second.index)
+      continue;  // Skipped without expansion.
+    assert(reader.index() == it->second.index);
+    xml::Element xml_node = reader.Expand();
+    for (; it != tbd_stream.elements.end() &&
+           it->second.index == reader.index();
+         ++it) {
+      xml::Element xml_element = xml_node;
+      for (int child_index : it->second.path)
+        xml_element = *std::next(xml_element.children().begin(), child_index);
+      std::visit(
+          [this, &xml_element](auto* tbd_construct) {
+            this->Define(xml_element, tbd_construct);
+          },
+          it->first);
+    }
+  }
+  documents_.emplace_back(reader.Release());  // For the file name.
+  LOG(DEBUG3) << "Streamed definitions in " << DUR(stream_time);
 }
 
 void Initializer::DefineEventTree(const xml::Element& et_node) {
@@ -642,7 +839,7 @@ void Initializer::DefineEventTree(const xml::Element& et_node) {
   EventTree* tbd_element = event_tree.get();
   Register(std::move(event_tree), et_node);
   // Save only after registration.
-  tbd_.emplace_back(tbd_element, et_node);
+  Defer(tbd_element, et_node);
 }
 
 void Initializer::DefineFaultTree(const xml::Element& ft_node) {
@@ -664,47 +861,76 @@ std::unique_ptr<Component> Initializer::DefineComponent(
 void Initializer::RegisterFaultTreeData(const xml::Element& ft_node,
                                         const std::string& base_path,
                                         Component* component) {
-  for (const xml::Element& node : ft_node.children()) {
-    if (node.name() == "define-basic-event") {
-      component->Add(Register<BasicEvent>(node, base_path, component->role()));
+  for (const xml::Element& node : ft_node.children())
+    RegisterFaultTreeElement(node, base_path, component);
+}
 
-    } else if (node.name() == "define-parameter") {
-      component->Add(Register<Parameter>(node, base_path, component->role()));
+void Initializer::RegisterFaultTreeElement(const xml::Element& node,
+                                           const std::string& base_path,
+                                           Component* component) {
+  if (node.name() == "define-basic-event") {
+    component->Add(Register<BasicEvent>(node, base_path, component->role()));
 
-    } else if (node.name() == "define-gate") {
-      component->Add(Register<Gate>(node, base_path, component->role()));
+  } else if (node.name() == "define-parameter") {
+    component->Add(Register<Parameter>(node, base_path, component->role()));
 
-    } else if (node.name() == "define-house-event") {
-      component->Add(Register<HouseEvent>(node, base_path, component->role()));
+  } else if (node.name() == "define-gate") {
+    component->Add(Register<Gate>(node, base_path, component->role()));
 
-    } else if (node.name() == "define-CCF-group") {
-      component->Add(Register<CcfGroup>(node, base_path, component->role()));
+  } else if (node.name() == "define-house-event") {
+    component->Add(Register<HouseEvent>(node, base_path, component->role()));
 
-    } else if (node.name() == "define-component") {
-      std::unique_ptr<Component> sub =
-          DefineComponent(node, base_path, component->role());
-      try {
-        component->Add(std::move(sub));
-      } catch (ValidityError& err) {
-        err << boost::errinfo_at_line(node.line());
-        throw;
-      }
+  } else if (node.name() == "define-CCF-group") {
+    component->Add(Register<CcfGroup>(node, base_path, component->role()));
+
+  } else if (node.name() == "define-component") {
+    std::unique_ptr<Component> sub =
+        DefineComponent(node, base_path, component->role());
+    try {
+      component->Add(std::move(sub));
+    } catch (ValidityError& err) {
+      err << boost::errinfo_at_line(node.line());
+      throw;
     }
   }
 }
 
-void Initializer::ProcessModelData(const xml::Element& model_data) {
-  for (const xml::Element& node : model_data.children()) {
-    if (node.name() == "define-basic-event") {
-      Register<BasicEvent>(node, "", RoleSpecifier::kPublic);
-    } else if (node.name() == "define-parameter") {
-      Register<Parameter>(node, "", RoleSpecifier::kPublic);
-    } else if (node.name() == "define-house-event") {
-      Register<HouseEvent>(node, "", RoleSpecifier::kPublic);
+void Initializer::StreamFaultTreeData(xml::Reader* reader,
+                                      const std::string& base_path,
+                                      Component* component) {
+  while (std::optional<std::string_view> name = reader->Next()) {
+    if (*name != "define-component") {
+      RegisterFaultTreeElement(reader->Expand(), base_path, component);
+      continue;
+    }
+    xml::Element component_node = reader->Enter();
+    std::unique_ptr<Component> sub = ConstructElement<Component>(
+        component_node, base_path, component->role());
+    StreamFaultTreeData(reader, base_path + "." + sub->name(), sub.get());
+    try {
+      component->Add(std::move(sub));
+    } catch (ValidityError& err) {
+      err << boost::errinfo_at_line(component_node.line());
+      throw;
     }
   }
 }
 
+void Initializer::ProcessModelData(const xml::Element& model_data) {
+  for (const xml::Element& node : model_data.children())
+    RegisterModelData(node);
+}
+
+void Initializer::RegisterModelData(const xml::Element& node) {
+  if (node.name() == "define-basic-event") {
+    Register<BasicEvent>(node, "", RoleSpecifier::kPublic);
+  } else if (node.name() == "define-parameter") {
+    Register<Parameter>(node, "", RoleSpecifier::kPublic);
+  } else if (node.name() == "define-house-event") {
+    Register<HouseEvent>(node, "", RoleSpecifier::kPublic);
+  }
+}
+
 std::unique_ptr<Formula> Initializer::GetFormula(
     const xml::Element& formula_node, const std::string& base_path) {
   Connective formula_type = [&formula_node]() {
@@ -1217,7 +1443,8 @@ Expression* Initializer::GetExpression(const xml::Element& expr_element,
     Expression* expression = register_expression(kExpressionExtractors_.at(
         expr_type)(expr_element.children(), base_path, this));
     // Register for late validation after ensuring no cycles.
-    expressions_.emplace_back(expression, expr_element);
+    expressions_.emplace_back(expression, expr_element.filename(),
+                              expr_element.line());
     return expression;
   } catch (ValidityError& err) {
     err << boost::errinfo_at_line(expr_element.line());
@@ -1800,12 +2027,11 @@ void Initializer::ValidateExpressions() {
   cycle::CheckCycle<Parameter>(model_->table<Parameter>(), "parameter");
 
   // Validate expressions.
-  for (const std::pair<Expression*, xml::Element>& expression : expressions_) {
+  for (const auto& [expression, filename, line] : expressions_) {
     try {
-      expression.first->Validate();
+      expression->Validate();
     } catch (ValidityError& err) {
-      err << boost::errinfo_file_name(expression.second.filename())
-          << boost::errinfo_at_line(expression.second.line());
+      err << boost::errinfo_file_name(filename) << boost::errinfo_at_line(line);
       throw;
     }
   }
@@ -24,6 +24,7 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <variant>
@@ -44,6 +45,7 @@
 #include "fault_tree.h"
 #include "instruction.h"
 #include "model.h"
+#include "model_cache.h"
 #include "parameter.h"
 #include "settings.h"
 #include "substitution.h"
@@ -91,10 +93,18 @@ class Initializer : private boost::noncopyable {
       const xml::Element::Range&, const std::string&, Initializer*);
   /// Map of expression names and their extractor functions.
   using ExtractorMap = std::unordered_map<std::string_view, ExtractorFunction>;
-  /// Container for late defined constructs.
-  template <class... Ts>
-  using TbdContainer =
-      std::vector<std::pair<std::variant<Ts*...>, xml::Element>>;
+  /// Constructs defined late.
+  using TbdElement =
+      std::variant<Parameter*, BasicEvent*, Gate*, CcfGroup*, Sequence*,
+                   EventTree*, InitiatingEvent*, Rule*, Alignment*,
+                   Substitution*>;
+  /// Late defined constructs of a streamed input file
+  /// to be found by streaming the file again.
+  struct TbdStream {
+    std::string xml_file;  ///< The path to the input file.
+    /// The constructs with the positions of their XML definitions.
+    std::vector<std::pair<TbdElement, xml::Reader::Position>> elements;
+  };
   /// Container with full paths to elements.
   ///
   /// @tparam T  The element type.
@@ -157,6 +167,29 @@ class Initializer : private boost::noncopyable {
   /// @throws IOError  Input contains duplicate files.
   void ProcessInputFiles(const std::vector<std::string>& xml_files);
 
+  /// Loads the validated model from the snapshot of the input files.
+  ///
+  /// @param[in] cache  The model cache for the input files.
+  ///
+  /// @returns false if the snapshot is missing or unsuitable for the settings.
+  bool LoadModelCache(const ModelCache& cache);
+
+  /// Parses and validates the input files into documents.
+  /// With several jobs in the settings,
+  /// the files are parsed concurrently,
+  /// but the documents are stored in the order of the input files.
+  /// If several files fail,
+  /// the error of the earliest file in the input order is reported.
+  ///
+  /// @param[in] xml_files  The formatted XML input files.
+  /// @param[in] validator  The MEF schema validator.
+  ///
+  /// @throws xml::Error  The xml files are erroneous or malformed.
+  /// @throws xml::ValidityError The xml files do not pass validation.
+  /// @throws IOError  One of the input files is not accessible.
+  void ParseInputFiles(const std::vector<std::string>& xml_files,
+                       const xml::Validator& validator);
+
   /// Reads one input XML file document with the structure of analysis entities.
   /// Initializes the analysis from the given document.
   /// Puts all events into their appropriate containers.
@@ -172,6 +205,27 @@ class Initializer : private boost::noncopyable {
   /// @throws IllegalOperation  Loading external libraries is disallowed.
   void ProcessInputFile(const xml::Document& document);
 
+  /// Streams one input XML file into the model.
+  /// The elements left to be defined later
+  /// are remembered by their positions in the file.
+  ///
+  /// @param[in,out] reader  The reader positioned at the root of the file.
+  ///
+  /// @pre The file has not been passed before.
+  ///
+  /// @throws ValidityError  The input model contains errors.
+  /// @throws IllegalOperation  Loading external libraries is disallowed.
+  /// @throws xml::Error  The XML file is erroneous or malformed.
+  void ProcessInputStream(xml::Reader* reader);
+
+  /// Processes a top-level definition of an input file.
+  ///
+  /// @param[in] node  The child XML element of the root.
+  ///
+  /// @throws ValidityError  The input model contains errors.
+  /// @throws IllegalOperation  Loading external libraries is disallowed.
+  void ProcessDefinition(const xml::Element& node);
+
   /// Processes definitions of elements
   /// that are left to be determined later.
   /// This late definition happens primarily due to unregistered dependencies.
@@ -179,6 +233,24 @@ class Initializer : private boost::noncopyable {
   /// @throws ValidityError  The elements contain undefined dependencies.
   void ProcessTbdElements();
 
+  /// Streams an input file again
+  /// to define the elements left to be determined later.
+  /// The file is walked the same way as upon the registration.
+  ///
+  /// @param[in] tbd_stream  The elements of the file.
+  ///
+  /// @throws ValidityError  The elements contain undefined dependencies.
+  void DefineStreamedElements(const TbdStream& tbd_stream);
+
+  /// Leaves an element to be defined later.
+  ///
+  /// @tparam T  The element type.
+  ///
+  /// @param[in] element  The registered element.
+  /// @param[in] xml_element  The XML element with the definition.
+  template <class T>
+  void Defer(T* element, const xml::Element& xml_element);
+
   /// Registers an element into the model.
   ///
   /// @tparam T  The element type.
@@ -263,11 +335,40 @@ class Initializer : private boost::noncopyable {
                              const std::string& base_path,
                              Component* component);
 
+  /// Registers one element of fault tree or component data.
+  ///
+  /// @param[in] node  XML element defining the data.
+  /// @param[in] base_path  Series of ancestor containers in the path with dots.
+  /// @param[in,out] component  The owner of the data.
+  ///
+  /// @throws ValidityError  There are issues with registering and defining
+  ///                        the data.
+  void RegisterFaultTreeElement(const xml::Element& node,
+                                const std::string& base_path,
+                                Component* component);
+
+  /// Streams fault tree and component data into the container.
+  ///
+  /// @param[in,out] reader  The reader inside the fault tree or component.
+  /// @param[in] base_path  Series of ancestor containers in the path with dots.
+  /// @param[in,out] component  The owner of the data.
+  ///
+  /// @throws ValidityError  There are issues with registering and defining
+  ///                        the component's data like gates and events.
+  /// @throws xml::Error  The XML file is erroneous or malformed.
+  void StreamFaultTreeData(xml::Reader* reader, const std::string& base_path,
+                           Component* component);
+
   /// Processes model data with definitions of events and analysis.
   ///
   /// @param[in] model_data  XML node with model data description.
   void ProcessModelData(const xml::Element& model_data);
 
+  /// Registers one element of model data.
+  ///
+  /// @param[in] node  XML element defining the event or parameter.
+  void RegisterModelData(const xml::Element& node);
+
   /// Creates a Boolean formula from the XML elements
   /// describing the formula with events and other nested formulas.
   ///
@@ -496,7 +597,10 @@ class Initializer : private boost::noncopyable {
   xml::Validator* extra_validator_;  ///< The optional extra XML validation.
 
   /// Saved XML documents to keep elements alive.
+  /// Streamed files are represented by the retained elements only.
   std::vector<xml::Document> documents_;
+  /// The reader of the currently streamed file.
+  xml::Reader* reader_ = nullptr;
 
   /// Collection of elements that are defined late
   /// because of unordered registration and definition of their dependencies.
@@ -511,12 +615,14 @@ class Initializer : private boost::noncopyable {
   /// Substitutions depend on basic events.
   ///
   /// Elements are assumed to be unique.
-  TbdContainer<Parameter, BasicEvent, Gate, CcfGroup, Sequence, EventTree,
-               InitiatingEvent, Rule, Alignment, Substitution>
-      tbd_;
-
-  /// Container of defined expressions for later validation due to cycles.
-  std::vector<std::pair<Expression*, xml::Element>> expressions_;
+  std::vector<std::pair<TbdElement, xml::Element>> tbd_;
+  /// Late defined constructs of streamed files
+  /// without the XML definitions kept in memory.
+  std::vector<TbdStream> tbd_streams_;
+
+  /// Container of defined expressions for later validation due to cycles
+  /// with the file names and line numbers of the definitions.
+  std::vector<std::tuple<Expression*, const char*, int>> expressions_;
   /// Container for event tree links to check for cycles.
   std::vector<Link*> links_;
 
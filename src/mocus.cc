@@ -27,12 +27,15 @@
 
 #include "mocus.h"
 
+#include "ext/find_iterator.h"
 #include "logger.h"
 
 namespace scram::core {
 
 Mocus::Mocus(const Pdag* graph, const Settings& settings)
-    : graph_(graph), kSettings_(settings) {
+    : graph_(graph),
+      kSettings_(settings),
+      p_vars_(Zbdd::GetProbabilities(*graph, settings)) {
   assert(!graph->complement() && "Complements must be propagated.");
 }
 
@@ -64,7 +67,7 @@ Mocus::AnalyzeModule(const Gate& gate, const Settings& settings) noexcept {
   const int kMaxVariableIndex =
       Pdag::kVariableStartIndex + graph_->basic_events().size() - 1;
   auto container = std::make_unique<zbdd::CutSetContainer>(
-      kSettings_, gate.index(), kMaxVariableIndex);
+      settings, gate.index(), kMaxVariableIndex, p_vars_);
   container->Merge(container->ConvertGate(gate));
   while (int next_gate_index = container->GetNextGate()) {
     LOG(DEBUG5) << "Expanding gate G" << next_gate_index;
@@ -83,6 +86,7 @@ Mocus::AnalyzeModule(const Gate& gate, const Settings& settings) noexcept {
     container->EliminateComplements();
     container->Minimize();
   }
+  std::unordered_map<int, double> cut_offs = container->GatherModuleCutOffs();
   for (const auto& entry : container->GatherModules()) {
     int index = entry.first;
     assert(index > 0 && "No complement modules are expected.");
@@ -97,6 +101,8 @@ Mocus::AnalyzeModule(const Gate& gate, const Settings& settings) noexcept {
     }
     Settings adjusted(settings);
     adjusted.limit_order(limit);
+    if (auto it = ext::find(cut_offs, index))
+      adjusted.cut_off(it->second);
     container->JoinModule(index,
                           AnalyzeModule(*gates.find(index)->second, adjusted));
   }
@@ -74,6 +74,7 @@ class Mocus : private boost::noncopyable {
 
   const Pdag* graph_;  ///< The analysis PDAG.
   const Settings kSettings_;  ///< Analysis settings.
+  Zbdd::Probabilities p_vars_;  ///< Variable probabilities for the cut-off.
   std::unique_ptr<Zbdd> zbdd_;  ///< ZBDD as a result of analysis.
 };
 
@@ -0,0 +1,1414 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of the binary model snapshots.
+///
+/// The snapshot is a sequence of records in the native byte order.
+/// The model constructs are recorded in the order of their dependencies,
+/// so all references are indices into the preceding records.
+
+#include "model_cache.h"
+
+#include <cstring>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string_view>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <boost/exception/errinfo_file_name.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "alignment.h"
+#include "ccf_group.h"
+#include "error.h"
+#include "event.h"
+#include "event_tree.h"
+#include "expression/boolean.h"
+#include "expression/conditional.h"
+#include "expression/constant.h"
+#include "expression/exponential.h"
+#include "expression/numerical.h"
+#include "expression/random_deviate.h"
+#include "expression/test_event.h"
+#include "ext/variant.h"
+#include "fault_tree.h"
+#include "instruction.h"
+#include "logger.h"
+#include "parameter.h"
+#include "substitution.h"
+#include "version.h"
+#include "xml.h"
+
+namespace fs = boost::filesystem;
+
+namespace scram::mef {
+
+namespace {  // The snapshot format.
+
+const char kMagic[8] = {'S', 'C', 'R', 'A', 'M', 'M', 'E', 'F'};
+const std::uint32_t kFormatVersion = 1;  ///< Changes with the records.
+
+/// The kinds of references to expressions.
+enum ExpressionRef : std::uint8_t {
+  kExpressionRef = 0,  ///< An expression record.
+  kParameterRef,  ///< A model parameter.
+  kMissionTimeRef,  ///< The model mission time.
+  kOneRef,  ///< The shared constant 1.
+  kZeroRef,  ///< The shared constant 0.
+  kPiRef  ///< The shared constant PI.
+};
+
+/// The kinds of expression records.
+enum ExpressionKind : std::uint8_t {
+  kConstant = 0,
+  kTestInitiatingEvent,
+  kTestFunctionalEvent,
+  kBuiltin  ///< An expression from the table of built-in types.
+};
+
+/// The kinds of references to formula argument events.
+enum EventRef : std::uint8_t { kGateRef = 0, kBasicEventRef, kHouseEventRef,
+                               kTrueRef, kFalseRef };
+
+/// The kinds of references to instructions.
+enum InstructionRef : std::uint8_t { kInstructionRef = 0, kRuleRef };
+
+/// The kinds of instruction records.
+enum InstructionKind : std::uint8_t {
+  kSetHouseEvent = 0,
+  kCollectExpression,
+  kCollectFormula,
+  kIfThenElse,
+  kBlock,
+  kLink
+};
+
+/// The kinds of branch targets.
+enum TargetKind : std::uint8_t { kSequenceTarget = 0, kForkTarget,
+                                 kBranchTarget };
+
+/// The kinds of CCF models.
+enum CcfKind : std::uint8_t { kBetaFactor = 0, kMgl, kAlphaFactor, kPhiFactor };
+
+/// @returns The error for malformed snapshot data.
+IOError CorruptSnapshot() {
+  return IOError("The model snapshot is corrupted.");
+}
+
+/// The constructor of built-in expressions from their arguments.
+using ExpressionBuilder =
+    std::unique_ptr<Expression> (*)(const std::vector<Expression*>&);
+
+/// @returns The number of arguments for the fixed-arity constructor of T.
+template <class T, class... Ts>
+constexpr int arity() {
+  if constexpr (std::is_constructible_v<T, Ts...>) {
+    return sizeof...(Ts);
+  } else {
+    return arity<T, Expression*, Ts...>();
+  }
+}
+
+/// Constructs an expression with a fixed number of arguments.
+template <class T, std::size_t... Is>
+std::unique_ptr<Expression> Construct(const std::vector<Expression*>& args,
+                                      std::index_sequence<Is...>) {
+  if (args.size() != sizeof...(Is))
+    SCRAM_THROW(CorruptSnapshot());
+  return std::make_unique<T>(args[Is]...);
+}
+
+/// Builds a built-in expression from its arguments
+/// in the order of Expression::args().
+template <class T>
+std::unique_ptr<Expression> Build(const std::vector<Expression*>& args) {
+  if constexpr (std::is_constructible_v<T, std::vector<Expression*>>) {
+    return std::make_unique<T>(args);
+  } else {
+    return Construct<T>(args, std::make_index_sequence<arity<T>()>());
+  }
+}
+
+/// Specializations for expressions with overloaded or composite arguments.
+/// @{
+template <>
+std::unique_ptr<Expression> Build<LognormalDeviate>(
+    const std::vector<Expression*>& args) {
+  if (args.size() == 3)
+    return Construct<LognormalDeviate>(args, std::make_index_sequence<3>());
+  return Construct<LognormalDeviate>(args, std::make_index_sequence<2>());
+}
+
+template <>
+std::unique_ptr<Expression> Build<PeriodicTest>(
+    const std::vector<Expression*>& args) {
+  switch (args.size()) {
+    case 4:
+      return Construct<PeriodicTest>(args, std::make_index_sequence<4>());
+    case 5:
+      return Construct<PeriodicTest>(args, std::make_index_sequence<5>());
+    default:
+      return Construct<PeriodicTest>(args, std::make_index_sequence<11>());
+  }
+}
+
+template <>
+std::unique_ptr<Expression> Build<Histogram>(
+    const std::vector<Expression*>& args) {
+  if (args.size() < 3 || args.size() % 2 == 0)
+    SCRAM_THROW(CorruptSnapshot());
+  auto it_weights = std::next(args.begin(), (args.size() + 1) / 2);
+  return std::make_unique<Histogram>(
+      std::vector<Expression*>(args.begin(), it_weights),
+      std::vector<Expression*>(it_weights, args.end()));
+}
+
+template <>
+std::unique_ptr<Expression> Build<Switch>(
+    const std::vector<Expression*>& args) {
+  if (args.empty() || args.size() % 2 == 0)
+    SCRAM_THROW(CorruptSnapshot());
+  std::vector<Switch::Case> cases;
+  for (auto it = std::next(args.begin()); it != args.end(); it += 2)
+    cases.push_back({**it, **std::next(it)});
+  return std::make_unique<Switch>(std::move(cases), args.front());
+}
+/// @}
+
+/// The built-in expression types with their builders.
+/// The position of the type in this table identifies it in snapshots.
+const std::pair<std::type_index, ExpressionBuilder> kExpressionTypes[] = {
+    {typeid(Exponential), &Build<Exponential>},
+    {typeid(Glm), &Build<Glm>},
+    {typeid(Weibull), &Build<Weibull>},
+    {typeid(PeriodicTest), &Build<PeriodicTest>},
+    {typeid(UniformDeviate), &Build<UniformDeviate>},
+    {typeid(NormalDeviate), &Build<NormalDeviate>},
+    {typeid(LognormalDeviate), &Build<LognormalDeviate>},
+    {typeid(GammaDeviate), &Build<GammaDeviate>},
+    {typeid(BetaDeviate), &Build<BetaDeviate>},
+    {typeid(Histogram), &Build<Histogram>},
+    {typeid(Neg), &Build<Neg>},
+    {typeid(Add), &Build<Add>},
+    {typeid(Sub), &Build<Sub>},
+    {typeid(Mul), &Build<Mul>},
+    {typeid(Div), &Build<Div>},
+    {typeid(Abs), &Build<Abs>},
+    {typeid(Acos), &Build<Acos>},
+    {typeid(Asin), &Build<Asin>},
+    {typeid(Atan), &Build<Atan>},
+    {typeid(Cos), &Build<Cos>},
+    {typeid(Sin), &Build<Sin>},
+    {typeid(Tan), &Build<Tan>},
+    {typeid(Cosh), &Build<Cosh>},
+    {typeid(Sinh), &Build<Sinh>},
+    {typeid(Tanh), &Build<Tanh>},
+    {typeid(Exp), &Build<Exp>},
+    {typeid(Log), &Build<Log>},
+    {typeid(Log10), &Build<Log10>},
+    {typeid(Mod), &Build<Mod>},
+    {typeid(Pow), &Build<Pow>},
+    {typeid(Sqrt), &Build<Sqrt>},
+    {typeid(Ceil), &Build<Ceil>},
+    {typeid(Floor), &Build<Floor>},
+    {typeid(Min), &Build<Min>},
+    {typeid(Max), &Build<Max>},
+    {typeid(Mean), &Build<Mean>},
+    {typeid(Not), &Build<Not>},
+    {typeid(And), &Build<And>},
+    {typeid(Or), &Build<Or>},
+    {typeid(Eq), &Build<Eq>},
+    {typeid(Df), &Build<Df>},
+    {typeid(Lt), &Build<Lt>},
+    {typeid(Gt), &Build<Gt>},
+    {typeid(Leq), &Build<Leq>},
+    {typeid(Geq), &Build<Geq>},
+    {typeid(Ite), &Build<Ite>},
+    {typeid(Switch), &Build<Switch>}};
+
+/// Output buffer of snapshot records.
+class Encoder {
+ public:
+  /// Appends a number to the buffer.
+  template <class T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+  void Put(T value) {
+    data_.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  /// Appends a string with its size to the buffer.
+  void Put(std::string_view value) {
+    Put<std::uint32_t>(value.size());
+    data_.append(value.data(), value.size());
+  }
+
+  /// Appends the contents of another buffer.
+  void Put(const Encoder& other) { data_ += other.data_; }
+
+  /// @returns The buffer data.
+  const std::string& data() const { return data_; }
+
+ private:
+  std::string data_;  ///< The encoded records.
+};
+
+/// Input cursor over snapshot records.
+class Decoder {
+ public:
+  /// @param[in] data  The start of the encoded records.
+  /// @param[in] size  The number of bytes in the data.
+  Decoder(const char* data, std::size_t size)
+      : cur_(data), end_(data + size) {}
+
+  /// @returns true if all the data has been read.
+  bool empty() const { return cur_ == end_; }
+
+  /// @returns The next number in the data.
+  ///
+  /// @throws IOError  The data is truncated.
+  template <class T>
+  T Get() {
+    static_assert(std::is_arithmetic_v<T>);
+    T value;
+    std::memcpy(&value, Take(sizeof(value)), sizeof(value));
+    return value;
+  }
+
+  /// @returns The next string in the data.
+  ///
+  /// @throws IOError  The data is truncated.
+  std::string GetString() {
+    auto size = Get<std::uint32_t>();
+    return std::string(Take(size), size);
+  }
+
+  /// @returns The next number as an index into the container.
+  ///
+  /// @throws IOError  The index is out of range.
+  template <class T>
+  auto GetIndex(const std::vector<T>& container) {
+    auto index = Get<std::uint32_t>();
+    if (index >= container.size())
+      SCRAM_THROW(CorruptSnapshot());
+    return container[index];
+  }
+
+ private:
+  /// Advances the cursor over the given number of bytes.
+  ///
+  /// @returns The position before the advance.
+  ///
+  /// @throws IOError  The data is truncated.
+  const char* Take(std::size_t size) {
+    if (size > static_cast<std::size_t>(end_ - cur_))
+      SCRAM_THROW(CorruptSnapshot());
+    const char* data = cur_;
+    cur_ += size;
+    return data;
+  }
+
+  const char* cur_;  ///< The current position in the data.
+  const char* end_;  ///< The end of the data.
+};
+
+/// Encodes the model constructs into snapshot records.
+class SnapshotWriter {
+ public:
+  /// @param[in] model  The validated model without the analysis setup.
+  explicit SnapshotWriter(const Model& model) : model_(model) {}
+
+  /// Encodes the model.
+  ///
+  /// @param[out] out  The destination buffer.
+  ///
+  /// @returns false if the model has unsupported constructs.
+  bool Write(Encoder* out);
+
+ private:
+  /// Records the name, label, and attributes of the element.
+  void WriteElement(const Element& element, Encoder* out);
+
+  /// Records the identification and role of the element.
+  template <class T>
+  void WriteId(const T& element, Encoder* out);
+
+  /// Records the content of a fault tree or component.
+  void WriteComponent(const Component& component, Encoder* out);
+
+  /// Records the Boolean formula with references to events.
+  void WriteFormula(const Formula& formula, Encoder* out);
+
+  /// Records the reference to the expression.
+  void WriteExpression(const Expression& expression, Encoder* out);
+
+  /// Records the reference to the instruction.
+  void WriteInstruction(const Instruction& instruction, Encoder* out);
+
+  /// Records the instructions and the target of the branch.
+  void WriteBranch(const Branch& branch, Encoder* out);
+
+  /// Adds the expression and its arguments to the expression records.
+  void RecordExpression(const Expression& expression);
+
+  /// Adds the instruction and its dependencies to the instruction records.
+  void RecordInstruction(const Instruction& instruction);
+
+  const Model& model_;  ///< The source model.
+  bool supported_ = true;  ///< Indication of only supported constructs.
+
+  /// The indices of the model constructs in their records.
+  /// @{
+  std::unordered_map<const void*, std::uint32_t> parameters_;
+  std::unordered_map<const void*, std::uint32_t> house_events_;
+  std::unordered_map<const void*, std::uint32_t> basic_events_;
+  std::unordered_map<const void*, std::uint32_t> gates_;
+  std::unordered_map<const void*, std::uint32_t> ccf_groups_;
+  std::unordered_map<const void*, std::uint32_t> rules_;
+  std::unordered_map<const void*, std::uint32_t> expressions_;
+  std::unordered_map<const void*, std::uint32_t> instructions_;
+  /// @}
+
+  Encoder expression_records_;  ///< The expressions in dependency order.
+  Encoder instruction_records_;  ///< The instructions in dependency order.
+};
+
+/// Decodes the snapshot records into a new model.
+class SnapshotReader {
+ public:
+  /// @param[in,out] in  The cursor at the start of model records.
+  explicit SnapshotReader(Decoder* in) : in_(*in) {}
+
+  /// Decodes the model.
+  ///
+  /// @returns The model in the state of the snapshot.
+  ///
+  /// @throws Error  The records are corrupted.
+  std::unique_ptr<Model> Read();
+
+ private:
+  /// Decodes the label and attributes of the element.
+  void ReadLabelAndAttributes(Element* element);
+
+  /// Decodes a new element with its name, label, and attributes.
+  template <class T>
+  std::unique_ptr<T> ReadElement();
+
+  /// Decodes a new element with its identification and role.
+  template <class T>
+  std::unique_ptr<T> ReadId();
+
+  /// Decodes the content of a fault tree or component.
+  void ReadComponent(Component* component);
+
+  /// @returns The decoded formula.
+  std::unique_ptr<Formula> ReadFormula();
+
+  /// @returns The decoded reference to an expression.
+  Expression* ReadExpression();
+
+  /// @returns The decoded reference to an instruction.
+  Instruction* ReadInstruction();
+
+  /// @returns The decoded references to instructions.
+  std::vector<Instruction*> ReadInstructions();
+
+  /// Decodes the instructions and the target of the branch.
+  void ReadBranch(EventTree* event_tree, Branch* branch);
+
+  /// Decodes a new expression record.
+  void ReadExpressionRecord();
+
+  /// Decodes a new instruction record.
+  void ReadInstructionRecord();
+
+  /// Adds the construct to the model and its record index.
+  template <class T>
+  T* Register(std::unique_ptr<T> element, std::vector<T*>* records) {
+    T* ptr = element.get();
+    model_->Add(std::move(element));
+    records->push_back(ptr);
+    return ptr;
+  }
+
+  Decoder& in_;  ///< The source of records.
+  std::unique_ptr<Model> model_;  ///< The destination model.
+
+  /// The model constructs in the order of their records.
+  /// @{
+  std::vector<Parameter*> parameters_;
+  std::vector<HouseEvent*> house_events_;
+  std::vector<BasicEvent*> basic_events_;
+  std::vector<Gate*> gates_;
+  std::vector<CcfGroup*> ccf_groups_;
+  std::vector<Rule*> rules_;
+  std::vector<Expression*> expressions_;
+  std::vector<Instruction*> instructions_;
+  /// @}
+};
+
+/// Assigns sequential indices to the elements of the table.
+template <class Table>
+void Index(const Table& table,
+           std::unordered_map<const void*, std::uint32_t>* indices) {
+  indices->reserve(table.size());
+  for (const auto& element : table)
+    indices->emplace(&element, indices->size());
+}
+
+/// @returns The index of the construct.
+std::uint32_t IndexOf(const void* construct,
+                      const std::unordered_map<const void*, std::uint32_t>&
+                          indices) {
+  auto it = indices.find(construct);
+  assert(it != indices.end() && "Unrecorded construct.");
+  return it->second;
+}
+
+bool SnapshotWriter::Write(Encoder* out) {
+  if (!model_.libraries().empty() || !model_.extern_functions().empty())
+    return false;  // Dynamic libraries are loaded anew only.
+
+  Index(model_.parameters(), &parameters_);
+  Index(model_.house_events(), &house_events_);
+  Index(model_.basic_events(), &basic_events_);
+  Index(model_.gates(), &gates_);
+  Index(model_.ccf_groups(), &ccf_groups_);
+  Index(model_.rules(), &rules_);
+
+  out->Put(model_.GetOptionalName());
+  WriteElement(model_, out);
+
+  out->Put<std::uint32_t>(model_.parameters().size());
+  for (const Parameter& parameter : model_.parameters()) {
+    WriteId(parameter, out);
+    out->Put<std::uint8_t>(parameter.unit());
+    out->Put(parameter.usage());
+  }
+  out->Put<std::uint32_t>(model_.house_events().size());
+  for (const HouseEvent& house_event : model_.house_events()) {
+    WriteId(house_event, out);
+    out->Put(house_event.state());
+    out->Put(house_event.usage());
+  }
+  out->Put<std::uint32_t>(model_.basic_events().size());
+  for (const BasicEvent& basic_event : model_.basic_events()) {
+    WriteId(basic_event, out);
+    out->Put(basic_event.usage());
+  }
+  out->Put<std::uint32_t>(model_.gates().size());
+  for (const Gate& gate : model_.gates()) {
+    WriteId(gate, out);
+    out->Put(gate.usage());
+  }
+  out->Put<std::uint32_t>(model_.ccf_groups().size());
+  for (const CcfGroup& ccf_group : model_.ccf_groups()) {
+    const std::type_info& type = typeid(ccf_group);
+    out->Put<std::uint8_t>(type == typeid(BetaFactorModel)  ? kBetaFactor
+                           : type == typeid(MglModel)       ? kMgl
+                           : type == typeid(AlphaFactorModel) ? kAlphaFactor
+                                                              : kPhiFactor);
+    WriteId(ccf_group, out);
+    out->Put<std::uint32_t>(ccf_group.members().size());
+    for (const BasicEvent* member : ccf_group.members())
+      out->Put(IndexOf(member, basic_events_));
+  }
+  out->Put<std::uint32_t>(model_.fault_trees().size());
+  for (const FaultTree& fault_tree : model_.fault_trees()) {
+    WriteElement(fault_tree, out);
+    WriteComponent(fault_tree, out);
+  }
+  out->Put<std::uint32_t>(model_.sequences().size());
+  for (const Sequence& sequence : model_.sequences()) {
+    WriteElement(sequence, out);
+    out->Put(sequence.usage());
+  }
+  out->Put<std::uint32_t>(model_.rules().size());
+  for (const Rule& rule : model_.rules()) {
+    WriteElement(rule, out);
+    out->Put(rule.usage());
+  }
+  out->Put<std::uint32_t>(model_.event_trees().size());
+  for (const EventTree& event_tree : model_.event_trees()) {
+    WriteElement(event_tree, out);
+    out->Put(event_tree.usage());
+    out->Put<std::uint32_t>(event_tree.functional_events().size());
+    for (const FunctionalEvent& functional_event :
+         event_tree.functional_events()) {
+      WriteElement(functional_event, out);
+      out->Put(functional_event.usage());
+      out->Put<std::int32_t>(functional_event.order());
+    }
+    out->Put<std::uint32_t>(event_tree.branches().size());
+    for (const NamedBranch& branch : event_tree.branches()) {
+      WriteElement(branch, out);
+      out->Put(branch.usage());
+    }
+    out->Put<std::uint32_t>(event_tree.sequances().size());
+    for (const Sequence& sequence : event_tree.sequances())
+      out->Put(sequence.name());
+  }
+  out->Put<std::uint32_t>(model_.initiating_events().size());
+  for (const InitiatingEvent& initiating_event : model_.initiating_events()) {
+    WriteElement(initiating_event, out);
+    out->Put(initiating_event.usage());
+    out->Put(initiating_event.event_tree()
+                 ? std::string_view(initiating_event.event_tree()->name())
+                 : std::string_view());
+  }
+  out->Put<std::uint32_t>(model_.alignments().size());
+  for (const Alignment& alignment : model_.alignments()) {
+    WriteElement(alignment, out);
+    out->Put<std::uint32_t>(alignment.phases().size());
+    for (const Phase& phase : alignment.phases()) {
+      out->Put(phase.time_fraction());
+      WriteElement(phase, out);
+    }
+  }
+  out->Put<std::uint32_t>(model_.substitutions().size());
+  for (const Substitution& substitution : model_.substitutions())
+    WriteElement(substitution, out);
+
+  // The definitions collect expressions and instructions for records.
+  Encoder definitions;
+  for (const Parameter& parameter : model_.parameters())
+    WriteExpression(*parameter.args().front(), &definitions);
+  for (const BasicEvent& basic_event : model_.basic_events()) {
+    definitions.Put(basic_event.HasExpression());
+    if (basic_event.HasExpression())
+      WriteExpression(basic_event.expression(), &definitions);
+  }
+  for (const CcfGroup& ccf_group : model_.ccf_groups()) {
+    definitions.Put(ccf_group.distribution() != nullptr);
+    if (ccf_group.distribution())
+      WriteExpression(*ccf_group.distribution(), &definitions);
+    definitions.Put<std::uint32_t>(ccf_group.factors().size());
+    for (const auto& [level, factor] : ccf_group.factors()) {
+      definitions.Put<std::int32_t>(level);
+      WriteExpression(*factor, &definitions);
+    }
+  }
+  for (const Gate& gate : model_.gates())
+    WriteFormula(gate.formula(), &definitions);
+  for (const Substitution& substitution : model_.substitutions()) {
+    WriteFormula(substitution.hypothesis(), &definitions);
+    definitions.Put<std::uint32_t>(substitution.source().size());
+    for (const BasicEvent* source : substitution.source())
+      definitions.Put(IndexOf(source, basic_events_));
+    if (const auto* target =
+            std::get_if<BasicEvent*>(&substitution.target())) {
+      definitions.Put(true);
+      definitions.Put(IndexOf(*target, basic_events_));
+    } else {
+      definitions.Put(false);
+      definitions.Put(std::get<bool>(substitution.target()));
+    }
+  }
+  for (const Sequence& sequence : model_.sequences()) {
+    definitions.Put<std::uint32_t>(sequence.instructions().size());
+    for (const Instruction* instruction : sequence.instructions())
+      WriteInstruction(*instruction, &definitions);
+  }
+  for (const Rule& rule : model_.rules()) {
+    definitions.Put<std::uint32_t>(rule.instructions().size());
+    for (const Instruction* instruction : rule.instructions())
+      WriteInstruction(*instruction, &definitions);
+  }
+  for (const EventTree& event_tree : model_.event_trees()) {
+    for (const NamedBranch& branch : event_tree.branches())
+      WriteBranch(branch, &definitions);
+    WriteBranch(event_tree.initial_state(), &definitions);
+  }
+  for (const Alignment& alignment : model_.alignments()) {
+    for (const Phase& phase : alignment.phases()) {
+      definitions.Put<std::uint32_t>(phase.instructions().size());
+      for (const SetHouseEvent* instruction : phase.instructions())
+        WriteInstruction(*instruction, &definitions);
+    }
+  }
+
+  out->Put<std::uint32_t>(expressions_.size());
+  out->Put(expression_records_);
+  out->Put<std::uint32_t>(instructions_.size());
+  out->Put(instruction_records_);
+  out->Put(definitions);
+  return supported_;
+}
+
+void SnapshotWriter::WriteElement(const Element& element, Encoder* out) {
+  if (&element != &model_)
+    out->Put(element.name());
+  out->Put(element.label());
+  out->Put<std::uint32_t>(element.attributes().size());
+  for (const Attribute& attribute : element.attributes()) {
+    out->Put(attribute.name());
+    out->Put(attribute.value());
+    out->Put(attribute.type());
+  }
+}
+
+template <class T>
+void SnapshotWriter::WriteId(const T& element, Encoder* out) {
+  out->Put(element.base_path());
+  out->Put<std::uint8_t>(static_cast<std::uint8_t>(element.role()));
+  WriteElement(element, out);
+}
+
+void SnapshotWriter::WriteComponent(const Component& component,
+                                    Encoder* out) {
+  // CCF groups bring their members into the component.
+  std::unordered_set<const BasicEvent*> members;
+  out->Put<std::uint32_t>(component.ccf_groups().size());
+  for (const CcfGroup& ccf_group : component.ccf_groups()) {
+    out->Put(IndexOf(&ccf_group, ccf_groups_));
+    members.insert(ccf_group.members().begin(), ccf_group.members().end());
+  }
+  out->Put<std::uint32_t>(component.basic_events().size() - members.size());
+  for (const BasicEvent& basic_event : component.basic_events()) {
+    if (!members.count(&basic_event))
+      out->Put(IndexOf(&basic_event, basic_events_));
+  }
+  out->Put<std::uint32_t>(component.house_events().size());
+  for (const HouseEvent& house_event : component.house_events())
+    out->Put(IndexOf(&house_event, house_events_));
+  out->Put<std::uint32_t>(component.gates().size());
+  for (const Gate& gate : component.gates())
+    out->Put(IndexOf(&gate, gates_));
+  out->Put<std::uint32_t>(component.parameters().size());
+  for (const Parameter& parameter : component.parameters())
+    out->Put(IndexOf(&parameter, parameters_));
+  out->Put<std::uint32_t>(component.components().size());
+  for (const Component& sub : component.components()) {
+    WriteId(sub, out);
+    WriteComponent(sub, out);
+  }
+}
+
+void SnapshotWriter::WriteFormula(const Formula& formula, Encoder* out) {
+  out->Put<std::uint8_t>(formula.connective());
+  out->Put<std::int32_t>(formula.min_number().value_or(-1));
+  out->Put<std::int32_t>(formula.max_number().value_or(-1));
+  out->Put<std::uint32_t>(formula.args().size());
+  for (const Formula::Arg& arg : formula.args()) {
+    out->Put(arg.complement);
+    std::visit(
+        [this, out](auto* event) {
+          using T = std::decay_t<decltype(*event)>;
+          if constexpr (std::is_same_v<T, Gate>) {
+            out->Put<std::uint8_t>(kGateRef);
+            out->Put(IndexOf(event, gates_));
+          } else if constexpr (std::is_same_v<T, BasicEvent>) {
+            out->Put<std::uint8_t>(kBasicEventRef);
+            out->Put(IndexOf(event, basic_events_));
+          } else if (event == &HouseEvent::kTrue) {
+            out->Put<std::uint8_t>(kTrueRef);
+          } else if (event == &HouseEvent::kFalse) {
+            out->Put<std::uint8_t>(kFalseRef);
+          } else {
+            out->Put<std::uint8_t>(kHouseEventRef);
+            out->Put(IndexOf(event, house_events_));
+          }
+        },
+        arg.event);
+  }
+}
+
+void SnapshotWriter::WriteExpression(const Expression& expression,
+                                     Encoder* out) {
+  if (&expression == &ConstantExpression::kOne) {
+    out->Put<std::uint8_t>(kOneRef);
+  } else if (&expression == &ConstantExpression::kZero) {
+    out->Put<std::uint8_t>(kZeroRef);
+  } else if (&expression == &ConstantExpression::kPi) {
+    out->Put<std::uint8_t>(kPiRef);
+  } else if (&expression == &model_.mission_time()) {
+    out->Put<std::uint8_t>(kMissionTimeRef);
+  } else if (const auto* parameter =
+                 dynamic_cast<const Parameter*>(&expression)) {
+    out->Put<std::uint8_t>(kParameterRef);
+    out->Put(IndexOf(parameter, parameters_));
+  } else {
+    RecordExpression(expression);
+    out->Put<std::uint8_t>(kExpressionRef);
+    out->Put(expressions_.count(&expression)  // Unless unsupported.
+                 ? expressions_.at(&expression)
+                 : std::uint32_t(0));
+  }
+}
+
+void SnapshotWriter::RecordExpression(const Expression& expression) {
+  if (expressions_.count(&expression))
+    return;
+  Encoder& out = expression_records_;
+  if (const auto* constant =
+          dynamic_cast<const ConstantExpression*>(&expression)) {
+    out.Put<std::uint8_t>(kConstant);
+    out.Put(const_cast<ConstantExpression*>(constant)->value());
+  } else if (const auto* test_event =
+                 dynamic_cast<const TestInitiatingEvent*>(&expression)) {
+    out.Put<std::uint8_t>(kTestInitiatingEvent);
+    out.Put(test_event->name());
+  } else if (const auto* test_state =
+                 dynamic_cast<const TestFunctionalEvent*>(&expression)) {
+    out.Put<std::uint8_t>(kTestFunctionalEvent);
+    out.Put(test_state->name());
+    out.Put(test_state->state());
+  } else {
+    auto it = std::find_if(
+        std::begin(kExpressionTypes), std::end(kExpressionTypes),
+        [&expression](const auto& type) {
+          return type.first == typeid(expression);
+        });
+    if (it == std::end(kExpressionTypes)) {
+      supported_ = false;  // E.g., external functions.
+      return;
+    }
+    Encoder args;  // The arguments are recorded before the expression.
+    for (const Expression* arg : expression.args())
+      WriteExpression(*arg, &args);
+    out.Put<std::uint8_t>(kBuiltin);
+    out.Put<std::uint8_t>(std::distance(std::begin(kExpressionTypes), it));
+    out.Put<std::uint32_t>(expression.args().size());
+    out.Put(args);
+  }
+  expressions_.emplace(&expression, expressions_.size());
+}
+
+void SnapshotWriter::WriteInstruction(const Instruction& instruction,
+                                      Encoder* out) {
+  if (const auto* rule = dynamic_cast<const Rule*>(&instruction)) {
+    out->Put<std::uint8_t>(kRuleRef);
+    out->Put(IndexOf(rule, rules_));
+  } else {
+    RecordInstruction(instruction);
+    out->Put<std::uint8_t>(kInstructionRef);
+    out->Put(IndexOf(&instruction, instructions_));
+  }
+}
+
+void SnapshotWriter::RecordInstruction(const Instruction& instruction) {
+  if (instructions_.count(&instruction))
+    return;
+
+  /// Records the instruction after its dependencies.
+  class Collector : public InstructionVisitor {
+   public:
+    explicit Collector(SnapshotWriter* self) : self_(*self) {}
+
+    void Visit(const SetHouseEvent* instruction) override {
+      out_.Put<std::uint8_t>(kSetHouseEvent);
+      out_.Put(instruction->name());
+      out_.Put(instruction->state());
+    }
+    void Visit(const CollectExpression* instruction) override {
+      out_.Put<std::uint8_t>(kCollectExpression);
+      self_.WriteExpression(instruction->expression(), &out_);
+    }
+    void Visit(const CollectFormula* instruction) override {
+      out_.Put<std::uint8_t>(kCollectFormula);
+      self_.WriteFormula(instruction->formula(), &out_);
+    }
+    void Visit(const Link* instruction) override {
+      out_.Put<std::uint8_t>(kLink);
+      out_.Put(instruction->event_tree().name());
+    }
+    void Visit(const IfThenElse* instruction) override {
+      out_.Put<std::uint8_t>(kIfThenElse);
+      self_.WriteExpression(*instruction->expression(), &out_);
+      self_.WriteInstruction(*instruction->then_instruction(), &out_);
+      out_.Put(instruction->else_instruction() != nullptr);
+      if (instruction->else_instruction())
+        self_.WriteInstruction(*instruction->else_instruction(), &out_);
+    }
+    void Visit(const Block* instruction) override {
+      out_.Put<std::uint8_t>(kBlock);
+      out_.Put<std::uint32_t>(instruction->instructions().size());
+      for (const Instruction* arg : instruction->instructions())
+        self_.WriteInstruction(*arg, &out_);
+    }
+    void Visit(const Rule*) override { assert(false && "Rules are indexed."); }
+
+    /// @returns The record of the instruction.
+    const Encoder& record() const { return out_; }
+
+   private:
+    SnapshotWriter& self_;  ///< The host writer.
+    Encoder out_;  ///< The record with references to the dependencies.
+  } collector(this);
+
+  instruction.Accept(&collector);
+  instruction_records_.Put(collector.record());
+  instructions_.emplace(&instruction, instructions_.size());
+}
+
+void SnapshotWriter::WriteBranch(const Branch& branch, Encoder* out) {
+  out->Put<std::uint32_t>(branch.instructions().size());
+  for (const Instruction* instruction : branch.instructions())
+    WriteInstruction(*instruction, out);
+  std::visit(
+      [this, out](auto* target) {
+        using T = std::decay_t<decltype(*target)>;
+        if constexpr (std::is_same_v<T, Sequence>) {
+          out->Put<std::uint8_t>(kSequenceTarget);
+          out->Put(target->name());
+        } else if constexpr (std::is_same_v<T, NamedBranch>) {
+          out->Put<std::uint8_t>(kBranchTarget);
+          out->Put(target->name());
+        } else {
+          out->Put<std::uint8_t>(kForkTarget);
+          out->Put(target->functional_event().name());
+          out->Put<std::uint32_t>(target->paths().size());
+          for (const Path& path : target->paths()) {
+            out->Put(path.state());
+            WriteBranch(path, out);
+          }
+        }
+      },
+      branch.target());
+}
+
+std::unique_ptr<Model> SnapshotReader::Read() {
+  model_ = std::make_unique<Model>(in_.GetString());
+  ReadLabelAndAttributes(model_.get());
+
+  for (auto i = in_.Get<std::uint32_t>(); i; --i) {
+    Parameter* parameter = Register(ReadId<Parameter>(), &parameters_);
+    auto unit = in_.Get<std::uint8_t>();
+    if (unit >= kNumUnits)
+      SCRAM_THROW(CorruptSnapshot());
+    parameter->unit(static_cast<Units>(unit));
+    parameter->usage(in_.Get<bool>());
+  }
+  for (auto i = in_.Get<std::uint32_t>(); i; --i) {
+    HouseEvent* house_event = Register(ReadId<HouseEvent>(), &house_events_);
+    house_event->state(in_.Get<bool>());
+    house_event->usage(in_.Get<bool>());
+  }
+  for (auto i = in_.Get<std::uint32_t>(); i; --i)
+    Register(ReadId<BasicEvent>(), &basic_events_)->usage(in_.Get<bool>());
+  for (auto i = in_.Get<std::uint32_t>(); i; --i)
+    Register(ReadId<Gate>(), &gates_)->usage(in_.Get<bool>());
+  for (auto i = in_.Get<std::uint32_t>(); i; --i) {
+    std::unique_ptr<CcfGroup> ccf_group =
+        [this]() -> std::unique_ptr<CcfGroup> {
+      switch (in_.Get<std::uint8_t>()) {
+        case kBetaFactor:
+          return ReadId<BetaFactorModel>();
+        case kMgl:
+          return ReadId<MglModel>();
+        case kAlphaFactor:
+          return ReadId<AlphaFactorModel>();
+        case kPhiFactor:
+          return ReadId<PhiFactorModel>();
+      }
+      SCRAM_THROW(CorruptSnapshot());
+    }();
+    for (auto j = in_.Get<std::uint32_t>(); j; --j)
+      ccf_group->AddMember(in_.GetIndex(basic_events_));
+    Register(std::move(ccf_group), &ccf_groups_);
+  }
+  for (auto i = in_.Get<std::uint32_t>(); i; --i) {
+    auto fault_tree = std::make_unique<FaultTree>(in_.GetString());
+    ReadLabelAndAttributes(fault_tree.get());
+    ReadComponent(fault_tree.get());
+    model_->Add(std::move(fault_tree));
+  }
+  for (auto i = in_.Get<std::uint32_t>(); i; --i) {
+    auto sequence = ReadElement<Sequence>();
+    sequence->usage(in_.Get<bool>());
+    model_->Add(std::move(sequence));
+  }
+  for (auto i = in_.Get<std::uint32_t>(); i; --i)
+    Register(ReadElement<Rule>(), &rules_)->usage(in_.Get<bool>());
+  for (auto i = in_.Get<std::uint32_t>(); i; --i) {
+    auto event_tree = ReadElement<EventTree>();
+    event_tree->usage(in_.Get<bool>());
+    for (auto j = in_.Get<std::uint32_t>(); j; --j) {
+      auto functional_event = ReadElement<FunctionalEvent>();
+      functional_event->usage(in_.Get<bool>());
+      functional_event->order(in_.Get<std::int32_t>());
+      event_tree->Add(std::move(functional_event));
+    }
+    for (auto j = in_.Get<std::uint32_t>(); j; --j) {
+      auto branch = ReadElement<NamedBranch>();
+      branch->usage(in_.Get<bool>());
+      event_tree->Add(std::move(branch));
+    }
+    for (auto j = in_.Get<std::uint32_t>(); j; --j)
+      event_tree->Add(&model_->Get<Sequence>(in_.GetString()));
+    model_->Add(std::move(event_tree));
+  }
+  for (auto i = in_.Get<std::uint32_t>(); i; --i) {
+    auto initiating_event = ReadElement<InitiatingEvent>();
+    initiating_event->usage(in_.Get<bool>());
+    if (std::string event_tree = in_.GetString(); !event_tree.empty())
+      initiating_event->event_tree(&model_->Get<EventTree>(event_tree));
+    model_->Add(std::move(initiating_event));
+  }
+  for (auto i = in_.Get<std::uint32_t>(); i; --i) {
+    auto alignment = ReadElement<Alignment>();
+    for (auto j = in_.Get<std::uint32_t>(); j; --j) {
+      auto time_fraction = in_.Get<double>();
+      auto phase = std::make_unique<Phase>(in_.GetString(), time_fraction);
+      ReadLabelAndAttributes(phase.get());
+      alignment->Add(std::move(phase));
+    }
+    model_->Add(std::move(alignment));
+  }
+  for (auto i = in_.Get<std::uint32_t>(); i; --i)
+    model_->Add(ReadElement<Substitution>());
+
+  for (auto i = in_.Get<std::uint32_t>(); i; --i)
+    ReadExpressionRecord();
+  for (auto i = in_.Get<std::uint32_t>(); i; --i)
+    ReadInstructionRecord();
+
+  for (Parameter* parameter : parameters_)
+    parameter->expression(ReadExpression());
+  for (BasicEvent* basic_event : basic_events_) {
+    if (in_.Get<bool>())
+      basic_event->expression(ReadExpression());
+  }
+  for (CcfGroup* ccf_group : ccf_groups_) {
+    if (in_.Get<bool>())
+      ccf_group->AddDistribution(ReadExpression());
+    for (auto j = in_.Get<std::uint32_t>(); j; --j) {
+      int level = in_.Get<std::int32_t>();
+      ccf_group->AddFactor(ReadExpression(), level);
+    }
+  }
+  for (Gate* gate : gates_)
+    gate->formula(ReadFormula());
+  for (Substitution& substitution : model_->table<Substitution>()) {
+    substitution.hypothesis(ReadFormula());
+    for (auto j = in_.Get<std::uint32_t>(); j; --j)
+      substitution.Add(in_.GetIndex(basic_events_));
+    if (in_.Get<bool>()) {
+      substitution.target(in_.GetIndex(basic_events_));
+    } else {
+      substitution.target(in_.Get<bool>());
+    }
+  }
+  for (Sequence& sequence : model_->table<Sequence>())
+    sequence.instructions(ReadInstructions());
+  for (Rule* rule : rules_)
+    rule->instructions(ReadInstructions());
+  for (EventTree& event_tree : model_->table<EventTree>()) {
+    for (NamedBranch& branch : event_tree.table<NamedBranch>())
+      ReadBranch(&event_tree, &branch);
+    Branch initial_state;
+    ReadBranch(&event_tree, &initial_state);
+    event_tree.initial_state(std::move(initial_state));
+  }
+  for (Alignment& alignment : model_->table<Alignment>()) {
+    for (Phase& phase : alignment.table()) {
+      std::vector<SetHouseEvent*> instructions;
+      for (Instruction* instruction : ReadInstructions()) {
+        auto* set_house_event = dynamic_cast<SetHouseEvent*>(instruction);
+        if (!set_house_event)
+          SCRAM_THROW(CorruptSnapshot());
+        instructions.push_back(set_house_event);
+      }
+      phase.instructions(std::move(instructions));
+    }
+  }
+  return std::move(model_);
+}
+
+void SnapshotReader::ReadLabelAndAttributes(Element* element) {
+  element->label(in_.GetString());
+  for (auto i = in_.Get<std::uint32_t>(); i; --i) {
+    std::string name = in_.GetString();
+    std::string value = in_.GetString();
+    element->AddAttribute({std::move(name), std::move(value), in_.GetString()});
+  }
+}
+
+template <class T>
+std::unique_ptr<T> SnapshotReader::ReadElement() {
+  auto element = std::make_unique<T>(in_.GetString());
+  ReadLabelAndAttributes(element.get());
+  return element;
+}
+
+template <class T>
+std::unique_ptr<T> SnapshotReader::ReadId() {
+  std::string base_path = in_.GetString();
+  auto role = in_.Get<std::uint8_t>();
+  if (role > static_cast<std::uint8_t>(RoleSpecifier::kPrivate))
+    SCRAM_THROW(CorruptSnapshot());
+  std::string name = in_.GetString();
+  auto element = std::make_unique<T>(std::move(name), std::move(base_path),
+                                     static_cast<RoleSpecifier>(role));
+  ReadLabelAndAttributes(element.get());
+  return element;
+}
+
+void SnapshotReader::ReadComponent(Component* component) {
+  for (auto i = in_.Get<std::uint32_t>(); i; --i)
+    component->Add(in_.GetIndex(ccf_groups_));
+  for (auto i = in_.Get<std::uint32_t>(); i; --i)
+    component->Add(in_.GetIndex(basic_events_));
+  for (auto i = in_.Get<std::uint32_t>(); i; --i)
+    component->Add(in_.GetIndex(house_events_));
+  for (auto i = in_.Get<std::uint32_t>(); i; --i)
+    component->Add(in_.GetIndex(gates_));
+  for (auto i = in_.Get<std::uint32_t>(); i; --i)
+    component->Add(in_.GetIndex(parameters_));
+  for (auto i = in_.Get<std::uint32_t>(); i; --i) {
+    auto sub = ReadId<Component>();
+    ReadComponent(sub.get());
+    component->Add(std::move(sub));
+  }
+}
+
+std::unique_ptr<Formula> SnapshotReader::ReadFormula() {
+  auto connective = in_.Get<std::uint8_t>();
+  if (connective >= kNumConnectives)
+    SCRAM_THROW(CorruptSnapshot());
+  auto get_number = [this]() -> std::optional<int> {
+    int number = in_.Get<std::int32_t>();
+    if (number < 0)
+      return {};
+    return number;
+  };
+  std::optional<int> min_number = get_number();
+  std::optional<int> max_number = get_number();
+  Formula::ArgSet args;
+  for (auto i = in_.Get<std::uint32_t>(); i; --i) {
+    bool complement = in_.Get<bool>();
+    switch (in_.Get<std::uint8_t>()) {
+      case kGateRef:
+        args.Add(in_.GetIndex(gates_), complement);
+        break;
+      case kBasicEventRef:
+        args.Add(in_.GetIndex(basic_events_), complement);
+        break;
+      case kHouseEventRef:
+        args.Add(in_.GetIndex(house_events_), complement);
+        break;
+      case kTrueRef:
+        args.Add(&HouseEvent::kTrue, complement);
+        break;
+      case kFalseRef:
+        args.Add(&HouseEvent::kFalse, complement);
+        break;
+      default:
+        SCRAM_THROW(CorruptSnapshot());
+    }
+  }
+  return std::make_unique<Formula>(static_cast<Connective>(connective),
+                                   std::move(args), min_number, max_number);
+}
+
+Expression* SnapshotReader::ReadExpression() {
+  switch (in_.Get<std::uint8_t>()) {
+    case kExpressionRef:
+      return in_.GetIndex(expressions_);
+    case kParameterRef:
+      return in_.GetIndex(parameters_);
+    case kMissionTimeRef:
+      return &model_->mission_time();
+    case kOneRef:
+      return &ConstantExpression::kOne;
+    case kZeroRef:
+      return &ConstantExpression::kZero;
+    case kPiRef:
+      return &ConstantExpression::kPi;
+  }
+  SCRAM_THROW(CorruptSnapshot());
+}
+
+void SnapshotReader::ReadExpressionRecord() {
+  std::unique_ptr<Expression> expression = [this]()
+      -> std::unique_ptr<Expression> {
+    switch (in_.Get<std::uint8_t>()) {
+      case kConstant:
+        return std::make_unique<ConstantExpression>(in_.Get<double>());
+      case kTestInitiatingEvent:
+        return std::make_unique<TestInitiatingEvent>(in_.GetString(),
+                                                     model_->context());
+      case kTestFunctionalEvent: {
+        std::string name = in_.GetString();
+        return std::make_unique<TestFunctionalEvent>(
+            std::move(name), in_.GetString(), model_->context());
+      }
+      case kBuiltin: {
+        auto type = in_.Get<std::uint8_t>();
+        if (type >= std::size(kExpressionTypes))
+          SCRAM_THROW(CorruptSnapshot());
+        std::vector<Expression*> args;
+        for (auto i = in_.Get<std::uint32_t>(); i; --i)
+          args.push_back(ReadExpression());
+        return kExpressionTypes[type].second(args);
+      }
+    }
+    SCRAM_THROW(CorruptSnapshot());
+  }();
+  expressions_.push_back(expression.get());
+  model_->Add(std::move(expression));
+}
+
+Instruction* SnapshotReader::ReadInstruction() {
+  switch (in_.Get<std::uint8_t>()) {
+    case kInstructionRef:
+      return in_.GetIndex(instructions_);
+    case kRuleRef:
+      return in_.GetIndex(rules_);
+  }
+  SCRAM_THROW(CorruptSnapshot());
+}
+
+std::vector<Instruction*> SnapshotReader::ReadInstructions() {
+  std::vector<Instruction*> instructions;
+  for (auto i = in_.Get<std::uint32_t>(); i; --i)
+    instructions.push_back(ReadInstruction());
+  return instructions;
+}
+
+void SnapshotReader::ReadInstructionRecord() {
+  std::unique_ptr<Instruction> instruction = [this]()
+      -> std::unique_ptr<Instruction> {
+    switch (in_.Get<std::uint8_t>()) {
+      case kSetHouseEvent: {
+        std::string name = in_.GetString();
+        return std::make_unique<SetHouseEvent>(std::move(name),
+                                               in_.Get<bool>());
+      }
+      case kCollectExpression:
+        return std::make_unique<CollectExpression>(ReadExpression());
+      case kCollectFormula:
+        return std::make_unique<CollectFormula>(ReadFormula());
+      case kIfThenElse: {
+        Expression* expression = ReadExpression();
+        Instruction* then_instruction = ReadInstruction();
+        Instruction* else_instruction =
+            in_.Get<bool>() ? ReadInstruction() : nullptr;
+        return std::make_unique<IfThenElse>(expression, then_instruction,
+                                            else_instruction);
+      }
+      case kBlock:
+        return std::make_unique<Block>(ReadInstructions());
+      case kLink:
+        return std::make_unique<Link>(
+            model_->Get<EventTree>(in_.GetString()));
+    }
+    SCRAM_THROW(CorruptSnapshot());
+  }();
+  instructions_.push_back(instruction.get());
+  model_->Add(std::move(instruction));
+}
+
+void SnapshotReader::ReadBranch(EventTree* event_tree, Branch* branch) {
+  branch->instructions(ReadInstructions());
+  switch (in_.Get<std::uint8_t>()) {
+    case kSequenceTarget:
+      branch->target(&model_->Get<Sequence>(in_.GetString()));
+      break;
+    case kBranchTarget:
+      branch->target(&event_tree->Get<NamedBranch>(in_.GetString()));
+      break;
+    case kForkTarget: {
+      auto& functional_event =
+          event_tree->Get<FunctionalEvent>(in_.GetString());
+      std::vector<Path> paths;
+      for (auto i = in_.Get<std::uint32_t>(); i; --i) {
+        paths.emplace_back(in_.GetString());
+        ReadBranch(event_tree, &paths.back());
+      }
+      auto fork = std::make_unique<Fork>(functional_event, std::move(paths));
+      branch->target(fork.get());
+      event_tree->Add(std::move(fork));
+      break;
+    }
+    default:
+      SCRAM_THROW(CorruptSnapshot());
+  }
+}
+
+/// 64-bit FNV-1a hash.
+class Hash {
+ public:
+  /// Mixes the bytes into the hash value.
+  void Update(const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+      value_ ^= bytes[i];
+      value_ *= 1099511628211ULL;
+    }
+  }
+
+  /// Mixes the string with its size into the hash value.
+  void Update(std::string_view value) {
+    std::uint64_t size = value.size();
+    Update(&size, sizeof(size));
+    Update(value.data(), value.size());
+  }
+
+  /// @returns The hash value.
+  std::uint64_t value() const { return value_; }
+
+ private:
+  std::uint64_t value_ = 14695981039346656037ULL;  ///< The offset basis.
+};
+
+/// @returns The hash of the file contents.
+///
+/// @throws IOError  The file is not accessible.
+std::uint64_t HashFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+    SCRAM_THROW(IOError("Failed to open the file for hashing"))
+        << boost::errinfo_file_name(path);
+  Hash hash;
+  char buffer[1 << 16];
+  while (in.read(buffer, sizeof(buffer)) || in.gcount())
+    hash.Update(buffer, in.gcount());
+  return hash.value();
+}
+
+/// @returns false if the file surely has no XInclude directives.
+bool MayInclude(const std::string& path) {
+  namespace bip = boost::interprocess;
+  if (fs::is_empty(path))
+    return false;
+  bip::file_mapping mapping(path.c_str(), bip::read_only);
+  bip::mapped_region region(mapping, bip::read_only);
+  std::string_view content(static_cast<const char*>(region.get_address()),
+                           region.get_size());
+  return content.find("http://www.w3.org/2001/XInclude") !=
+         std::string_view::npos;
+}
+
+}  // namespace
+
+ModelCache::ModelCache(const std::string& directory,
+                       const std::vector<std::string>& xml_files)
+    : xml_files_(xml_files) {
+  Hash hash;
+  hash.Update(kMagic, sizeof(kMagic));
+  hash.Update(&kFormatVersion, sizeof(kFormatVersion));
+  hash.Update(version::describe());
+  hash.Update(version::build());
+  for (const std::string& xml_file : xml_files) {
+    hash.Update(fs::canonical(xml_file).string());
+    std::uint64_t content = HashFile(xml_file);
+    hash.Update(&content, sizeof(content));
+  }
+  key_ = hash.value();
+
+  std::stringstream name;
+  name << std::hex << std::setw(16) << std::setfill('0') << key_ << ".model";
+  file_ = (fs::path(directory) / name.str()).string();
+}
+
+std::unique_ptr<Model> ModelCache::Load() const {
+  namespace bip = boost::interprocess;
+  if (!fs::exists(file_)) {
+    LOG(DEBUG1) << "No model snapshot " << file_;
+    return nullptr;
+  }
+  try {
+    CLOCK(load_time);
+    LOG(DEBUG1) << "Loading the model snapshot " << file_;
+    bip::file_mapping mapping(file_.c_str(), bip::read_only);
+    bip::mapped_region region(mapping, bip::read_only);
+    Decoder in(static_cast<const char*>(region.get_address()),
+               region.get_size());
+    char magic[sizeof(kMagic)];
+    for (char& byte : magic)
+      byte = in.Get<char>();
+    if (!std::equal(std::begin(magic), std::end(magic), kMagic) ||
+        in.Get<std::uint32_t>() != kFormatVersion ||
+        in.Get<std::uint64_t>() != key_) {
+      SCRAM_THROW(IOError("The model snapshot is incompatible."));
+    }
+    for (auto i = in.Get<std::uint32_t>(); i; --i) {
+      std::string include = in.GetString();
+      if (!fs::exists(include) ||
+          HashFile(include) != in.Get<std::uint64_t>()) {
+        LOG(DEBUG1) << "The model snapshot is out of date with " << include;
+        return nullptr;
+      }
+    }
+    std::unique_ptr<Model> model = SnapshotReader(&in).Read();
+    if (!in.empty())
+      SCRAM_THROW(CorruptSnapshot());
+    LOG(DEBUG1) << "The model snapshot is loaded in " << DUR(load_time);
+    return model;
+  } catch (const std::exception& err) {
+    LOG(WARNING) << "Ignoring the model snapshot " << file_ << ": "
+                 << err.what();
+    return nullptr;
+  }
+}
+
+bool ModelCache::Save(const Model& model) const {
+  CLOCK(save_time);
+  Encoder body;
+  if (!SnapshotWriter(model).Write(&body)) {
+    LOG(DEBUG1) << "The model has constructs unsupported by snapshots";
+    return false;
+  }
+  try {
+    Encoder header;
+    for (char byte : kMagic)
+      header.Put(byte);
+    header.Put(kFormatVersion);
+    header.Put(key_);
+    std::vector<std::string> includes;
+    for (const std::string& xml_file : xml_files_) {
+      if (!MayInclude(xml_file))
+        continue;  // Avoids the second parsing of large input files.
+      for (std::string& include : xml::FindIncludes(xml_file))
+        includes.push_back(std::move(include));
+    }
+    header.Put<std::uint32_t>(includes.size());
+    for (const std::string& include : includes) {
+      header.Put(include);
+      header.Put(HashFile(include));
+    }
+
+    // Concurrent runs must not observe partially written snapshots.
+    fs::path path(file_);
+    fs::create_directories(path.parent_path());
+    fs::path temp_path = path.parent_path() / fs::unique_path("%%%%%%%%.tmp");
+    {
+      std::ofstream out(temp_path.string(), std::ios::binary);
+      out.write(header.data().data(), header.data().size());
+      out.write(body.data().data(), body.data().size());
+      if (!out.flush())
+        SCRAM_THROW(IOError("Failed to write the model snapshot"))
+            << boost::errinfo_file_name(temp_path.string());
+    }
+    fs::rename(temp_path, path);
+    LOG(DEBUG1) << "The model snapshot is saved in " << DUR(save_time);
+  } catch (const std::exception& err) {
+    LOG(WARNING) << "Failed to save the model snapshot " << file_ << ": "
+                 << err.what();
+  }
+  return true;
+}
+
+}  // namespace scram::mef
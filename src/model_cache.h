@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Binary snapshots of validated models
+/// to skip the processing of unchanged input files.
+
+#pragma once
+
+#include <cstdint>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model.h"
+
+namespace scram::mef {
+
+/// Cache of compiled models in a directory.
+///
+/// A snapshot of the model is keyed by a content hash of its input files
+/// and is valid only for the same input files and the same SCRAM build.
+/// The files included with XInclude directives
+/// are recorded in the snapshot and checked upon loading.
+///
+/// The snapshot holds the model state after the validation
+/// but before the setup for analysis (e.g., CCF models are not applied).
+/// Models with external libraries are not cached.
+class ModelCache {
+ public:
+  /// Computes the key of the model snapshot.
+  ///
+  /// @param[in] directory  The directory for snapshot files.
+  /// @param[in] xml_files  The MEF XML input files of the model.
+  ///
+  /// @throws IOError  The input files are not accessible.
+  ModelCache(const std::string& directory,
+             const std::vector<std::string>& xml_files);
+
+  /// @returns The path to the snapshot file for the input files.
+  const std::string& file() const { return file_; }
+
+  /// Loads the model from the snapshot
+  /// if the snapshot is up-to-date with the input files.
+  ///
+  /// @returns The model from the snapshot or nullptr.
+  ///
+  /// @note Corrupted or incompatible snapshot files are ignored with warnings.
+  std::unique_ptr<Model> Load() const;
+
+  /// Stores the snapshot of the model.
+  /// Writing failures are reported as warnings.
+  ///
+  /// @param[in] model  The validated model built from the input files.
+  ///
+  /// @returns false if the model has constructs unsupported by snapshots.
+  ///
+  /// @pre The model has not been set up for analysis.
+  bool Save(const Model& model) const;
+
+ private:
+  std::vector<std::string> xml_files_;  ///< The input files in order.
+  std::uint64_t key_;  ///< The content hash of the input files.
+  std::string file_;  ///< The path to the snapshot file.
+};
+
+}  // namespace scram::mef
@@ -49,6 +49,7 @@ Node::Node(Pdag* graph) noexcept
     : index_(Pdag::NodeIndexGenerator()(graph)),
       order_(0),
       visits_{},
+      visit_epoch_(0),
       opti_value_(0),
       pos_count_(0),
       neg_count_(0),
@@ -59,7 +60,7 @@ Node::~Node() = default;
 Gate::Gate(Connective type, Pdag* graph) noexcept
     : Node(graph),
       type_(type),
-      mark_(false),
+      mark_(0),
       module_(false),
       coherent_(false),
       min_number_(0),
@@ -72,10 +73,15 @@ void Gate::type(Connective type) {  // Don't use in Gate constructor!
   /// @todo Find the inefficient resets.
   /* assert(type_ != type && "Attribute reset: Operation with no effect."); */
   type_ = type;
+  RegisterChange();
   if (type_ == kNull)
     Pdag::NullGateRegistrar()(shared_from_this());
 }
 
+void Gate::RegisterChange() noexcept {
+  Pdag::ChangeRegistrar()(&Node::graph());
+}
+
 GatePtr Gate::Clone() noexcept {
   BLOG(DEBUG5, module_) << "WARNING: Cloning module G" << Node::index();
   assert(!constant() && type_ != kNull);
@@ -123,6 +129,7 @@ void Gate::AddConstantArg<true>() noexcept {
       assert(args_.size() >= 2);
       assert(min_number_ > 0);
       --min_number_;
+      RegisterChange();
       if (min_number_ == 1)
         type(kOr);
       break;
@@ -171,6 +178,7 @@ void Gate::TransferArg(int index, const GatePtr& recipient) noexcept {
   assert(index != 0);
   assert(args_.count(index));
   args_.erase(index);
+  RegisterChange();
 
   if (auto it_g = ext::find(gate_args_, index)) {
     it_g->second->EraseParent(Node::index());
@@ -208,6 +216,7 @@ void Gate::NegateArgs() noexcept {
     arg.first *= -1;
   for (auto& arg : variable_args_)
     arg.first *= -1;
+  RegisterChange();
 }
 
 void Gate::NegateArg(int existing_arg) noexcept {
@@ -217,6 +226,7 @@ void Gate::NegateArg(int existing_arg) noexcept {
 
   args_.erase(existing_arg);
   args_.insert(-existing_arg);
+  RegisterChange();
 
   if (auto it_g = ext::find(gate_args_, existing_arg)) {
     it_g->first *= -1;
@@ -247,6 +257,7 @@ void Gate::CoalesceGate(const GatePtr& arg_gate) noexcept {
   args_.erase(arg_gate->index());  // Erase at the end to avoid the type change.
   gate_args_.erase(arg_gate->index());
   arg_gate->EraseParent(Node::index());
+  RegisterChange();
 }
 
 void Gate::JoinNullGate(int index) noexcept {
@@ -259,6 +270,7 @@ void Gate::JoinNullGate(int index) noexcept {
   GatePtr null_gate = it_g->second;
   gate_args_.erase(it_g);
   null_gate->EraseParent(Node::index());
+  RegisterChange();
 
   assert(null_gate->type_ == kNull);
   assert(null_gate->args_.size() == 1);
@@ -288,6 +300,7 @@ void Gate::EraseArg(int index) noexcept {
   assert(index != 0);
   assert(args_.count(index));
   args_.erase(index);
+  RegisterChange();
 
   if (auto it_g = ext::find(gate_args_, index)) {
     it_g->second->EraseParent(Node::index());
@@ -306,6 +319,7 @@ void Gate::EraseArg(int index) noexcept {
 
 void Gate::EraseArgs() noexcept {
   args_.clear();
+  RegisterChange();
   for (const auto& arg : gate_args_)
     arg.second->EraseParent(Node::index());
   gate_args_.clear();
@@ -448,6 +462,9 @@ void Gate::ProcessComplementArg(int index) noexcept {
 
 Pdag::Pdag() noexcept
     : node_index_(0),
+      num_changes_(0),
+      gate_mark_epoch_(1),
+      visit_epoch_(1),
       complement_(false),
       coherent_(true),
       normal_(true),
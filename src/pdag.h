@@ -120,7 +120,10 @@ class Node : public NodeParentManager {
   virtual ~Node() = 0;  ///< Abstract class.
 
   /// @returns The host graph of the node.
+  /// @{
   Pdag& graph() { return graph_; }
+  const Pdag& graph() const { return graph_; }
+  /// @}
 
   /// @returns The index of this node.
   int index() const { return index_; }
@@ -150,34 +153,26 @@ class Node : public NodeParentManager {
   ///
   /// @returns true if this node was previously visited.
   /// @returns false if this is visited and re-visited only once.
-  bool Visit(int time) {
-    assert(time > 0);
-    if (!visits_[0]) {
-      visits_[0] = time;
-    } else if (!visits_[1]) {
-      visits_[1] = time;
-    } else {
-      visits_[2] = time;
-      return true;
-    }
-    return false;
-  }
+  bool Visit(int time);
 
   /// @returns The time when this node was first encountered or entered.
   /// @returns 0 if no enter time is registered.
-  int EnterTime() const { return visits_[0]; }
+  int EnterTime() const { return visits()[0]; }
 
   /// @returns The exit time upon traversal of the graph.
   /// @returns 0 if no exit time is registered.
-  int ExitTime() const { return visits_[1]; }
+  int ExitTime() const { return visits()[1]; }
 
   /// @returns The last time this node was visited.
   /// @returns 0 if no last time is registered.
-  int LastVisit() const { return visits_[2] ? visits_[2] : visits_[1]; }
+  int LastVisit() const {
+    const int* visits = Node::visits();
+    return visits[2] ? visits[2] : visits[1];
+  }
 
   /// @returns The minimum time of the visit.
   /// @returns 0 if no time is registered.
-  virtual int min_time() const { return visits_[0]; }
+  virtual int min_time() const { return visits()[0]; }
 
   /// @returns The maximum time of the visit.
   /// @returns 0 if no time is registered.
@@ -185,11 +180,11 @@ class Node : public NodeParentManager {
 
   /// @returns false if this node was only visited once upon graph traversal.
   /// @returns true if this node was revisited at least one more time.
-  bool Revisited() const { return visits_[2]; }
+  bool Revisited() const { return visits()[2]; }
 
   /// @returns true if this node was visited at least once.
   /// @returns false if this node was never visited upon traversal.
-  bool Visited() const { return visits_[0]; }
+  bool Visited() const { return visits()[0]; }
 
   /// Clears all the visit information. Resets the visit times to 0s.
   void ClearVisits() { std::fill_n(visits_, 3, 0); }
@@ -212,9 +207,14 @@ class Node : public NodeParentManager {
   }
 
  private:
+  /// @returns The first, second, and last visit times
+  ///          of the current generation of graph visits.
+  const int* visits() const;
+
   int index_;  ///< Index of this node.
   int order_;  ///< Ordering of nodes in the graph.
   int visits_[3];  ///< Traversal array with first, second, and last visits.
+  std::uint32_t visit_epoch_;  ///< The generation of the visit times.
   int opti_value_;  ///< Failure propagation optimization value.
   int pos_count_;  ///< The number of occurrences as a positive node.
   int neg_count_;  ///< The number of occurrences as a negative node.
@@ -358,7 +358,10 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
   /// @param[in] number  The min number of ATLEAST gate.
   ///
   /// @pre The min number is appropriate for the gate logic and arguments.
-  void min_number(int number) { min_number_ = number; }
+  void min_number(int number) {
+    min_number_ = number;
+    RegisterChange();
+  }
 
   /// @returns true if this gate has become constant.
   bool constant() const { return constant_ != nullptr; }
@@ -402,7 +405,7 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
   /// to visit information provided by the base Node class.
   ///
   /// @returns The mark of this gate.
-  bool mark() const { return mark_; }
+  bool mark() const;
 
   /// Sets the mark of this gate.
   ///
@@ -410,7 +413,7 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
   ///
   /// @pre The marks are assigned in a top-down traversal.
   /// @pre The marks are continuous.
-  void mark(bool flag) { mark_ = flag; }
+  void mark(bool flag);
 
   /// @returns Pre-assigned index of one of gate's descendants.
   int descendant() const { return descendant_; }
@@ -471,6 +474,7 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
   void module(bool flag) {
     assert(module_ != flag);
     module_ = flag;
+    RegisterChange();
   }
 
   /// Helper function to use the sign of the argument.
@@ -558,6 +562,7 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
     args_.insert(index);
     mutable_args<T>().data().emplace_back(index, arg);
     arg->AddParent(shared_from_this());
+    RegisterChange();
   }
   /// Wrapper to add gate arguments with index retrieval from the arg.
   template <class T>
@@ -733,8 +738,11 @@ class Gate : public Node, public std::enable_shared_from_this<Gate> {
       type(target_type);
   }
 
+  /// Counts a structural change of this gate in the host graph.
+  void RegisterChange() noexcept;
+
   Connective type_;  ///< Type of this gate.
-  bool mark_;  ///< Marking for linear traversal of a graph.
+  std::uint32_t mark_;  ///< The generation of the traversal mark.
   bool module_;  ///< Indication of an independent module gate.
   bool coherent_;  ///< Indication of a coherent graph.
   int min_number_;  ///< Min number for ATLEAST gate.
@@ -794,6 +802,13 @@ class Pdag : private boost::noncopyable {
     int operator()(Pdag* graph) const { return ++graph->node_index_; }
   };
 
+  /// Counter of structural changes to the gates of the graph.
+  class ChangeRegistrar {
+    friend class Gate;
+    /// @param[in,out] graph  The host graph of the changed gate.
+    void operator()(Pdag* graph) const { ++graph->num_changes_; }
+  };
+
   /// Registers pass-through or Null logic gates belonging to the graph.
   class NullGateRegistrar {
     friend class Gate;
@@ -899,8 +914,17 @@ class Pdag : private boost::noncopyable {
     assert(gate && "The graph cannot be made root-less.");
     assert(this == &gate->graph() && "The gate is from a different graph.");
     root_ = gate;
+    ++num_changes_;
   }
 
+  /// @returns The number of structural changes to the graph gates so far,
+  ///          i.e., argument additions, removals, negations,
+  ///          and logic, module, or root changes.
+  ///
+  /// @note The difference of the counts before and after a transformation
+  ///       measures the changes made by the transformation.
+  std::int64_t num_changes() const { return num_changes_; }
+
   /// @returns true if graph = ~root.
   /// @{
   bool complement() const { return complement_; }
@@ -979,13 +1003,29 @@ class Pdag : private boost::noncopyable {
   /// @warning Gate marks will get cleared by this function.
   void RemoveNullGates() noexcept;
 
+  /// @returns The current generation of the gate marks or node visits.
+  ///
+  /// @tparam Mark  The kind of the mark with generations.
+  template <NodeMark Mark>
+  std::uint32_t epoch() const {
+    static_assert(Mark == kGateMark || Mark == kVisit,
+                  "The node mark has no generations.");
+    return Mark == kGateMark ? gate_mark_epoch_ : visit_epoch_;
+  }
+
   /// Clears marks from graph nodes.
+  /// The gate marks and node visits are cleared in constant time
+  /// by starting their new generation,
+  /// which invalidates the marks of all the nodes of the graph at once.
   ///
   /// @tparam Mark  The kind of the mark.
   template <NodeMark Mark>
   void Clear() noexcept {
     if constexpr (Mark == kGateMark) {
-      Clear<kGateMark>(root_);
+      ++gate_mark_epoch_;
+
+    } else if constexpr (Mark == kVisit) {
+      ++visit_epoch_;
 
     } else {
       Clear<kGateMark>();
@@ -1125,6 +1165,9 @@ class Pdag : private boost::noncopyable {
   void PropagateNullGate(const GatePtr& gate) noexcept;
 
   int node_index_;  ///< Automatic index of the new node.
+  std::int64_t num_changes_;  ///< The number of structural changes.
+  std::uint32_t gate_mark_epoch_;  ///< The generation of the gate marks.
+  std::uint32_t visit_epoch_;  ///< The generation of the node visits.
   bool complement_;  ///< The indication of a complement graph.
   bool coherent_;  ///< Indication that the graph does not contain negation.
   bool normal_;  ///< Indication for the graph containing only OR and AND gates.
@@ -1139,6 +1182,37 @@ class Pdag : private boost::noncopyable {
   std::vector<Substitution> substitutions_;  ///< Non-declarative substitutions.
 };
 
+inline bool Node::Visit(int time) {
+  assert(time > 0);
+  if (std::uint32_t epoch = graph_.epoch<Pdag::kVisit>();
+      visit_epoch_ != epoch) {
+    visit_epoch_ = epoch;
+    ClearVisits();
+  }
+  if (!visits_[0]) {
+    visits_[0] = time;
+  } else if (!visits_[1]) {
+    visits_[1] = time;
+  } else {
+    visits_[2] = time;
+    return true;
+  }
+  return false;
+}
+
+inline const int* Node::visits() const {
+  static constexpr int kNoVisits[3] = {};
+  return visit_epoch_ == graph_.epoch<Pdag::kVisit>() ? visits_ : kNoVisits;
+}
+
+inline bool Gate::mark() const {
+  return mark_ == Node::graph().epoch<Pdag::kGateMark>();
+}
+
+inline void Gate::mark(bool flag) {
+  mark_ = flag ? Node::graph().epoch<Pdag::kGateMark>() : 0;
+}
+
 /// Traverses and visits gates and nodes in the graph.
 ///
 /// @tparam Mark  The "visited" gate mark.
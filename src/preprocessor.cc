@@ -78,6 +78,7 @@
 #include <array>
 #include <list>
 #include <queue>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <boost/functional/hash.hpp>
@@ -167,7 +168,8 @@ void MarkCoherence(Pdag* graph) noexcept {
 
 }  // namespace pdag
 
-Preprocessor::Preprocessor(Pdag* graph) noexcept : graph_(graph) {}
+Preprocessor::Preprocessor(Pdag* graph, const Settings& settings) noexcept
+    : graph_(graph), kSettings_(settings) {}
 
 void Preprocessor::operator()() noexcept {
   TIMER(DEBUG2, "Preprocessing");
@@ -183,6 +185,63 @@ void Preprocessor::Run() noexcept {
                   });
 }
 
+namespace {
+
+/// Counts the gates and variables reachable from the root of the graph
+/// without the use of node marks.
+///
+/// @param[in] graph  The graph to be counted.
+///
+/// @returns The number of gates and variables.
+std::pair<int, int> CountNodes(const Pdag& graph) noexcept {
+  std::unordered_set<int> gates = {graph.root().index()};
+  std::unordered_set<int> variables;
+  std::vector<const Gate*> stack = {&graph.root()};
+  while (!stack.empty()) {
+    const Gate* gate = stack.back();
+    stack.pop_back();
+    for (const auto& arg : gate->args<Gate>()) {
+      if (gates.insert(arg.second.index()).second)
+        stack.push_back(&arg.second);
+    }
+    for (const auto& arg : gate->args<Variable>())
+      variables.insert(arg.second.index());
+  }
+  return {gates.size(), variables.size()};
+}
+
+}  // namespace
+
+void Preprocessor::BeginPass(const char* name) noexcept {
+  auto [num_gates, num_variables] = CountNodes(*graph_);
+  profile_.push_back(
+      {name, phase_, 0, num_gates, num_gates, num_variables, num_variables, 0});
+  pass_changes_ = graph_->num_changes();
+  pass_start_ = TIME_STAMP();
+}
+
+void Preprocessor::EndPass(bool idempotent) noexcept {
+  assert(!profile_.empty() && "The pass profile is not started.");
+  PassProfile& pass = profile_.back();
+  pass.time = DUR(pass_start_);
+  pass.changes = graph_->num_changes() - pass_changes_;
+  std::tie(pass.gates_after, pass.variables_after) = CountNodes(*graph_);
+  LOG(DEBUG3) << "Pass " << pass.name << " made " << pass.changes
+              << " changes: " << pass.gates_before << " -> " << pass.gates_after
+              << " gates, " << pass.variables_before << " -> "
+              << pass.variables_after << " variables";
+  if (idempotent || !pass.changes)
+    fixed_points_[pass.name] = graph_->num_changes();
+}
+
+bool Preprocessor::IsFixedPoint(const char* name) noexcept {
+  auto it = fixed_points_.find(name);
+  if (it == fixed_points_.end() || it->second != graph_->num_changes())
+    return false;
+  LOG(DEBUG3) << "Skipping pass " << name << " at its fixed point";
+  return true;
+}
+
 /// Container of unique gates.
 /// This container acts like an unordered set of gates.
 /// The gates are equivalent
@@ -319,53 +378,61 @@ class TestGateStructure {
 
 void Preprocessor::RunPhaseOne() noexcept {
   TIMER(DEBUG2, "Preprocessing Phase I");
+  phase_ = 1;
   graph_->Log();
   if (graph_->HasNullGates()) {
     TIMER(DEBUG3, "Removing NULL gates");
-    graph_->RemoveNullGates();
+    Pass("remove-null-gates", [](Pdag* graph) { graph->RemoveNullGates(); },
+         /*idempotent=*/true)(graph_);
     if (graph_->IsTrivial())
       return;
   }
   SANITY_ASSERT;
   if (!graph_->coherent()) {
-    NormalizeGates(/*full=*/false);
+    Pass("normalize-gates", [this](Pdag*) { NormalizeGates(/*full=*/false); })(
+        graph_);
   }
 }
 
 void Preprocessor::RunPhaseTwo() noexcept {
   TIMER(DEBUG2, "Preprocessing Phase II");
   SANITY_ASSERT;
+  phase_ = 2;
   graph_->Log();
-  pdag::Transform(graph_,
-                  [this](Pdag*) {
-                    while (ProcessMultipleDefinitions())
-                      continue;
-                  },
-                  [this](Pdag*) { DetectModules(); },
-                  [this](Pdag*) {
-                    while (CoalesceGates(/*common=*/false))
-                      continue;
-                  },
-                  [this](Pdag*) { MergeCommonArgs(); },
-                  [this](Pdag*) { DetectDistributivity(); },
-                  [this](Pdag*) { DetectModules(); },
-                  [this](Pdag*) { BooleanOptimization(); },
-                  [this](Pdag*) { DecomposeCommonNodes(); },
-                  [this](Pdag*) { DetectModules(); },
-                  [this](Pdag*) {
-                    while (CoalesceGates(/*common=*/false))
-                      continue;
-                  },
-                  [this](Pdag*) { DetectModules(); });
+  auto coalesce_gates = Pass("coalesce-gates",
+                             [this](Pdag*) {
+                               while (CoalesceGates(/*common=*/false))
+                                 continue;
+                             },
+                             /*idempotent=*/true);
+  auto detect_modules = Pass("detect-modules",
+                             [this](Pdag*) { DetectModules(); },
+                             /*idempotent=*/true);
+  pdag::Transform(
+      graph_, Pass("process-multiple-definitions",
+                   [this](Pdag*) {
+                     while (ProcessMultipleDefinitions())
+                       continue;
+                   },
+                   /*idempotent=*/true),
+      detect_modules, coalesce_gates,
+      Pass("merge-common-args", [this](Pdag*) { MergeCommonArgs(); }),
+      Pass("detect-distributivity", [this](Pdag*) { DetectDistributivity(); }),
+      detect_modules,
+      Pass("boolean-optimization", [this](Pdag*) { BooleanOptimization(); }),
+      Pass("decompose-common-nodes", [this](Pdag*) { DecomposeCommonNodes(); }),
+      detect_modules, coalesce_gates, detect_modules);
   graph_->Log();
 }
 
 void Preprocessor::RunPhaseThree() noexcept {
   TIMER(DEBUG2, "Preprocessing Phase III");
   SANITY_ASSERT;
+  phase_ = 3;
   graph_->Log();
   assert(!graph_->normal());
-  NormalizeGates(/*full=*/true);
+  Pass("normalize-complex-gates",
+       [this](Pdag*) { NormalizeGates(/*full=*/true); })(graph_);
   graph_->normal(true);
 
   if (graph_->IsTrivial())
@@ -377,22 +444,24 @@ void Preprocessor::RunPhaseThree() noexcept {
 void Preprocessor::RunPhaseFour() noexcept {
   TIMER(DEBUG2, "Preprocessing Phase IV");
   SANITY_ASSERT;
+  phase_ = 4;
   graph_->Log();
   assert(!graph_->coherent());
   LOG(DEBUG3) << "Propagating complements...";
-  if (graph_->complement()) {
-    const GatePtr& root = graph_->root();
-    assert(root->type() == kOr || root->type() == kAnd ||
-           root->type() == kNull);
-    if (root->type() == kOr || root->type() == kAnd)
-      root->type(root->type() == kOr ? kAnd : kOr);
-    root->NegateArgs();
-    graph_->complement() = false;
-  }
-  std::unordered_map<int, GatePtr> complements;
-  graph_->Clear<Pdag::kGateMark>();
-  PropagateComplements(graph_->root(), false, &complements);
-  complements.clear();
+  Pass("propagate-complements", [this](Pdag*) {
+    if (graph_->complement()) {
+      const GatePtr& root = graph_->root();
+      assert(root->type() == kOr || root->type() == kAnd ||
+             root->type() == kNull);
+      if (root->type() == kOr || root->type() == kAnd)
+        root->type(root->type() == kOr ? kAnd : kOr);
+      root->NegateArgs();
+      graph_->complement() = false;
+    }
+    std::unordered_map<int, GatePtr> complements;
+    graph_->Clear<Pdag::kGateMark>();
+    PropagateComplements(graph_->root(), false, &complements);
+  })(graph_);
   LOG(DEBUG3) << "Complement propagation is done!";
 
   if (graph_->IsTrivial())
@@ -404,9 +473,15 @@ void Preprocessor::RunPhaseFour() noexcept {
 void Preprocessor::RunPhaseFive() noexcept {
   TIMER(DEBUG2, "Preprocessing Phase V");
   SANITY_ASSERT;
+  phase_ = 5;
   graph_->Log();
-  while (CoalesceGates(/*common=*/true))
-    continue;
+  auto coalesce_common_gates = Pass("coalesce-common-gates",
+                                    [this](Pdag*) {
+                                      while (CoalesceGates(/*common=*/true))
+                                        continue;
+                                    },
+                                    /*idempotent=*/true);
+  coalesce_common_gates(graph_);
 
   if (graph_->IsTrivial())
     return;
@@ -415,8 +490,8 @@ void Preprocessor::RunPhaseFive() noexcept {
   if (graph_->IsTrivial())
     return;
 
-  while (CoalesceGates(/*common=*/true))
-    continue;
+  phase_ = 5;
+  coalesce_common_gates(graph_);
 
   if (graph_->IsTrivial())
     return;
@@ -1093,24 +1168,54 @@ std::vector<GateWeakPtr> Preprocessor::GatherModules() noexcept {
   return modules;
 }
 
+namespace {
+
+/// The positions of merge candidates or options by their common arguments.
+using ArgIndex = std::unordered_map<int, std::vector<int>>;
+
+/// Builds the inverted index of common arguments.
+///
+/// @tparam T  The entry with common arguments.
+/// @tparam F  The accessor of the common arguments of the entry.
+///
+/// @param[in] entries  The merge candidates or options.
+/// @param[in] get_args  The accessor returning the pointer to the arguments.
+///
+/// @returns The ascending positions of the entries with each argument.
+template <class T, typename F>
+ArgIndex IndexArgs(const std::vector<T>& entries, F get_args) noexcept {
+  ArgIndex index;
+  for (int i = 0; i < entries.size(); ++i) {
+    for (int arg : *get_args(entries[i]))
+      index[arg].push_back(i);
+  }
+  return index;
+}
+
+}  // namespace
+
 bool Preprocessor::MergeCommonArgs() noexcept {
   TIMER(DEBUG3, "Merging common arguments");
   assert(!graph_->HasNullGates());
   bool changed = false;
+  WorkBudget budget(kSettings_.merge_budget());
 
   LOG(DEBUG4) << "Merging common arguments for AND gates...";
-  changed |= MergeCommonArgs(kAnd);
+  changed |= MergeCommonArgs(kAnd, &budget);
   LOG(DEBUG4) << "Finished merging for AND gates!";
 
   LOG(DEBUG4) << "Merging common arguments for OR gates...";
-  changed |= MergeCommonArgs(kOr);
+  changed |= MergeCommonArgs(kOr, &budget);
   LOG(DEBUG4) << "Finished merging for OR gates!";
 
+  BLOG(DEBUG3, budget.exhausted())
+      << "The merge budget is exhausted in " << budget.spent() << " steps.";
   assert(!graph_->HasNullGates());
   return changed;
 }
 
-bool Preprocessor::MergeCommonArgs(Connective op) noexcept {
+bool Preprocessor::MergeCommonArgs(Connective op,
+                                   WorkBudget* budget) noexcept {
   assert(op == kAnd || op == kOr);
   graph_->Clear<Pdag::kCount>();
   graph_->Clear<Pdag::kGateMark>();
@@ -1122,10 +1227,15 @@ bool Preprocessor::MergeCommonArgs(Connective op) noexcept {
   graph_->Clear<Pdag::kGateMark>();
   LOG(DEBUG4) << "Working with " << modules.size() << " modules...";
   bool changed = false;
-  for (const auto& module : modules) {
-    if (module.expired())
+  for (auto it = modules.begin(); it != modules.end(); ++it) {
+    if (budget->exhausted()) {
+      LOG(DEBUG4) << "Leaving " << std::distance(it, modules.end())
+                  << " modules unprocessed.";
+      break;
+    }
+    if (it->expired())
       continue;
-    GatePtr root = module.lock();
+    GatePtr root = it->lock();
     MergeTable::Candidates candidates;
     GatherCommonArgs(root, op, &candidates);
     graph_->Clear<Pdag::kGateMark>(root);
@@ -1139,13 +1249,15 @@ bool Preprocessor::MergeCommonArgs(Connective op) noexcept {
     for (const auto& group : groups) {
       // Finding common parents for the common arguments.
       MergeTable::Collection parents;
-      GroupCommonParents(2, group, &parents);
+      GroupCommonParents(2, group, &parents, budget);
       if (parents.empty())
         continue;  // No candidates for merging.
-      changed = true;
       LOG(DEBUG4) << "Merging " << parents.size() << " collection...";
       MergeTable table;
-      GroupCommonArgs(parents, &table);
+      GroupCommonArgs(parents, &table, budget);
+      if (table.groups.empty())
+        continue;
+      changed = true;
       LOG(DEBUG4) << "Transforming " << table.groups.size()
                   << " table groups...";
       for (MergeTable::MergeGroup& member_group : table.groups) {
@@ -1346,28 +1458,48 @@ void Preprocessor::GroupCandidatesByArgs(
 
 void Preprocessor::GroupCommonParents(
     int num_common_args, const MergeTable::Candidates& group,
-    MergeTable::Collection* parents) noexcept {
+    MergeTable::Collection* parents, WorkBudget* budget) noexcept {
+  ArgIndex members = IndexArgs(group, [](const MergeTable::Candidate& entry) {
+    return &entry.second;
+  });
+  // The common arguments of the current candidate with the later ones.
+  std::vector<MergeTable::CommonArgs> intersections(group.size());
+  std::vector<int> partners;  // The later candidates with any common args.
   for (int i = 0; i < group.size(); ++i) {
+    if (budget->exhausted()) {
+      LOG(DEBUG4) << "Leaving " << (group.size() - i)
+                  << " gates without common parents.";
+      break;
+    }
     const std::vector<int>& args_gate = group[i].second;
     assert(args_gate.size() > 1);
-    int j = i;
-    for (++j; j < group.size(); ++j) {
-      const std::vector<int>& args_comp = group[j].second;
-      assert(args_comp.size() > 1);
-
-      std::vector<int> common;
-      boost::set_intersection(args_gate, args_comp, std::back_inserter(common));
-      if (common.size() < num_common_args)
-        continue;  // Doesn't satisfy.
-      MergeTable::CommonParents& common_parents = (*parents)[common];
-      common_parents.insert(group[i].first);
-      common_parents.insert(group[j].first);
+    for (int index : args_gate) {  // Sorted intersections w/o comparisons.
+      const std::vector<int>& arg_members = members.find(index)->second;
+      auto it = std::upper_bound(arg_members.begin(), arg_members.end(), i);
+      budget->Spend(std::distance(it, arg_members.end()));
+      for (; it != arg_members.end(); ++it) {
+        if (intersections[*it].empty())
+          partners.push_back(*it);
+        intersections[*it].push_back(index);
+      }
     }
+    boost::sort(partners);
+    for (int j : partners) {
+      std::vector<int>& common = intersections[j];
+      if (common.size() >= num_common_args) {
+        MergeTable::CommonParents& common_parents = (*parents)[common];
+        common_parents.insert(group[i].first);
+        common_parents.insert(group[j].first);
+      }
+      common.clear();
+    }
+    partners.clear();
   }
 }
 
 void Preprocessor::GroupCommonArgs(const MergeTable::Collection& options,
-                                   MergeTable* table) noexcept {
+                                   MergeTable* table,
+                                   WorkBudget* budget) noexcept {
   assert(!options.empty());
   MergeTable::MergeGroup all_options(options.begin(), options.end());
   boost::stable_sort(all_options, [](const MergeTable::Option& lhs,
@@ -1376,8 +1508,13 @@ void Preprocessor::GroupCommonArgs(const MergeTable::Collection& options,
   });
 
   while (!all_options.empty()) {
+    if (budget->exhausted()) {
+      LOG(DEBUG4) << "Leaving " << all_options.size()
+                  << " merge options unprocessed.";
+      break;
+    }
     MergeTable::OptionGroup best_group;
-    FindOptionGroup(&all_options, &best_group);
+    FindOptionGroup(&all_options, &best_group, budget);
     assert(!best_group.empty());
     MergeTable::MergeGroup merge_group;  // The group to go into the table.
     for (MergeTable::Option* member : best_group) {
@@ -1404,25 +1541,44 @@ void Preprocessor::GroupCommonArgs(const MergeTable::Collection& options,
 }
 
 void Preprocessor::FindOptionGroup(
-    MergeTable::MergeGroup* all_options,
-    MergeTable::OptionGroup* best_group) noexcept {
+    MergeTable::MergeGroup* all_options, MergeTable::OptionGroup* best_group,
+    WorkBudget* budget) noexcept {
   assert(best_group->empty());
   // Find the best starting option.
   MergeTable::MergeGroup::iterator best_option;
   FindBaseOption(all_options, &best_option);
   bool best_is_found = best_option != all_options->end();
+  // The options in the group have the subsets of the base option parents,
+  // so only the options starting with the base parents are considered.
+  std::unordered_map<const Gate*, std::vector<int>> first_parents;
+  for (int i = 0; i < all_options->size(); ++i)
+    first_parents[(*all_options)[i].second.begin()->get()].push_back(i);
+  budget->Spend(all_options->size());
+
   auto it = best_is_found ? best_option : all_options->begin();
   for (; it != all_options->end(); ++it) {
+    int position = std::distance(all_options->begin(), it);
+    std::vector<int> candidates;  // The later options with the base parents.
+    for (const GatePtr& parent : it->second) {
+      if (auto it_members = ext::find(first_parents, parent.get())) {
+        const std::vector<int>& members = it_members->second;
+        candidates.insert(
+            candidates.end(),
+            std::upper_bound(members.begin(), members.end(), position),
+            members.end());
+      }
+    }
+    boost::sort(candidates);
+    budget->Spend(candidates.size());
     MergeTable::OptionGroup group = {&*it};
-    auto it_next = it;
-    for (++it_next; it_next != all_options->end(); ++it_next) {
-      MergeTable::Option* candidate = &*it_next;
-      bool superset = boost::includes(candidate->first, group.back()->first);
-      if (!superset)
-        continue;  // Does not include all the arguments.
+    for (int index : candidates) {
+      MergeTable::Option* candidate = &(*all_options)[index];
       bool parents = boost::includes(group.back()->second, candidate->second);
       if (!parents)
         continue;  // Parents do not match.
+      bool superset = boost::includes(candidate->first, group.back()->first);
+      if (!superset)
+        continue;  // Does not include all the arguments.
       group.push_back(candidate);
     }
     if (group.size() > best_group->size()) {  // The more members, the merrier.
@@ -1431,7 +1587,7 @@ void Preprocessor::FindOptionGroup(
       if (group.front()->second.size() < best_group->front()->second.size())
         *best_group = group;  // The fewer parents, the more room for others.
     }
-    if (best_is_found)
+    if (best_is_found || budget->exhausted())
       break;
   }
 }
@@ -1441,14 +1597,18 @@ void Preprocessor::FindBaseOption(
     MergeTable::MergeGroup::iterator* best_option) noexcept {
   *best_option = all_options->end();
   std::array<int, 3> best_counts{};  // The number of extra parents.
+  // The argument lookup is linear in the number of the gate arguments.
+  std::unordered_map<int, int> arg_parents;  // The cache of parent counts.
   for (auto it = all_options->begin(); it != all_options->end(); ++it) {
     int num_parents = it->second.size();
     const GatePtr& parent = *it->second.begin();  // Representative.
     const MergeTable::CommonArgs& args = it->first;
     std::array<int, 3> cur_counts{};
     for (int index : args) {
-      NodePtr arg = parent->GetArg(index);
-      int extra_count = arg->parents().size() - num_parents;
+      auto [it_count, inserted] = arg_parents.emplace(index, 0);
+      if (inserted)
+        it_count->second = parent->GetArg(index)->parents().size();
+      int extra_count = it_count->second - num_parents;
       if (extra_count > 2)
         continue;  // Optimal decision criterion.
       ++cur_counts[extra_count];  // Logging extra parents.
@@ -1516,13 +1676,17 @@ bool Preprocessor::DetectDistributivity() noexcept {
   TIMER(DEBUG3, "Processing Distributivity");
   assert(!graph_->HasNullGates());
   graph_->Clear<Pdag::kGateMark>();
-  bool changed = DetectDistributivity(graph_->root());
+  WorkBudget budget(kSettings_.merge_budget());
+  bool changed = DetectDistributivity(graph_->root(), &budget);
+  BLOG(DEBUG3, budget.exhausted())
+      << "The merge budget is exhausted in " << budget.spent() << " steps.";
   assert(!graph_->HasConstants());
   graph_->RemoveNullGates();
   return changed;
 }
 
-bool Preprocessor::DetectDistributivity(const GatePtr& gate) noexcept {
+bool Preprocessor::DetectDistributivity(const GatePtr& gate,
+                                        WorkBudget* budget) noexcept {
   if (gate->mark())
     return false;
   gate->mark(true);
@@ -1545,7 +1709,7 @@ bool Preprocessor::DetectDistributivity(const GatePtr& gate) noexcept {
   // Collect child gates of distributivity type.
   for (const Gate::Arg<Gate>& arg : gate->args<Gate>()) {
     const GatePtr& child_gate = arg.second;
-    changed |= DetectDistributivity(child_gate);
+    changed |= DetectDistributivity(child_gate, budget);
     assert(!child_gate->constant() && "Impossible state.");
     if (distr_type == kNull)
       continue;  // Distributivity is not possible.
@@ -1556,13 +1720,13 @@ bool Preprocessor::DetectDistributivity(const GatePtr& gate) noexcept {
     if (child_gate->type() == distr_type)
       candidates.push_back(child_gate);
   }
-  changed |= HandleDistributiveArgs(gate, distr_type, &candidates);
+  changed |= HandleDistributiveArgs(gate, distr_type, &candidates, budget);
   return changed;
 }
 
 bool Preprocessor::HandleDistributiveArgs(
     const GatePtr& gate, Connective distr_type,
-    std::vector<GatePtr>* candidates) noexcept {
+    std::vector<GatePtr>* candidates, WorkBudget* budget) noexcept {
   if (candidates->empty())
     return false;
   assert(gate->args().size() > 1 && "Malformed parent gate.");
@@ -1581,14 +1745,15 @@ bool Preprocessor::HandleDistributiveArgs(
   }
   LOG(DEBUG5) << "Considering " << all_candidates.size() << " candidates...";
   MergeTable::Collection options;
-  GroupCommonParents(1, all_candidates, &options);
+  GroupCommonParents(1, all_candidates, &options, budget);
   if (options.empty())
     return false;
   LOG(DEBUG4) << "Got " << options.size() << " distributive option(s).";
 
   MergeTable table;
-  GroupDistributiveArgs(options, &table);
-  assert(!table.groups.empty());
+  GroupDistributiveArgs(options, &table, budget);
+  if (table.groups.empty())
+    return changed;
   LOG(DEBUG4) << "Found " << table.groups.size() << " distributive group(s).";
   // Sanitize the table with single parent gates only.
   for (MergeTable::MergeGroup& group : table.groups) {
@@ -1676,7 +1841,8 @@ bool Preprocessor::FilterDistributiveArgs(
 }
 
 void Preprocessor::GroupDistributiveArgs(const MergeTable::Collection& options,
-                                         MergeTable* table) noexcept {
+                                         MergeTable* table,
+                                         WorkBudget* budget) noexcept {
   assert(!options.empty());
   MergeTable::MergeGroup all_options(options.begin(), options.end());
   boost::stable_sort(all_options, [](const MergeTable::Option& lhs,
@@ -1685,8 +1851,13 @@ void Preprocessor::GroupDistributiveArgs(const MergeTable::Collection& options,
   });
 
   while (!all_options.empty()) {
+    if (budget->exhausted()) {
+      LOG(DEBUG4) << "Leaving " << all_options.size()
+                  << " distributive options unprocessed.";
+      break;
+    }
     MergeTable::OptionGroup best_group;
-    FindOptionGroup(&all_options, &best_group);
+    FindOptionGroup(&all_options, &best_group, budget);
     MergeTable::MergeGroup merge_group;  // The group to go into the table.
     for (MergeTable::Option* member : best_group) {
       merge_group.push_back(*member);
@@ -2368,7 +2539,9 @@ void Preprocessor::GatherNodes(const GatePtr& gate, std::vector<GatePtr>* gates,
 
 void CustomPreprocessor<Bdd>::Run() noexcept {
   Preprocessor::Run();
-  pdag::Transform(graph_, &pdag::MarkCoherence, &pdag::TopologicalOrder);
+  phase_ = 0;
+  pdag::Transform(graph_, Pass("mark-coherence", &pdag::MarkCoherence),
+                  Pass("topological-order", &pdag::TopologicalOrder));
 }
 
 void CustomPreprocessor<Zbdd>::Run() noexcept {
@@ -2378,13 +2551,16 @@ void CustomPreprocessor<Zbdd>::Run() noexcept {
                     if (!graph_->coherent())
                       RunPhaseFour();
                   },
-                  [this](Pdag*) { RunPhaseFive(); }, &pdag::MarkCoherence,
-                  &pdag::TopologicalOrder);
+                  [this](Pdag*) { RunPhaseFive(); });
+  phase_ = 0;
+  pdag::Transform(graph_, Pass("mark-coherence", &pdag::MarkCoherence),
+                  Pass("topological-order", &pdag::TopologicalOrder));
 }
 
 void CustomPreprocessor<Mocus>::Run() noexcept {
   CustomPreprocessor<Zbdd>::Run();
-  pdag::Transform(graph_, [this](Pdag*) { InvertOrder(); });
+  pdag::Transform(graph_,
+                  Pass("invert-order", [this](Pdag*) { InvertOrder(); }));
 }
 
 void CustomPreprocessor<Mocus>::InvertOrder() noexcept {
@@ -21,8 +21,11 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include <memory>
 #include <set>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -31,6 +34,7 @@
 #include <boost/unordered_map.hpp>
 
 #include "pdag.h"
+#include "settings.h"
 
 namespace scram::core {
 
@@ -82,6 +86,47 @@ void MarkCoherence(Pdag* graph) noexcept;
 
 }  // namespace pdag
 
+/// The profile of one application of a preprocessing pass.
+/// The node counts include only the nodes reachable from the graph root.
+struct PassProfile {
+  const char* name;  ///< The name of the pass.
+  int phase;  ///< The applying phase or 0 for the final ordering passes.
+  double time;  ///< The wall time of the pass in seconds.
+  int gates_before;  ///< The number of gates before the pass.
+  int gates_after;  ///< The number of gates after the pass.
+  int variables_before;  ///< The number of variables before the pass.
+  int variables_after;  ///< The number of variables after the pass.
+  std::int64_t changes;  ///< The number of structural changes to the graph.
+};
+
+/// The limit on the work of a preprocessing technique
+/// in its elementary steps, e.g., argument comparisons.
+class WorkBudget {
+ public:
+  /// @param[in] limit  The maximum number of steps or 0 for no limit.
+  explicit WorkBudget(std::int64_t limit = 0) : limit_(limit) {}
+
+  /// @returns true if the steps exceed the limit.
+  bool exhausted() const { return limit_ && spent_ > limit_; }
+
+  /// @returns The number of spent steps.
+  std::int64_t spent() const { return spent_; }
+
+  /// Registers the work of the technique.
+  ///
+  /// @param[in] steps  The number of spent steps.
+  ///
+  /// @returns false if the budget is exhausted.
+  bool Spend(std::int64_t steps) {
+    spent_ += steps;
+    return !exhausted();
+  }
+
+ private:
+  std::int64_t limit_;  ///< The maximum number of steps.
+  std::int64_t spent_ = 0;  ///< The number of spent steps.
+};
+
 /// The class provides main preprocessing operations
 /// over a PDAG
 /// to simplify the fault tree
@@ -92,6 +137,7 @@ class Preprocessor : private boost::noncopyable {
   /// representing a fault tree.
   ///
   /// @param[in] graph  The PDAG to be preprocessed.
+  /// @param[in] settings  The settings with the work budgets of techniques.
   ///
   /// @warning There should not be another shared pointer to the root gate
   ///          outside of the passed PDAG.
@@ -101,16 +147,47 @@ class Preprocessor : private boost::noncopyable {
   ///          the destructor will not be called
   ///          as expected by the preprocessing algorithms,
   ///          which will mess the new structure of the PDAG.
-  explicit Preprocessor(Pdag* graph) noexcept;
+  explicit Preprocessor(Pdag* graph,
+                        const Settings& settings = Settings()) noexcept;
 
   virtual ~Preprocessor() = default;
 
   /// Runs the graph preprocessing.
   void operator()() noexcept;
 
+  /// @returns The profiles of the applied passes in the order of application.
+  const std::vector<PassProfile>& profile() const { return profile_; }
+
  protected:
   class GateSet;  ///< Container of unique gates by semantics.
 
+  /// Wraps a graph transformation into a profiled preprocessing pass.
+  ///
+  /// The pass is skipped
+  /// if the graph has not changed since the pass left it at a fixed point,
+  /// i.e., after an application of the idempotent pass
+  /// or after an application of any pass without changes.
+  ///
+  /// @tparam F  The transformation type callable with the graph pointer.
+  ///
+  /// @param[in] name  The unique name of the pass.
+  /// @param[in] transformation  The transformation of the graph.
+  /// @param[in] idempotent  true if the repeated application of the pass
+  ///                        on its own result makes no changes.
+  ///
+  /// @returns The unary operation on the graph for pdag::Transform.
+  template <typename F>
+  auto Pass(const char* name, F transformation,
+            bool idempotent = false) noexcept {
+    return [this, name, transformation, idempotent](Pdag* graph) mutable {
+      if (IsFixedPoint(name))
+        return;
+      BeginPass(name);
+      transformation(graph);
+      EndPass(idempotent);
+    };
+  }
+
   /// Runs the default preprocessing
   /// that achieves the graph in a normal form.
   virtual void Run() noexcept = 0;
@@ -437,6 +514,7 @@ class Preprocessor : private boost::noncopyable {
   ///       Partial or full normalization may make
   ///       this technique more effective.
   /// @note Constant arguments are not expected.
+  /// @note The work of the technique is limited by the merge budget.
   ///
   /// @warning Gate marks are used for traversal.
   /// @warning Node counts are used for common node detection.
@@ -448,15 +526,17 @@ class Preprocessor : private boost::noncopyable {
   /// that divides the main merging technique by the gate types.
   ///
   /// @param[in] op  The connective that defines the group.
+  /// @param[in,out] budget  The work budget of the merging.
   ///
   /// @returns true if common args are merged into gates.
   ///
   /// @note The connective or logic of the gates must allow merging.
   ///       OR/AND connectives are expected.
+  /// @note The modules are left intact upon the exhaustion of the budget.
   ///
   /// @warning Gate marks are used for traversal.
   /// @warning Node counts are used for common node detection.
-  bool MergeCommonArgs(Connective op) noexcept;
+  bool MergeCommonArgs(Connective op, WorkBudget* budget) noexcept;
 
   /// Marks common arguments of gates with a specific connective.
   ///
@@ -537,15 +617,22 @@ class Preprocessor : private boost::noncopyable {
   /// Gates with the same common arguments are grouped
   /// to represent common parents for the arguments.
   ///
+  /// The intersections are gathered with the inverted index of arguments
+  /// without comparisons of gates that share no arguments.
+  ///
   /// @param[in] num_common_args  The least number common arguments to consider.
   /// @param[in] group  The group of the gates with their common arguments.
   /// @param[out] parents  Grouped common parent gates
   ///                      for the sets of common arguments.
+  /// @param[in,out] budget  The work budget in visited arguments.
   ///
   /// @note The common arguments are sorted.
+  /// @note Upon the exhaustion of the budget,
+  ///       the intersections with the rest of the gates are not gathered.
   void GroupCommonParents(int num_common_args,
                           const MergeTable::Candidates& group,
-                          MergeTable::Collection* parents) noexcept;
+                          MergeTable::Collection* parents,
+                          WorkBudget* budget) noexcept;
 
   /// Groups common args for merging.
   /// The common parents of arguments are isolated into groups
@@ -553,8 +640,12 @@ class Preprocessor : private boost::noncopyable {
   ///
   /// @param[in] options  Combinations of common args and distributive gates.
   /// @param[out] table  Groups of distributive gates for separate manipulation.
+  /// @param[in,out] budget  The work budget of the option search.
+  ///
+  /// @note The rest of the options are discarded
+  ///       upon the exhaustion of the budget.
   void GroupCommonArgs(const MergeTable::Collection& options,
-                       MergeTable* table) noexcept;
+                       MergeTable* table, WorkBudget* budget) noexcept;
 
   /// Finds an optimal way of grouping options.
   /// The goal of this function is
@@ -583,6 +674,7 @@ class Preprocessor : private boost::noncopyable {
   ///                         The options must be sorted
   ///                         in ascending size of common arguments.
   /// @param[out] best_group  The optimal group of options.
+  /// @param[in,out] budget  The work budget in compared options.
   ///
   /// @note The all_options parameter is not passed by const reference
   ///       because the best group must store non const pointers to options.
@@ -591,10 +683,14 @@ class Preprocessor : private boost::noncopyable {
   ///       However, this function guarantees
   ///       not to manipulate or change the set of all options.
   ///
+  /// @note Upon the exhaustion of the budget,
+  ///       the best group among the already considered options is chosen.
+  ///
   /// @todo The current logic misses opportunities
   ///       that may branch with the same base option.
   void FindOptionGroup(MergeTable::MergeGroup* all_options,
-                       MergeTable::OptionGroup* best_group) noexcept;
+                       MergeTable::OptionGroup* best_group,
+                       WorkBudget* budget) noexcept;
 
   /// Finds the starting option for group formation.
   ///
@@ -623,6 +719,7 @@ class Preprocessor : private boost::noncopyable {
   /// (a | b) & (a | c) = a | b & c.
   ///
   /// @param[in] gate  The gate which arguments and subgraph must be tested.
+  /// @param[in,out] budget  The work budget of the grouping of arguments.
   ///
   /// @returns true if transformations are performed.
   ///
@@ -630,7 +727,7 @@ class Preprocessor : private boost::noncopyable {
   /// @note NULL type gates are registered if produced.
   ///
   /// @warning Gate marks must be clear.
-  bool DetectDistributivity(const GatePtr& gate) noexcept;
+  bool DetectDistributivity(const GatePtr& gate, WorkBudget* budget) noexcept;
 
   /// Manipulates gates with distributive arguments.
   /// Designed to work with distributivity detection and manipulation logic.
@@ -638,10 +735,12 @@ class Preprocessor : private boost::noncopyable {
   /// @param[in,out] gate  The gate which arguments must be manipulated.
   /// @param[in] distr_type  The type of distributive arguments.
   /// @param[in,out] candidates  Candidates for distributivity check.
+  /// @param[in,out] budget  The work budget of the grouping of arguments.
   ///
   /// @returns true if transformations are performed.
   bool HandleDistributiveArgs(const GatePtr& gate, Connective distr_type,
-                              std::vector<GatePtr>* candidates) noexcept;
+                              std::vector<GatePtr>* candidates,
+                              WorkBudget* budget) noexcept;
 
   /// Detects relationships between the gate and its distributive arguments
   /// to remove unnecessary candidates.
@@ -665,10 +764,14 @@ class Preprocessor : private boost::noncopyable {
   ///
   /// @param[in] options  Combinations of common args and distributive gates.
   /// @param[out] table  Groups of distributive gates for separate manipulation.
+  /// @param[in,out] budget  The work budget of the option search.
+  ///
+  /// @note The rest of the options are discarded
+  ///       upon the exhaustion of the budget.
   ///
   /// @todo Evaluate various grouping strategies as in common arg merging.
   void GroupDistributiveArgs(const MergeTable::Collection& options,
-                             MergeTable* table) noexcept;
+                             MergeTable* table, WorkBudget* budget) noexcept;
 
   /// Transforms distributive of arguments gates
   /// into a new subgraph.
@@ -993,6 +1096,30 @@ class Preprocessor : private boost::noncopyable {
 
   /// @todo Eliminate the protected data.
   Pdag* graph_;  ///< The PDAG to preprocess.
+  int phase_ = 0;  ///< The current phase of preprocessing.
+
+ private:
+  /// Starts the profile of a pass on the current state of the graph.
+  ///
+  /// @param[in] name  The name of the pass.
+  void BeginPass(const char* name) noexcept;
+
+  /// Completes the profile of the last started pass.
+  ///
+  /// @param[in] idempotent  The idempotence of the pass.
+  void EndPass(bool idempotent) noexcept;
+
+  /// @param[in] name  The name of the pass.
+  ///
+  /// @returns true if the pass cannot change the current graph.
+  bool IsFixedPoint(const char* name) noexcept;
+
+  const Settings kSettings_;  ///< The settings with the work budgets.
+  std::vector<PassProfile> profile_;  ///< The profiles of the applied passes.
+  std::uint64_t pass_start_ = 0;  ///< The start time stamp of the pass.
+  std::int64_t pass_changes_ = 0;  ///< The graph changes before the pass.
+  /// The graph change counts at the fixed points of the passes.
+  std::unordered_map<std::string_view, std::int64_t> fixed_points_;
 };
 
 /// Undefined template class for specialization of Preprocessor
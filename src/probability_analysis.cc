@@ -21,9 +21,14 @@
 
 #include "probability_analysis.h"
 
+#include <cmath>
+
+#include <algorithm>
+
 #include <boost/range/algorithm/find_if.hpp>
 
 #include "event.h"
+#include "expression/tape.h"
 #include "logger.h"
 #include "parameter.h"
 #include "settings.h"
@@ -158,7 +163,7 @@ void ProbabilityAnalysis::ComputeSil() noexcept {
 
 double CutSetProbabilityCalculator::Calculate(
     const std::vector<int>& cut_set,
-    const Pdag::IndexMap<double>& p_vars) noexcept {
+    const Pdag::IndexMap<double>& p_vars) const noexcept {
   double p_sub_set = 1;  // 1 is for multiplication.
   for (int member : cut_set) {
     assert(member > 0 && "Complements in a cut set.");
@@ -168,16 +173,31 @@ double CutSetProbabilityCalculator::Calculate(
 }
 
 double RareEventCalculator::Calculate(
-    const Zbdd& cut_sets, const Pdag::IndexMap<double>& p_vars) noexcept {
-  double sum = 0;
-  for (const std::vector<int>& cut_set : cut_sets) {
-    sum += CutSetProbabilityCalculator::Calculate(cut_set, p_vars);
-  }
+    const Zbdd& cut_sets,
+    const Pdag::IndexMap<double>& p_vars) const noexcept {
+  double sum = cut_sets.CalculateProbabilitySum(p_vars);
   return sum > 1 ? 1 : sum;
 }
 
+ProbabilityBatch::Results RareEventCalculator::Calculate(
+    const Zbdd& cut_sets, const ProbabilityBatch& batch) const noexcept {
+  ProbabilityBatch::Results sums;
+  if (!cut_sets.CalculateProbabilitySums(batch.data(), ProbabilityBatch::kSize,
+                                         sums.data())) {
+    Pdag::IndexMap<double> p_vars(batch.num_variables());
+    for (int lane = 0; lane < ProbabilityBatch::kSize; ++lane) {
+      batch.Gather(lane, &p_vars);
+      sums[lane] = cut_sets.CalculateProbabilitySum(p_vars);
+    }
+  }
+  for (double& sum : sums)
+    sum = sum > 1 ? 1 : sum;
+  return sums;
+}
+
 double McubCalculator::Calculate(
-    const Zbdd& cut_sets, const Pdag::IndexMap<double>& p_vars) noexcept {
+    const Zbdd& cut_sets,
+    const Pdag::IndexMap<double>& p_vars) const noexcept {
   double m = 1;
   for (const std::vector<int>& cut_set : cut_sets) {
     m *= 1 - CutSetProbabilityCalculator::Calculate(cut_set, p_vars);
@@ -185,12 +205,115 @@ double McubCalculator::Calculate(
   return 1 - m;
 }
 
+ProbabilityBatch::Results McubCalculator::Calculate(
+    const Zbdd& cut_sets, const ProbabilityBatch& batch) const noexcept {
+  constexpr int kSize = ProbabilityBatch::kSize;
+  ProbabilityBatch::Results m;
+  m.fill(1);
+  ProbabilityBatch::Results p_cut_set;
+  for (const std::vector<int>& cut_set : cut_sets) {
+    p_cut_set.fill(1);
+    for (int member : cut_set) {
+      assert(member > 0 && "Complements in a cut set.");
+      const double* p_var = batch.lanes(member);
+      for (int lane = 0; lane < kSize; ++lane)  // This should get vectorized.
+        p_cut_set[lane] *= p_var[lane];
+    }
+    for (int lane = 0; lane < kSize; ++lane)
+      m[lane] *= 1 - p_cut_set[lane];
+  }
+  for (double& p : m)
+    p = 1 - p;
+  return m;
+}
+
+ProbabilityBatch::ProbabilityBatch(const Pdag::IndexMap<double>& p_vars)
+    : values_(p_vars.size() * kSize) {
+  auto it = values_.begin();
+  for (double p : p_vars)
+    it = std::fill_n(it, kSize, p);
+}
+
+void ProbabilityBatch::Gather(int lane,
+                              Pdag::IndexMap<double>* p_vars) const noexcept {
+  assert(values_.size() == p_vars->size() * kSize);
+  auto it = values_.begin() + lane;
+  for (double& p : *p_vars) {
+    p = *it;
+    it += kSize;
+  }
+}
+
 void ProbabilityAnalyzerBase::ExtractVariableProbabilities() {
   p_vars_.reserve(graph_->basic_events().size());
   for (const mef::BasicEvent* event : graph_->basic_events())
     p_vars_.push_back(event->p());
 }
 
+namespace {
+
+/// The maximum number of bisections of the time step.
+const int kMaxTimeRefinements = 10;
+
+/// Bisects the time intervals of the probability curve
+/// where the probability at the midpoint deviates
+/// from the linear interpolation by more than the tolerance.
+/// The intervals are refined level by level,
+/// so the midpoints are calculated in batches.
+///
+/// @tparam F  The calculator appending {probability, time} points.
+///
+/// @param[in] tolerance  The absolute tolerance for probabilities.
+/// @param[in] evaluate  The calculator of points for given times.
+/// @param[in,out] p_time  The curve points to refine in ascending time.
+template <class F>
+void RefineProbabilityOverTime(double tolerance, F&& evaluate,
+                               std::vector<std::pair<double, double>>* p_time) {
+  assert(tolerance > 0);
+  std::vector<std::pair<int, int>> intervals;  // The point indices.
+  for (int i = 1; i < p_time->size(); ++i)
+    intervals.emplace_back(i - 1, i);
+
+  std::vector<double> midpoints;
+  for (int level = 0; level < kMaxTimeRefinements && !intervals.empty();
+       ++level) {
+    midpoints.clear();
+    for (const auto& [low, high] : intervals)
+      midpoints.push_back(((*p_time)[low].second + (*p_time)[high].second) / 2);
+    int first = p_time->size();
+    evaluate(midpoints);
+
+    std::vector<std::pair<int, int>> next_intervals;
+    for (int i = 0; i < intervals.size(); ++i) {
+      auto [low, high] = intervals[i];
+      int middle = first + i;
+      double linear = ((*p_time)[low].first + (*p_time)[high].first) / 2;
+      if (std::abs((*p_time)[middle].first - linear) <= tolerance)
+        continue;
+      double time = (*p_time)[middle].second;
+      if (time > (*p_time)[low].second && time < (*p_time)[high].second) {
+        next_intervals.emplace_back(low, middle);
+        next_intervals.emplace_back(middle, high);
+      }
+    }
+    intervals = std::move(next_intervals);
+  }
+  std::sort(p_time->begin(), p_time->end(),
+            [](const std::pair<double, double>& lhs,
+               const std::pair<double, double>& rhs) {
+              return lhs.second < rhs.second;
+            });
+  // Degenerate midpoints of too short intervals.
+  p_time->erase(std::unique(p_time->begin(), p_time->end(),
+                            [](const std::pair<double, double>& lhs,
+                               const std::pair<double, double>& rhs) {
+                              return lhs.second == rhs.second;
+                            }),
+                p_time->end());
+}
+
+}  // namespace
+
 std::vector<std::pair<double, double>>
 ProbabilityAnalyzerBase::CalculateProbabilityOverTime() noexcept {
   std::vector<std::pair<double, double>> p_time;
@@ -202,17 +325,46 @@ ProbabilityAnalyzerBase::CalculateProbabilityOverTime() noexcept {
          ProbabilityAnalysis::mission_time().value());
   double total_time = ProbabilityAnalysis::mission_time().value();
 
-  auto update = [this, &p_time](double time) {
-    mission_time().value(time);
-    auto it_p = p_vars_.begin();
-    for (const mef::BasicEvent* event : graph_->basic_events())
-      *it_p++ = event->p();
-    p_time.emplace_back(this->CalculateTotalProbability(p_vars_), time);
+  std::vector<double> times;
+  for (double time = 0; time < total_time; time += time_step)
+    times.push_back(time);
+  times.push_back(total_time);  // Handle cases when not divisible by step.
+
+  // Only the time-dependent probabilities are re-evaluated.
+  std::vector<mef::Expression*> expressions;
+  expressions.reserve(graph_->basic_events().size());
+  for (const mef::BasicEvent* event : graph_->basic_events())
+    expressions.push_back(&event->expression());
+  mef::ExpressionTape tape(expressions, &mission_time(),
+                           ProbabilityBatch::kSize);
+
+  // The time points are evaluated in batches.
+  ProbabilityBatch batch(p_vars_);
+  auto evaluate = [this, &expressions, &tape, &batch, &p_time](
+                      const std::vector<double>& points) {
+    for (int first = 0; first < points.size();
+         first += ProbabilityBatch::kSize) {
+      int num_lanes =
+          std::min<int>(points.size() - first, ProbabilityBatch::kSize);
+      tape.Evaluate(&points[first], num_lanes);
+      for (int i = 0; i < expressions.size(); ++i) {
+        if (const double* lanes = tape.lanes(i))
+          std::copy_n(lanes, num_lanes,
+                      batch.lanes(Pdag::kVariableStartIndex + i));
+      }
+      ProbabilityBatch::Results results =
+          this->CalculateTotalProbabilities(batch);
+      for (int lane = 0; lane < num_lanes; ++lane)
+        p_time.emplace_back(results[lane], points[first + lane]);
+    }
   };
+  evaluate(times);
 
-  for (double time = 0; time < total_time; time += time_step)
-    update(time);
-  update(total_time);  // Handle cases when total_time is not divisible by step.
+  if (double tolerance = Analysis::settings().time_tolerance()) {
+    RefineProbabilityOverTime(tolerance, evaluate, &p_time);
+    LOG(DEBUG4) << "Refined the time steps: " << times.size() << " -> "
+                << p_time.size() << " points";
+  }
   return p_time;
 }
 
@@ -223,6 +375,9 @@ ProbabilityAnalyzer<Bdd>::ProbabilityAnalyzer(FaultTreeAnalyzer<Bdd>* fta,
   bdd_graph_ = fta->algorithm();
   const Bdd::VertexPtr& root = bdd_graph_->root().vertex;
   current_mark_ = root->terminal() ? false : Ite::Ref(root).mark();
+  std::unordered_map<int, int> positions;
+  LayOutVertex(root, &positions);
+  PrepareBatches();
 }
 
 ProbabilityAnalyzer<Bdd>::~ProbabilityAnalyzer() noexcept {
@@ -243,6 +398,104 @@ double ProbabilityAnalyzer<Bdd>::CalculateTotalProbability(
   return prob;
 }
 
+ProbabilityBatch::Results
+ProbabilityAnalyzer<Bdd>::CalculateTotalProbabilities(
+    const ProbabilityBatch& batch) const noexcept {
+  constexpr int kSize = ProbabilityBatch::kSize;
+  ProbabilityBatch::Results results;
+  const Bdd::Function& root = bdd_graph_->root();
+  if (root.vertex->terminal()) {
+    results.fill(root.complement ? 0 : 1);
+    return results;
+  }
+  std::vector<double> values(varying_vertices_.size() * kSize);
+  auto lanes = [this, &values](int position) {
+    return position < 0 ? &constant_values_[~position * kSize]
+                        : &values[position * kSize];
+  };
+  for (int i = 0; i < varying_vertices_.size(); ++i) {
+    const BatchVertex& vertex = varying_vertices_[i];
+    const double* p_var =
+        vertex.module ? lanes(vertex.index) : batch.lanes(vertex.index);
+    const double* high = lanes(vertex.high);
+    const double* low = lanes(vertex.low);
+    double* result = &values[i * kSize];
+    // Complements are applied as (shift + sign * value) across the lanes.
+    double p_shift = vertex.module_complement;
+    double p_sign = vertex.module_complement ? -1 : 1;
+    double low_shift = vertex.complement_edge;
+    double low_sign = vertex.complement_edge ? -1 : 1;
+    for (int lane = 0; lane < kSize; ++lane) {  // This should get vectorized.
+      double p = p_shift + p_sign * p_var[lane];
+      double p_low = low_shift + low_sign * low[lane];
+      result[lane] = p * high[lane] + (1 - p) * p_low;
+    }
+  }
+  const double* top = lanes(batch_root_);
+  for (int lane = 0; lane < kSize; ++lane)
+    results[lane] = root.complement ? 1 - top[lane] : top[lane];
+  return results;
+}
+
+void ProbabilityAnalyzer<Bdd>::PrepareBatches(
+    const std::vector<int>& variables) noexcept {
+  std::vector<bool> varying(Pdag::kVariableStartIndex + p_vars().size());
+  for (int index : variables)
+    varying[index] = true;
+  CompileBatches(varying);
+}
+
+void ProbabilityAnalyzer<Bdd>::PrepareBatches() noexcept {
+  CompileBatches(
+      std::vector<bool>(Pdag::kVariableStartIndex + p_vars().size(), true));
+}
+
+void ProbabilityAnalyzer<Bdd>::CompileBatches(
+    const std::vector<bool>& varying) noexcept {
+  constexpr int kSize = ProbabilityBatch::kSize;
+  // The results of the vertices with the analysis probabilities.
+  std::vector<double> p_vertices(batch_vertices_.size() + 1);
+  p_vertices[0] = 1;  // The terminal vertex.
+  // The positions of the vertex results for batch calculations.
+  std::vector<int> positions(batch_vertices_.size() + 1);
+  positions[0] = ~0;
+  varying_vertices_.clear();
+  for (int i = 0; i < batch_vertices_.size(); ++i) {
+    BatchVertex vertex = batch_vertices_[i];
+    double p_var =
+        vertex.module ? p_vertices[vertex.index] : p_vars()[vertex.index];
+    if (vertex.module_complement)
+      p_var = 1 - p_var;
+    double p_low = p_vertices[vertex.low];
+    if (vertex.complement_edge)
+      p_low = 1 - p_low;
+    p_vertices[i + 1] = p_var * p_vertices[vertex.high] + (1 - p_var) * p_low;
+
+    bool varying_vertex = positions[vertex.high] >= 0 ||
+                          positions[vertex.low] >= 0 ||
+                          (vertex.module ? positions[vertex.index] >= 0
+                                         : varying[vertex.index]);
+    if (!varying_vertex) {
+      positions[i + 1] = ~(i + 1);
+      continue;
+    }
+    if (vertex.module)
+      vertex.index = positions[vertex.index];
+    vertex.high = positions[vertex.high];
+    vertex.low = positions[vertex.low];
+    positions[i + 1] = varying_vertices_.size();
+    varying_vertices_.push_back(vertex);
+  }
+  batch_root_ = positions.back();
+
+  constant_values_.resize(p_vertices.size() * kSize);
+  auto it = constant_values_.begin();
+  for (double p : p_vertices)
+    it = std::fill_n(it, kSize, p);
+  LOG(DEBUG4) << "Prepared " << varying_vertices_.size() << " of "
+              << batch_vertices_.size() << " BDD vertices for batches";
+}
+
 void ProbabilityAnalyzer<Bdd>::CreateBdd(
     const FaultTreeAnalysis& fta) noexcept {
   CLOCK(total_time);
@@ -253,13 +506,16 @@ void ProbabilityAnalyzer<Bdd>::CreateBdd(
 
   CLOCK(prep_time);  // Overall preprocessing time.
   LOG(DEBUG2) << "Preprocessing...";
-  CustomPreprocessor<Bdd>{&graph}();
+  CustomPreprocessor<Bdd>{&graph, Analysis::settings()}();
   LOG(DEBUG2) << "Finished preprocessing in " << DUR(prep_time);
 
   CLOCK(bdd_time);  // BDD based calculation time.
   LOG(DEBUG2) << "Creating BDD for Probability Analysis...";
   bdd_graph_ = new Bdd(&graph, Analysis::settings());
   LOG(DEBUG2) << "BDD is created in " << DUR(bdd_time);
+  std::unordered_map<int, int> positions;
+  LayOutVertex(bdd_graph_->root().vertex, &positions);
+  PrepareBatches();
 
   Analysis::AddAnalysisTime(DUR(total_time));
 }
@@ -290,4 +546,27 @@ double ProbabilityAnalyzer<Bdd>::CalculateProbability(
   return ite.p();
 }
 
+int ProbabilityAnalyzer<Bdd>::LayOutVertex(
+    const Bdd::VertexPtr& vertex,
+    std::unordered_map<int, int>* positions) noexcept {
+  if (vertex->terminal())
+    return 0;
+  if (auto it = positions->find(vertex->id()); it != positions->end())
+    return it->second;
+  const Ite& ite = Ite::Ref(vertex);
+  BatchVertex batch_vertex{ite.index(), 0, 0, ite.module(), false,
+                           ite.complement_edge()};
+  if (ite.module()) {
+    const Bdd::Function& res = bdd_graph_->modules().find(ite.index())->second;
+    batch_vertex.index = LayOutVertex(res.vertex, positions);
+    batch_vertex.module_complement = res.complement;
+  }
+  batch_vertex.high = LayOutVertex(ite.high(), positions);
+  batch_vertex.low = LayOutVertex(ite.low(), positions);
+  batch_vertices_.push_back(batch_vertex);
+  int position = batch_vertices_.size();
+  positions->emplace(vertex->id(), position);
+  return position;
+}
+
 }  // namespace scram::core
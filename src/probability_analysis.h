@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <array>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -89,6 +91,15 @@ class ProbabilityAnalysis : public Analysis {
     return p_time_;
   }
 
+  /// @returns The probabilities of the analysis variables
+  ///          at the mission time of the analysis.
+  ///          The products, importance factors, and reports
+  ///          share these values instead of evaluating event expressions.
+  ///
+  /// @note The values are taken once per analysis;
+  ///       the mission time and parameters are fixed for the analysis.
+  virtual const Pdag::IndexMap<double>& p_vars() const = 0;
+
   /// @returns The Safety Integrity Level calculation results.
   ///
   /// @pre The analysis is done with a request for the SIL.
@@ -122,6 +133,51 @@ class ProbabilityAnalysis : public Analysis {
   std::unique_ptr<Sil> sil_;  ///< The Safety Integrity Level results.
 };
 
+/// Probabilities of variables for a batch of calculations
+/// in the structure-of-arrays layout.
+/// The values of a variable for all lanes of the batch are contiguous,
+/// so calculations can run across the lanes with SIMD instructions.
+class ProbabilityBatch {
+ public:
+  static constexpr int kSize = 8;  ///< The number of lanes in a batch.
+  /// The results of calculations per lane.
+  using Results = std::array<double, kSize>;
+
+  /// Initializes all the lanes with the same probabilities.
+  ///
+  /// @param[in] p_vars  Probabilities of variables mapped by their indices.
+  explicit ProbabilityBatch(const Pdag::IndexMap<double>& p_vars);
+
+  /// @returns The number of variables in the batch.
+  int num_variables() const { return values_.size() / kSize; }
+
+  /// @returns The lanes of all variables in the order of their indices.
+  const double* data() const { return values_.data(); }
+
+  /// @param[in] index  The index of a variable.
+  ///
+  /// @returns The contiguous lanes of values of the variable.
+  /// @{
+  double* lanes(int index) {
+    return &values_[(index - Pdag::kVariableStartIndex) * kSize];
+  }
+  const double* lanes(int index) const {
+    return &values_[(index - Pdag::kVariableStartIndex) * kSize];
+  }
+  /// @}
+
+  /// Copies the probabilities of variables from a single lane.
+  ///
+  /// @param[in] lane  The lane of the batch.
+  /// @param[out] p_vars  Probabilities of variables mapped by their indices.
+  ///
+  /// @pre The number of variables matches the batch.
+  void Gather(int lane, Pdag::IndexMap<double>* p_vars) const noexcept;
+
+ private:
+  std::vector<double> values_;  ///< The lanes of variables in order.
+};
+
 /// Quantitative calculator of a probability value of a single cut set.
 class CutSetProbabilityCalculator {
  public:
@@ -139,17 +195,19 @@ class CutSetProbabilityCalculator {
   /// @pre Probability values are non-negative.
   /// @pre Indices of events directly map to vector indices.
   double Calculate(const std::vector<int>& cut_set,
-                   const Pdag::IndexMap<double>& p_vars) noexcept;
+                   const Pdag::IndexMap<double>& p_vars) const noexcept;
 };
 
 class Zbdd;  // The container of analysis products for computations.
 
 /// Quantitative calculator of probability values
 /// with the Rare-Event approximation.
-class RareEventCalculator : private CutSetProbabilityCalculator {
+class RareEventCalculator {
  public:
   /// Calculates probabilities
   /// using the Rare-Event approximation.
+  /// The sum is calculated directly on the ZBDD graph
+  /// without enumeration of the products.
   ///
   /// @param[in] cut_sets  A collection of sets of indices of basic events.
   /// @param[in] p_vars  Probabilities of events mapped by the variable indices.
@@ -161,7 +219,18 @@ class RareEventCalculator : private CutSetProbabilityCalculator {
   ///       It is very unwise to use the rare-event approximation
   ///       with large probability values.
   double Calculate(const Zbdd& cut_sets,
-                   const Pdag::IndexMap<double>& p_vars) noexcept;
+                   const Pdag::IndexMap<double>& p_vars) const noexcept;
+
+  /// Calculates probabilities for a batch of variable probability sets
+  /// in a single traversal of the ZBDD graph.
+  ///
+  /// @param[in] cut_sets  A collection of sets of indices of basic events.
+  /// @param[in] batch  The probabilities of the variables in lanes.
+  ///
+  /// @returns The total probability with the rare-event approximation
+  ///          for each lane of the batch.
+  ProbabilityBatch::Results Calculate(
+      const Zbdd& cut_sets, const ProbabilityBatch& batch) const noexcept;
 };
 
 /// Quantitative calculator of probability values
@@ -176,7 +245,18 @@ class McubCalculator : private CutSetProbabilityCalculator {
   ///
   /// @returns The total probability with the MCUB approximation.
   double Calculate(const Zbdd& cut_sets,
-                   const Pdag::IndexMap<double>& p_vars) noexcept;
+                   const Pdag::IndexMap<double>& p_vars) const noexcept;
+
+  /// Calculates probabilities for a batch of variable probability sets
+  /// in a single iteration over the products.
+  ///
+  /// @param[in] cut_sets  A collection of sets of indices of basic events.
+  /// @param[in] batch  The probabilities of the variables in lanes.
+  ///
+  /// @returns The total probability with the MCUB approximation
+  ///          for each lane of the batch.
+  ProbabilityBatch::Results Calculate(
+      const Zbdd& cut_sets, const ProbabilityBatch& batch) const noexcept;
 };
 
 /// Base class for Probability analyzers.
@@ -203,7 +283,32 @@ class ProbabilityAnalyzerBase : public ProbabilityAnalysis {
   const Zbdd& products() const { return products_; }
 
   /// @returns A mapping for probability values with indices.
-  const Pdag::IndexMap<double>& p_vars() const { return p_vars_; }
+  const Pdag::IndexMap<double>& p_vars() const override { return p_vars_; }
+
+  /// Calculates the total probabilities
+  /// for a batch of variable probability sets.
+  /// The calculation does not change the analyzer,
+  /// so it is safe to run concurrently.
+  ///
+  /// @param[in] batch  The probabilities of the graph variables in lanes.
+  ///
+  /// @returns The total probability for each lane of the batch.
+  virtual ProbabilityBatch::Results CalculateTotalProbabilities(
+      const ProbabilityBatch& batch) const noexcept = 0;
+
+  /// Prepares the batch calculations
+  /// for changes in the probabilities of the given variables only.
+  /// The other variables keep their analysis probabilities in all batches,
+  /// so the analyzer may cache the results independent of the variables.
+  /// The default preparation is for changes in all the variables.
+  ///
+  /// @param[in] variables  The indices of the varying variables.
+  ///
+  /// @pre No concurrent batch calculations are in progress.
+  /// @{
+  virtual void PrepareBatches(const std::vector<int>& /*variables*/) noexcept {}
+  virtual void PrepareBatches() noexcept {}
+  /// @}
 
  protected:
   ~ProbabilityAnalyzerBase() override = default;
@@ -257,6 +362,11 @@ class ProbabilityAnalyzer : public ProbabilityAnalyzerBase {
     return calc_.Calculate(ProbabilityAnalyzerBase::products(), p_vars);
   }
 
+  ProbabilityBatch::Results CalculateTotalProbabilities(
+      const ProbabilityBatch& batch) const noexcept final {
+    return calc_.Calculate(ProbabilityAnalyzerBase::products(), batch);
+  }
+
  private:
   Calculator calc_;  ///< Provider of the calculation logic.
 };
@@ -302,6 +412,21 @@ class ProbabilityAnalyzer<Bdd> : public ProbabilityAnalyzerBase {
   double CalculateTotalProbability(
       const Pdag::IndexMap<double>& p_vars) noexcept final;
 
+  /// Evaluates the batch in a single pass
+  /// over the BDD vertices in topological order
+  /// without marking or updating the shared BDD vertices.
+  /// Only the vertices depending on the varying variables are evaluated.
+  ProbabilityBatch::Results CalculateTotalProbabilities(
+      const ProbabilityBatch& batch) const noexcept final;
+
+  /// Finds the vertices (including module graphs)
+  /// depending on the varying variables
+  /// and caches the probabilities of the rest of the vertices.
+  void PrepareBatches(const std::vector<int>& variables) noexcept final;
+
+  /// Prepares all the vertices for evaluation in batches.
+  void PrepareBatches() noexcept final;
+
  private:
   /// Creates a new BDD for use by the analyzer.
   ///
@@ -325,7 +450,43 @@ class ProbabilityAnalyzer<Bdd> : public ProbabilityAnalyzerBase {
   double CalculateProbability(const Bdd::VertexPtr& vertex, bool mark,
                               const Pdag::IndexMap<double>& p_vars) noexcept;
 
+  /// Lays out BDD vertices with modules in topological order
+  /// for batch calculations.
+  ///
+  /// @param[in] vertex  The root vertex of a function graph.
+  /// @param[in,out] positions  The positions of the laid out vertices.
+  ///
+  /// @returns The position of the vertex results.
+  int LayOutVertex(const Bdd::VertexPtr& vertex,
+                   std::unordered_map<int, int>* positions) noexcept;
+
+  /// BDD vertex data for batch calculations.
+  /// The position 0 is reserved for the terminal vertex.
+  struct BatchVertex {
+    int index;  ///< The variable index or the position of the module result.
+    int high;  ///< The position of the high vertex results.
+    int low;  ///< The position of the low vertex results.
+    bool module;  ///< Indication of a module instead of a variable.
+    bool module_complement;  ///< The complement of the module function.
+    bool complement_edge;  ///< The complement of the low edge.
+  };
+
+  /// Selects the vertices to evaluate in batches
+  /// and caches the results of the other vertices.
+  ///
+  /// @param[in] varying  The indication of varying variables by index.
+  void CompileBatches(const std::vector<bool>& varying) noexcept;
+
   Bdd* bdd_graph_;  ///< The main BDD graph for analysis.
+  /// The vertices of the BDD in topological order for batch calculations.
+  std::vector<BatchVertex> batch_vertices_;
+  /// The varying vertices to evaluate in batches in topological order.
+  /// Their positions refer to the results of the varying vertices by order
+  /// or, if negative, to the constant results of the vertex ~position.
+  std::vector<BatchVertex> varying_vertices_;
+  /// The lanes with the cached results of the vertices by position.
+  std::vector<double> constant_values_;
+  int batch_root_ = ~0;  ///< The position of the root results.
   bool current_mark_;  ///< To keep track of BDD current mark.
   bool owner_;  ///< Indication that pointers are handles.
 };
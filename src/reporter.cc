@@ -23,6 +23,9 @@
 #include <ctime>
 
 #include <memory>
+#include <optional>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -66,6 +69,52 @@ void PutId(const core::RiskAnalysis::Result::Id& id,
   }
 }
 
+/// Puts a JSON string literal into the stream.
+///
+/// @param[in] value  The string value.
+/// @param[out] out  The destination stream.
+void PutJsonString(std::string_view value, std::FILE* out) {
+  std::fputc('"', out);
+  for (char symbol : value) {
+    if (symbol == '"' || symbol == '\\') {
+      std::fputc('\\', out);
+      std::fputc(symbol, out);
+    } else if (static_cast<unsigned char>(symbol) < 0x20) {
+      std::fprintf(out, "\\u%04x", symbol);
+    } else {
+      std::fputc(symbol, out);
+    }
+  }
+  std::fputc('"', out);
+}
+
+/// Puts analysis id members into a JSON object.
+///
+/// @param[in] id  The analysis id.
+/// @param[out] out  The destination stream.
+void PutJsonId(const core::RiskAnalysis::Result::Id& id, std::FILE* out) {
+  auto put_member = [out](const char* key, std::string_view value) {
+    std::fprintf(out, "\"%s\": ", key);
+    PutJsonString(value, out);
+    std::fputs(", ", out);
+  };
+  std::visit(
+      [&put_member](const auto& target) {
+        using T = std::decay_t<decltype(target)>;
+        if constexpr (std::is_same_v<T, const mef::Gate*>) {
+          put_member("name", target->id());
+        } else {
+          put_member("initiating-event", target.first.name());
+          put_member("name", target.second.name());
+        }
+      },
+      id.target);
+  if (id.context) {
+    put_member("alignment", id.context->alignment.name());
+    put_member("phase", id.context->phase.name());
+  }
+}
+
 }  // namespace
 
 void Reporter::Report(const core::RiskAnalysis& risk_an, std::FILE* out,
@@ -117,6 +166,55 @@ void Reporter::Report(const core::RiskAnalysis& risk_an,
   }
 }
 
+void Reporter::ReportPreprocessing(const core::RiskAnalysis& risk_an,
+                                   std::FILE* out) {
+  std::fputs("{\"analyses\": [", out);
+  bool first_analysis = true;
+  for (const core::RiskAnalysis::Result& result : risk_an.results()) {
+    if (!result.fault_tree_analysis)
+      continue;
+    std::fputs(first_analysis ? "\n  {" : ",\n  {", out);
+    first_analysis = false;
+    PutJsonId(result.id, out);
+    std::fputs("\"passes\": [", out);
+    bool first_pass = true;
+    for (const core::PassProfile& pass :
+         result.fault_tree_analysis->preprocessor_profile()) {
+      std::fputs(first_pass ? "\n    {" : ",\n    {", out);
+      first_pass = false;
+      std::fputs("\"name\": ", out);
+      PutJsonString(pass.name, out);
+      std::fprintf(out,
+                   ", \"phase\": %d, \"time\": %.9g"
+                   ", \"gates\": [%d, %d], \"variables\": [%d, %d]"
+                   ", \"changes\": %lld}",
+                   pass.phase, pass.time, pass.gates_before, pass.gates_after,
+                   pass.variables_before, pass.variables_after,
+                   static_cast<long long>(pass.changes));
+    }
+    std::fputs(first_pass ? "]}" : "\n  ]}", out);
+  }
+  std::fputs(first_analysis ? "]}\n" : "\n]}\n", out);
+  if (std::ferror(out))
+    SCRAM_THROW(IOError("Failed to write the preprocessing profile."));
+}
+
+void Reporter::ReportPreprocessing(const core::RiskAnalysis& risk_an,
+                                   const std::string& file) {
+  std::unique_ptr<std::FILE, decltype(&std::fclose)> fp(
+      std::fopen(file.c_str(), "w"), &std::fclose);
+  try {
+    if (!fp) {
+      SCRAM_THROW(IOError("Cannot open the output file for the profile."))
+          << boost::errinfo_errno(errno) << boost::errinfo_file_open_mode("w");
+    }
+    ReportPreprocessing(risk_an, fp.get());
+  } catch (IOError& err) {
+    err << boost::errinfo_file_name(file);
+    throw;
+  }
+}
+
 /// Describes the fault tree analysis and techniques.
 template <>
 void Reporter::ReportCalculatedQuantity<core::FaultTreeAnalysis>(
@@ -139,9 +237,10 @@ void Reporter::ReportCalculatedQuantity<core::FaultTreeAnalysis>(
       case core::Algorithm::kMocus:
         methods.SetAttribute("name", "MOCUS");
     }
-    methods.AddChild("limits")
-        .AddChild("product-order")
-        .AddText(settings.limit_order());
+    xml::StreamElement limits = methods.AddChild("limits");
+    limits.AddChild("product-order").AddText(settings.limit_order());
+    if (settings.probability_analysis() && settings.cut_off())
+      limits.AddChild("cut-off").AddText(settings.cut_off());
   }
   if (settings.ccf_analysis()) {
     information->AddChild("calculated-quantity")
@@ -177,8 +276,11 @@ void Reporter::ReportCalculatedQuantity<core::ProbabilityAnalysis>(
   }
   xml::StreamElement limits = methods.AddChild("limits");
   limits.AddChild("mission-time").AddText(settings.mission_time());
-  if (settings.time_step())
+  if (settings.time_step()) {
     limits.AddChild("time-step").AddText(settings.time_step());
+    if (settings.time_tolerance())
+      limits.AddChild("time-tolerance").AddText(settings.time_tolerance());
+  }
 }
 
 /// Describes the importance analysis and techniques.
@@ -202,9 +304,23 @@ void Reporter::ReportCalculatedQuantity<core::UncertaintyAnalysis>(
                     "Calculation of uncertainties with the Monte Carlo method");
 
   xml::StreamElement methods = quant.AddChild("calculation-method");
-  methods.SetAttribute("name", "Monte Carlo");
+  switch (settings.sampling()) {
+    case core::Sampling::kMonteCarlo:
+      methods.SetAttribute("name", "Monte Carlo");
+      break;
+    case core::Sampling::kLatinHypercube:
+      methods.SetAttribute("name", "Latin Hypercube Sampling");
+      break;
+    case core::Sampling::kSobol:
+      methods.SetAttribute("name", "Scrambled Sobol Sequence");
+      break;
+  }
   xml::StreamElement limits = methods.AddChild("limits");
   limits.AddChild("number-of-trials").AddText(settings.num_trials());
+  if (settings.mean_error())
+    limits.AddChild("mean-error").AddText(settings.mean_error());
+  if (settings.quantile_error())
+    limits.AddChild("quantile-error").AddText(settings.quantile_error());
   if (settings.seed() >= 0) {
     limits.AddChild("seed").AddText(settings.seed());
   }
@@ -319,9 +435,33 @@ void Reporter::ReportPerformance(const core::RiskAnalysis& risk_an,
   for (const core::RiskAnalysis::Result& result : risk_an.results()) {
     xml::StreamElement calc_time = performance.AddChild("calculation-time");
     scram::PutId(result.id, &calc_time);
-    if (result.fault_tree_analysis)
+    if (result.fault_tree_analysis) {
       calc_time.AddChild("products")
           .AddText(result.fault_tree_analysis->analysis_time());
+      if (std::optional<core::CacheStatistics> statistics =
+              result.fault_tree_analysis->cache_statistics()) {
+        calc_time.AddChild("apply-cache")
+            .SetAttribute("hits", statistics->hits)
+            .SetAttribute("misses", statistics->misses)
+            .SetAttribute("evictions", statistics->evictions);
+      }
+      const std::vector<core::PassProfile>& profile =
+          result.fault_tree_analysis->preprocessor_profile();
+      if (!profile.empty()) {
+        xml::StreamElement preprocessing = calc_time.AddChild("preprocessing");
+        for (const core::PassProfile& pass : profile) {
+          preprocessing.AddChild("pass")
+              .SetAttribute("name", pass.name)
+              .SetAttribute("phase", pass.phase)
+              .SetAttribute("gates-before", pass.gates_before)
+              .SetAttribute("gates-after", pass.gates_after)
+              .SetAttribute("variables-before", pass.variables_before)
+              .SetAttribute("variables-after", pass.variables_after)
+              .SetAttribute("changes", static_cast<std::size_t>(pass.changes))
+              .AddText(pass.time);
+        }
+      }
+    }
 
     if (result.probability_analysis)
       calc_time.AddChild("probability")
@@ -391,8 +531,13 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
       .SetAttribute("basic-events", fta.products().product_events().size())
       .SetAttribute("products", fta.products().size());
 
-  if (prob_analysis)
+  if (prob_analysis) {
     sum_of_products.SetAttribute("probability", prob_analysis->p_total());
+    if (fta.settings().cut_off()) {
+      sum_of_products.SetAttribute("truncation-error",
+                                   fta.products().truncation_error());
+    }
+  }
 
   if (fta.products().empty() == false) {
     sum_of_products.SetAttribute(
@@ -403,16 +548,20 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
                     " "));
   }
 
+  // The probabilities of products come from the analysis snapshot
+  // instead of the re-evaluation of event expressions per literal.
+  const core::Pdag::IndexMap<double>* p_vars =
+      prob_analysis ? &prob_analysis->p_vars() : nullptr;
   double sum = 0;  // Sum of probabilities for contribution calculations.
-  if (prob_analysis) {
+  if (p_vars) {
     for (const core::Product& product_set : fta.products())
-      sum += product_set.p();
+      sum += product_set.p(*p_vars);
   }
   for (const core::Product& product_set : fta.products()) {
     xml::StreamElement product = sum_of_products.AddChild("product");
     product.SetAttribute("order", product_set.order());
-    if (prob_analysis) {
-      double prob = product_set.p();
+    if (p_vars) {
+      double prob = product_set.p(*p_vars);
       product.SetAttribute("probability", prob);
       if (sum != 0)
         product.SetAttribute("contribution", prob / sum);
@@ -480,9 +629,9 @@ void Reporter::ReportResults(
   for (const core::ImportanceRecord& entry : importance_analysis.importance()) {
     const core::ImportanceFactors& factors = entry.factors;
     const mef::BasicEvent& event = entry.event;
-    auto add_data = [&event, &factors](xml::StreamElement* element) {
+    auto add_data = [&entry, &factors](xml::StreamElement* element) {
       element->SetAttribute("occurrence", factors.occurrence)
-          .SetAttribute("probability", event.p())
+          .SetAttribute("probability", entry.p)
           .SetAttribute("MIF", factors.mif)
           .SetAttribute("CIF", factors.cif)
           .SetAttribute("DIF", factors.dif)
@@ -501,6 +650,7 @@ void Reporter::ReportResults(const core::RiskAnalysis::Result::Id& id,
   if (!uncert_analysis.warnings().empty()) {
     measure.SetAttribute("warning", uncert_analysis.warnings());
   }
+  measure.SetAttribute("trials", uncert_analysis.num_trials());
   measure.AddChild("mean").SetAttribute("value", uncert_analysis.mean());
   measure.AddChild("standard-deviation")
       .SetAttribute("value", uncert_analysis.sigma());
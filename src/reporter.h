@@ -65,6 +65,26 @@ class Reporter {
   void Report(const core::RiskAnalysis& risk_an, const std::string& file,
               bool indent = true);
 
+  /// Reports the profiles of the preprocessing passes
+  /// of fault tree analyses as a JSON document.
+  ///
+  /// @param[in] risk_an  Risk analysis with results.
+  /// @param[out] out  The report destination stream.
+  ///
+  /// @throws IOError  The write operation has failed.
+  void ReportPreprocessing(const core::RiskAnalysis& risk_an, std::FILE* out);
+
+  /// A convenience function to report the preprocessing profiles into a file.
+  /// This function overwrites the file.
+  ///
+  /// @param[in] risk_an  Risk analysis with results.
+  /// @param[out] file  The output destination.
+  ///
+  /// @throws IOError  The output file is not accessible,
+  ///                  or the write operation has failed.
+  void ReportPreprocessing(const core::RiskAnalysis& risk_an,
+                           const std::string& file);
+
  private:
   /// This function populates information
   /// about the software, settings, time, methods, model, etc.
@@ -20,6 +20,9 @@
 
 #include "risk_analysis.h"
 
+#include <atomic>
+#include <thread>
+
 #include "bdd.h"
 #include "expression/random_deviate.h"
 #include "ext/scope_guard.h"
@@ -81,6 +84,8 @@ void RiskAnalysis::RunAnalysis(std::optional<Context> context) noexcept {
     }
   }
 
+  // The sequence gates of event trees are collected before the analyses.
+  std::vector<Target> targets;
   for (const mef::InitiatingEvent& initiating_event :
        model_->initiating_events()) {
     if (initiating_event.event_tree()) {
@@ -89,20 +94,11 @@ void RiskAnalysis::RunAnalysis(std::optional<Context> context) noexcept {
           initiating_event, Analysis::settings(), model_->context());
       eta->Analyze();
       for (EventTreeAnalysis::Result& result : eta->sequences()) {
-        const mef::Sequence& sequence = result.sequence;
-        LOG(INFO) << "Running analysis for sequence: " << sequence.name();
         results_.push_back(
             {{std::pair<const mef::InitiatingEvent&, const mef::Sequence&>{
-                  initiating_event, sequence},
+                  initiating_event, result.sequence},
               context}});
-        RunAnalysis(*result.gate, &results_.back());
-        if (result.is_expression_only) {
-          results_.back().fault_tree_analysis = nullptr;
-          results_.back().importance_analysis = nullptr;
-        }
-        if (Analysis::settings().probability_analysis())
-          result.p_sequence = results_.back().probability_analysis->p_total();
-        LOG(INFO) << "Finished analysis for sequence: " << sequence.name();
+        targets.push_back({result.gate.get(), &result});
       }
       event_tree_results_.push_back(
           {initiating_event, context, std::move(eta)});
@@ -112,45 +108,119 @@ void RiskAnalysis::RunAnalysis(std::optional<Context> context) noexcept {
 
   for (const mef::FaultTree& ft : model_->fault_trees()) {
     for (const mef::Gate* target : ft.top_events()) {
-      LOG(INFO) << "Running analysis for gate: " << target->id();
       results_.push_back({{target, context}});
-      RunAnalysis(*target, &results_.back());
-      LOG(INFO) << "Finished analysis for gate: " << target->id();
+      targets.push_back({target, nullptr});
+    }
+  }
+
+  RunAnalyses(targets, results_.size() - targets.size());
+
+  for (int i = 0; i < targets.size(); ++i) {
+    EventTreeAnalysis::Result* sequence = targets[i].sequence;
+    if (!sequence)
+      continue;
+    Result& result = results_[results_.size() - targets.size() + i];
+    if (sequence->is_expression_only) {
+      result.fault_tree_analysis = nullptr;
+      result.importance_analysis = nullptr;
     }
+    if (Analysis::settings().probability_analysis())
+      sequence->p_sequence = result.probability_analysis->p_total();
+  }
+}
+
+void RiskAnalysis::RunAnalyses(const std::vector<Target>& targets,
+                               int first_result) noexcept {
+  auto run_target = [this, &targets, first_result](
+                        int i, const Settings& settings,
+                        std::function<void()>* quantitative) {
+    const Target& target = targets[i];
+    std::string name = target.sequence
+                           ? "sequence: " + target.sequence->sequence.name()
+                           : "gate: " + target.gate->id();
+    LOG(INFO) << "Running analysis for " << name;
+    RunAnalysis(*target.gate, settings, &results_[first_result + i],
+                quantitative);
+    LOG(INFO) << "Finished analysis for " << name;
+  };
+
+  int num_jobs = std::min<int>(Analysis::settings().num_jobs(), targets.size());
+  // Monte Carlo simulations run in parallel jobs on their own;
+  // besides, the sampling of expressions is shared by all the targets.
+  if (num_jobs < 2 || Analysis::settings().uncertainty_analysis()) {
+    for (int i = 0; i < targets.size(); ++i)
+      run_target(i, Analysis::settings(), nullptr);
+    return;
+  }
+
+  LOG(DEBUG1) << "Analyzing " << targets.size() << " targets in " << num_jobs
+              << " jobs...";
+  // Each target gets a single thread.
+  Settings settings = Analysis::settings();
+  settings.num_jobs(1);
+  // The analysis over time changes the mission time of the shared model,
+  // so the quantitative analyses are run in order by the calling thread.
+  bool defer = settings.time_step() != 0;
+  std::vector<std::function<void()>> quantitative(targets.size());
+  std::atomic<int> next_target = 0;
+  auto run_job = [&] {
+    for (int i = next_target++; i < targets.size(); i = next_target++)
+      run_target(i, settings, defer ? &quantitative[i] : nullptr);
+  };
+  std::vector<std::thread> jobs;
+  jobs.reserve(num_jobs);
+  for (int i = 0; i < num_jobs; ++i)
+    jobs.emplace_back(run_job);
+  for (std::thread& job : jobs)
+    job.join();
+  for (const std::function<void()>& analysis : quantitative) {
+    if (analysis)
+      analysis();
   }
 }
 
 void RiskAnalysis::RunAnalysis(const mef::Gate& target,
-                               Result* result) noexcept {
-  switch (Analysis::settings().algorithm()) {
+                               const Settings& settings, Result* result,
+                               std::function<void()>* quantitative) noexcept {
+  switch (settings.algorithm()) {
     case Algorithm::kBdd:
-      return RunAnalysis<Bdd>(target, result);
+      return RunAnalysis<Bdd>(target, settings, result, quantitative);
     case Algorithm::kZbdd:
-      return RunAnalysis<Zbdd>(target, result);
+      return RunAnalysis<Zbdd>(target, settings, result, quantitative);
     case Algorithm::kMocus:
-      return RunAnalysis<Mocus>(target, result);
+      return RunAnalysis<Mocus>(target, settings, result, quantitative);
   }
 }
 
 template <class Algorithm>
 void RiskAnalysis::RunAnalysis(const mef::Gate& target,
-                               Result* result) noexcept {
-  auto fta = std::make_unique<FaultTreeAnalyzer<Algorithm>>(
-      target, Analysis::settings(), model_);
+                               const Settings& settings, Result* result,
+                               std::function<void()>* quantitative) noexcept {
+  auto fta =
+      std::make_unique<FaultTreeAnalyzer<Algorithm>>(target, settings, model_);
   fta->Analyze();
-  if (Analysis::settings().probability_analysis()) {
-    switch (Analysis::settings().approximation()) {
+  FaultTreeAnalyzer<Algorithm>* analyzer = fta.get();
+  result->fault_tree_analysis = std::move(fta);
+  if (!settings.probability_analysis())
+    return;
+  auto run_quantitative = [this, analyzer, result,
+                           approximation = settings.approximation()] {
+    switch (approximation) {
       case Approximation::kNone:
-        RunAnalysis<Algorithm, Bdd>(fta.get(), result);
+        RunAnalysis<Algorithm, Bdd>(analyzer, result);
         break;
       case Approximation::kRareEvent:
-        RunAnalysis<Algorithm, RareEventCalculator>(fta.get(), result);
+        RunAnalysis<Algorithm, RareEventCalculator>(analyzer, result);
         break;
       case Approximation::kMcub:
-        RunAnalysis<Algorithm, McubCalculator>(fta.get(), result);
+        RunAnalysis<Algorithm, McubCalculator>(analyzer, result);
     }
+  };
+  if (quantitative) {
+    *quantitative = run_quantitative;
+  } else {
+    run_quantitative();
   }
-  result->fault_tree_analysis = std::move(fta);
 }
 
 template <class Algorithm, class Calculator>
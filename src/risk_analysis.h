@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -111,6 +112,13 @@ class RiskAnalysis : public Analysis {
   }
 
  private:
+  /// The analysis target gate.
+  struct Target {
+    const mef::Gate* gate;  ///< The top gate of the analysis.
+    /// The event-tree sequence of the gate if any.
+    EventTreeAnalysis::Result* sequence;
+  };
+
   /// Runs the whole analysis with the given alignment.
   ///
   /// @param[in] context  The optional context with the current alignment/phase.
@@ -120,22 +128,45 @@ class RiskAnalysis : public Analysis {
   /// @post The model is restored to the original state.
   void RunAnalysis(std::optional<Context> context = {}) noexcept;
 
+  /// Runs the analyses of independent targets
+  /// in parallel jobs if requested by the settings.
+  /// The results are stored in the order of the targets
+  /// regardless of the number of jobs.
+  ///
+  /// @param[in] targets  The analysis targets.
+  /// @param[in] first_result  The position of the first target result.
+  ///
+  /// @pre The result containers for the targets are already in place.
+  void RunAnalyses(const std::vector<Target>& targets,
+                   int first_result) noexcept;
+
   /// Runs all possible analysis on a given target.
   /// Analysis types are deduced from the settings.
   ///
   /// @param[in] target  Analysis target.
+  /// @param[in] settings  The analysis settings for the target.
   /// @param[in,out] result  The result container element.
-  void RunAnalysis(const mef::Gate& target, Result* result) noexcept;
+  /// @param[out] quantitative  The optional holder
+  ///                           for the deferred Quantitative analysis.
+  void RunAnalysis(const mef::Gate& target, const Settings& settings,
+                   Result* result,
+                   std::function<void()>* quantitative = nullptr) noexcept;
 
   /// Defines and runs Qualitative analysis on the target.
-  /// Calls the Quantitative analysis if requested in settings.
+  /// Calls the Quantitative analysis if requested in settings
+  /// unless the Quantitative analysis is deferred.
   ///
   /// @tparam Algorithm  Qualitative analysis algorithm.
   ///
   /// @param[in] target  Analysis target.
+  /// @param[in] settings  The analysis settings for the target.
   /// @param[in,out] result  The result container element.
+  /// @param[out] quantitative  The optional holder
+  ///                           for the deferred Quantitative analysis.
   template <class Algorithm>
-  void RunAnalysis(const mef::Gate& target, Result* result) noexcept;
+  void RunAnalysis(const mef::Gate& target, const Settings& settings,
+                   Result* result,
+                   std::function<void()>* quantitative) noexcept;
 
   /// Defines and runs Quantitative analysis on the target.
   ///
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Implementation of Latin hypercube and Sobol sampling.
+
+#include "sampling.h"
+
+#include <cassert>
+#include <cmath>
+
+#include <algorithm>
+#include <unordered_set>
+
+#include <boost/version.hpp>
+#if BOOST_VERSION >= 107100
+#include <boost/random/sobol.hpp>
+#endif
+
+namespace scram::core {
+
+namespace {
+
+/// Scrambles the bits of the value (SplitMix64 finalizer).
+///
+/// @param[in] value  The value to mix.
+///
+/// @returns The pseudo-random function of the value.
+std::uint64_t Mix(std::uint64_t value) noexcept {
+  value += 0x9e3779b97f4a7c15;
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+  return value ^ (value >> 31);
+}
+
+/// @param[in] bits  The random bits.
+///
+/// @returns The number in (0, 1) from the high 53 bits.
+double ToUnit(std::uint64_t bits) noexcept {
+  return ((bits >> 11) + 0.5) * 0x1p-53;
+}
+
+/// Latin hypercube sampling.
+/// Each dimension is divided into equiprobable strata, one per trial,
+/// and every stratum is sampled exactly once over all the trials.
+/// The strata are assigned to the trials with a keyed pseudo-random
+/// permutation per dimension computed on the fly
+/// instead of permutation tables with memory proportional to the trials.
+class LatinHypercubeSampler final : public UniformSampler {
+ public:
+  /// @param[in] deviates  The random deviates in the order of dimensions.
+  /// @param[in] num_trials  The total number of trials (strata).
+  /// @param[in] seed  The seed for the permutations and jitters.
+  LatinHypercubeSampler(const std::vector<const mef::RandomDeviate*>& deviates,
+                        int num_trials, std::uint64_t seed)
+      : UniformSampler(deviates, seed), num_trials_(num_trials), half_bits_(1) {
+    assert(num_trials_ > 0);
+    while ((std::uint64_t(1) << (2 * half_bits_)) <
+           static_cast<std::uint64_t>(num_trials_)) {
+      ++half_bits_;
+    }
+    for (int i = 0; i < UniformSampler::num_dimensions(); ++i)
+      keys_.push_back(Mix(UniformSampler::seed() ^ Mix(i)));
+  }
+
+ private:
+  void Generate(int trial, double* point) noexcept override {
+    assert(trial < num_trials_);
+    for (int i = 0; i < keys_.size(); ++i) {
+      double jitter = ToUnit(Mix(keys_[i] ^ Mix(~std::uint64_t(trial))));
+      double value = (Permute(trial, keys_[i]) + jitter) / num_trials_;
+      point[i] = value < 1 ? value : std::nextafter(1.0, 0.0);
+    }
+  }
+
+  /// Permutes the trial index into the stratum index
+  /// with a balanced Feistel network over the smallest even-bit domain
+  /// and cycle-walking back into the range of trials.
+  ///
+  /// @param[in] index  The trial index.
+  /// @param[in] key  The permutation key of the dimension.
+  ///
+  /// @returns The stratum of the trial.
+  std::uint64_t Permute(std::uint64_t index, std::uint64_t key) const noexcept {
+    const std::uint64_t mask = (std::uint64_t(1) << half_bits_) - 1;
+    do {
+      std::uint64_t left = index >> half_bits_;
+      std::uint64_t right = index & mask;
+      for (std::uint64_t round = 0; round < 4; ++round) {
+        std::uint64_t next =
+            left ^ (Mix(key ^ Mix(right | (round << 32))) & mask);
+        left = right;
+        right = next;
+      }
+      index = (left << half_bits_) | right;
+    } while (index >= static_cast<std::uint64_t>(num_trials_));
+    return index;
+  }
+
+  int num_trials_;  ///< The number of strata.
+  int half_bits_;  ///< The bits in a half of the permutation domain.
+  std::vector<std::uint64_t> keys_;  ///< The permutation keys of dimensions.
+};
+
+#if BOOST_VERSION >= 107100
+/// Quasi-Monte Carlo sampling with the Sobol sequence
+/// randomized by a digital shift (XOR with random bits) per dimension.
+/// The shift keeps the low-discrepancy of the points
+/// while making the estimates unbiased and independent of the point 0.
+///
+/// The dimensions beyond the Sobol direction number tables
+/// are sampled with independent pseudo-random numbers.
+class SobolSampler final : public UniformSampler {
+ public:
+  /// @param[in] deviates  The random deviates in the order of dimensions.
+  /// @param[in] seed  The seed for the digital shifts.
+  SobolSampler(const std::vector<const mef::RandomDeviate*>& deviates,
+               std::uint64_t seed)
+      : UniformSampler(deviates, seed),
+        generator_(std::clamp<int>(UniformSampler::num_dimensions(), 1,
+                                   kMaxDimension)) {
+    for (int i = 0; i < generator_.dimension(); ++i)
+      shifts_.push_back(Mix(UniformSampler::seed() ^ Mix(i)));
+  }
+
+ private:
+  /// The maximum dimension of the generator.
+  static constexpr int kMaxDimension =
+      boost::random::default_sobol_table::max_dimension;
+
+  void Generate(int trial, double* point) noexcept override {
+    if (trial != position_)
+      generator_.seed(trial);
+    position_ = trial + 1;
+    int num_quasi = std::min<int>(UniformSampler::num_dimensions(),
+                                  generator_.dimension());
+    for (int i = 0; i < generator_.dimension(); ++i) {
+      std::uint64_t bits = generator_() ^ shifts_[i];
+      if (i < num_quasi)
+        point[i] = ToUnit(bits);
+    }
+    for (int i = num_quasi; i < UniformSampler::num_dimensions(); ++i)
+      point[i] = UniformSampler::Scatter(i, trial);
+  }
+
+  boost::random::sobol generator_;  ///< The generator of the sequence.
+  int position_ = 0;  ///< The index of the next point of the generator.
+  std::vector<std::uint64_t> shifts_;  ///< The digital shifts of dimensions.
+};
+#endif
+
+}  // namespace
+
+std::vector<const mef::RandomDeviate*> UniformSampler::GatherDeviates(
+    const std::vector<mef::Expression*>& expressions) {
+  std::vector<const mef::RandomDeviate*> deviates;
+  std::unordered_set<const mef::Expression*> visited;
+  auto gather = [&deviates, &visited](auto& self,
+                                      mef::Expression* expression) -> void {
+    if (!visited.insert(expression).second)
+      return;
+    if (auto* deviate = dynamic_cast<mef::RandomDeviate*>(expression))
+      deviates.push_back(deviate);
+    for (mef::Expression* arg : expression->args())
+      self(self, arg);
+  };
+  for (mef::Expression* expression : expressions)
+    gather(gather, expression);
+  return deviates;
+}
+
+std::unique_ptr<UniformSampler>
+UniformSampler::Create(Sampling sampling,
+                       const std::vector<const mef::RandomDeviate*>& deviates,
+                       int num_trials, std::uint64_t seed) {
+  switch (sampling) {
+    case Sampling::kMonteCarlo:
+      return nullptr;
+    case Sampling::kLatinHypercube:
+      return std::make_unique<LatinHypercubeSampler>(deviates, num_trials,
+                                                     seed);
+    case Sampling::kSobol:
+#if BOOST_VERSION >= 107100
+      return std::make_unique<SobolSampler>(deviates, seed);
+#else
+      break;  // Rejected by the settings.
+#endif
+  }
+  assert(false && "Unsupported sampling strategy.");
+  return nullptr;
+}
+
+UniformSampler::UniformSampler(
+    const std::vector<const mef::RandomDeviate*>& deviates, std::uint64_t seed)
+    : seed_(Mix(seed)), point_(deviates.size()) {
+  for (int i = 0; i < deviates.size(); ++i)
+    dimensions_.emplace(deviates[i], i);
+}
+
+double UniformSampler::Next(const mef::RandomDeviate& deviate) noexcept {
+  auto it = dimensions_.find(&deviate);
+  assert(it != dimensions_.end() && "The deviate is not gathered.");
+  return point_[it->second];
+}
+
+double UniformSampler::Scatter(int dimension, int trial) const noexcept {
+  return ToUnit(Mix(seed_ ^ Mix((std::uint64_t(dimension) << 32) | trial)));
+}
+
+}  // namespace scram::core
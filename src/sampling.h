@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2018 Olzhas Rakhimov
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/// @file
+/// Stratified and low-discrepancy sampling of random deviates.
+
+#pragma once
+
+#include <cstdint>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "expression/random_deviate.h"
+#include "settings.h"
+
+namespace scram::core {
+
+/// Source of uniform numbers with a separate dimension per random deviate.
+/// The numbers of a trial are a point in the unit hypercube
+/// determined by the trial index alone;
+/// therefore, independent jobs can sample disjoint ranges of trials.
+class UniformSampler : public mef::RandomDeviate::UniformSource {
+ public:
+  /// Collects the random deviates sampled with the expressions.
+  ///
+  /// @param[in] expressions  The expressions to be sampled.
+  ///
+  /// @returns The unique random deviates in the order of dimensions.
+  static std::vector<const mef::RandomDeviate*>
+  GatherDeviates(const std::vector<mef::Expression*>& expressions);
+
+  /// Creates the sampler of the given strategy.
+  ///
+  /// @param[in] sampling  The sampling strategy.
+  /// @param[in] deviates  The random deviates in the order of dimensions.
+  /// @param[in] num_trials  The total number of trials.
+  /// @param[in] seed  The seed for randomization of the points.
+  ///
+  /// @returns The sampler for the deviates.
+  /// @returns nullptr for Monte Carlo sampling with the RNG.
+  static std::unique_ptr<UniformSampler>
+  Create(Sampling sampling,
+         const std::vector<const mef::RandomDeviate*>& deviates,
+         int num_trials, std::uint64_t seed);
+
+  /// Positions the sampler before the given trial.
+  ///
+  /// @param[in] trial  The index of the next trial.
+  void Seek(int trial) noexcept { trial_ = trial; }
+
+  void NextTrial() noexcept final { Generate(trial_++, point_.data()); }
+
+  double Next(const mef::RandomDeviate& deviate) noexcept final;
+
+ protected:
+  /// @param[in] deviates  The random deviates in the order of dimensions.
+  /// @param[in] seed  The seed for randomization of the points.
+  UniformSampler(const std::vector<const mef::RandomDeviate*>& deviates,
+                 std::uint64_t seed);
+
+  /// @returns The number of dimensions of the points.
+  int num_dimensions() const { return point_.size(); }
+
+  /// @returns The seed for randomization of the points.
+  std::uint64_t seed() const { return seed_; }
+
+  /// @param[in] dimension  The dimension of the hypercube.
+  /// @param[in] trial  The index of the trial.
+  ///
+  /// @returns A pseudo-random number in (0, 1) unique to the arguments.
+  double Scatter(int dimension, int trial) const noexcept;
+
+ private:
+  /// Generates the point for the trial.
+  ///
+  /// @param[in] trial  The index of the trial.
+  /// @param[out] point  The coordinates in (0, 1) for all dimensions.
+  virtual void Generate(int trial, double* point) noexcept = 0;
+
+  std::uint64_t seed_;  ///< The randomization seed.
+  int trial_ = 0;  ///< The index of the next trial.
+  std::vector<double> point_;  ///< The point of the current trial.
+  /// The dimensions of the deviates.
+  std::unordered_map<const mef::RandomDeviate*, int> dimensions_;
+};
+
+}  // namespace scram::core
@@ -65,10 +65,14 @@ po::options_description ConstructOptions() {
       ("config-file", OPT_VALUE(path), "XML file with analysis configurations")
       ("allow-extern", "**UNSAFE** Allow external libraries")
       ("validate", "Validate input files without analysis")
+      ("stream-input", "Stream input files into the model without XML DOM")
+      ("model-cache", OPT_VALUE(path),
+       "Directory to cache binary snapshots of validated models")
       ("bdd", "Perform qualitative analysis with BDD")
       ("zbdd", "Perform qualitative analysis with ZBDD")
       ("mocus", "Perform qualitative analysis with MOCUS")
       ("prime-implicants", "Calculate prime implicants")
+      ("reorder", "Reorder BDD variables dynamically with sifting")
       ("probability", OPT_VALUE(bool), "Perform probability analysis")
       ("importance", OPT_VALUE(bool), "Perform importance analysis")
       ("uncertainty", OPT_VALUE(bool), "Perform uncertainty analysis")
@@ -81,13 +85,29 @@ po::options_description ConstructOptions() {
       ("mission-time", OPT_VALUE(double), "System mission time in hours")
       ("time-step", OPT_VALUE(double),
        "Time step in hours for probability analysis")
+      ("time-tolerance", OPT_VALUE(double),
+       "Probability tolerance for adaptive refinement of time steps")
       ("num-trials", OPT_VALUE(int),
        "Number of trials for Monte Carlo simulations")
+      ("mean-error", OPT_VALUE(double),
+       "Target relative error of the mean to stop simulations early")
+      ("quantile-error", OPT_VALUE(double),
+       "Target relative error of the 95th percentile to stop simulations")
+      ("sampling", OPT_VALUE(std::string),
+       "Uncertainty sampling: monte-carlo, latin-hypercube, sobol")
       ("num-quantiles", OPT_VALUE(int),
        "Number of quantiles for distributions")
       ("num-bins", OPT_VALUE(int), "Number of bins for histograms")
       ("seed", OPT_VALUE(int), "Seed for the pseudo-random number generator")
+      ("jobs,j", OPT_VALUE(int),
+       "Number of parallel jobs for analyses, BDD, and simulations")
+      ("bdd-memory", OPT_VALUE(int),
+       "Memory budget in MiB for BDD computation caches")
+      ("merge-budget", OPT_VALUE(int),
+       "Work budget for merging common arguments of gates (0 for no limit)")
       ("output-path,o", OPT_VALUE(path), "Output path for reports")
+      ("preprocessor-profile", OPT_VALUE(path),
+       "Output path for the JSON profile of preprocessing passes")
       ("no-indent", "Omit indentation whitespace in output XML")
       ("verbosity", OPT_VALUE(int), "Set log verbosity");
 #ifndef NDEBUG
@@ -209,6 +229,10 @@ void ConstructSettings(const po::variables_map& vm,
     settings->algorithm("mocus");
   }
   settings->prime_implicants(vm.count("prime-implicants"));
+  if (vm.count("reorder"))
+    settings->reordering(true);
+  if (vm.count("stream-input"))
+    settings->stream_input(true);
   // Determine if the probability approximation is requested.
   if (vm.count("rare-event")) {
     assert(!vm.count("mcub"));
@@ -217,6 +241,7 @@ void ConstructSettings(const po::variables_map& vm,
     settings->approximation("mcub");
   }
   SET("time-step", double, time_step);
+  SET("time-tolerance", double, time_tolerance);
   SET("sil", bool, safety_integrity_levels);
 
   SET("probability", bool, probability_analysis);
@@ -228,8 +253,15 @@ void ConstructSettings(const po::variables_map& vm,
   SET("cut-off", double, cut_off);
   SET("mission-time", double, mission_time);
   SET("num-trials", int, num_trials);
+  SET("mean-error", double, mean_error);
+  SET("quantile-error", double, quantile_error);
+  SET("sampling", std::string, sampling);
   SET("num-quantiles", int, num_quantiles);
   SET("num-bins", int, num_bins);
+  SET("jobs", int, num_jobs);
+  SET("bdd-memory", int, bdd_memory);
+  SET("merge-budget", int, merge_budget);
+  SET("model-cache", std::string, model_cache);
 #ifndef NDEBUG
   settings->preprocessor = vm.count("preprocessor");
   settings->print = vm.count("print");
@@ -283,6 +315,10 @@ void RunScram(const po::variables_map& vm) {
   // Initiate risk analysis with the given information.
   scram::core::RiskAnalysis analysis(model.get(), settings);
   analysis.Analyze();
+  if (vm.count("preprocessor-profile")) {
+    scram::Reporter().ReportPreprocessing(
+        analysis, vm["preprocessor-profile"].as<std::string>());
+  }
 #ifndef NDEBUG
   if (vm.count("no-report") || vm.count("preprocessor") || vm.count("print"))
     return;
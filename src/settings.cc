@@ -23,6 +23,7 @@
 #include <string>
 
 #include <boost/range/algorithm.hpp>
+#include <boost/version.hpp>
 
 #include "error.h"
 
@@ -113,6 +114,44 @@ Settings& Settings::num_trials(int n) {
   return *this;
 }
 
+Settings& Settings::mean_error(double error) {
+  if (error < 0 || error >= 1)
+    SCRAM_THROW(
+        SettingsError("The target error of the mean must be in [0, 1)."))
+        << errinfo_value(std::to_string(error));
+
+  mean_error_ = error;
+  return *this;
+}
+
+Settings& Settings::quantile_error(double error) {
+  if (error < 0 || error >= 1)
+    SCRAM_THROW(
+        SettingsError("The target error of the quantile must be in [0, 1)."))
+        << errinfo_value(std::to_string(error));
+
+  quantile_error_ = error;
+  return *this;
+}
+
+Settings& Settings::sampling(Sampling value) {
+#if BOOST_VERSION < 107100  // Sobol sequences are introduced in Boost 1.71.
+  if (value == Sampling::kSobol)
+    SCRAM_THROW(SettingsError("Sobol sampling requires Boost 1.71 or later."));
+#endif
+  sampling_ = value;
+  return *this;
+}
+
+Settings& Settings::sampling(std::string_view value) {
+  auto it = boost::find(kSamplingToString, value);
+  if (it == std::end(kSamplingToString))
+    SCRAM_THROW(SettingsError("The sampling strategy is not recognized."))
+        << errinfo_value(std::string(value));
+
+  return sampling(static_cast<Sampling>(std::distance(kSamplingToString, it)));
+}
+
 Settings& Settings::num_quantiles(int n) {
   if (n < 1)
     SCRAM_THROW(SettingsError("The number of quantiles cannot be less than 1."))
@@ -131,6 +170,33 @@ Settings& Settings::num_bins(int n) {
   return *this;
 }
 
+Settings& Settings::num_jobs(int n) {
+  if (n < 1)
+    SCRAM_THROW(SettingsError("The number of jobs cannot be less than 1."))
+        << errinfo_value(std::to_string(n));
+
+  num_jobs_ = n;
+  return *this;
+}
+
+Settings& Settings::bdd_memory(int mib) {
+  if (mib < 1)
+    SCRAM_THROW(SettingsError("The BDD memory budget cannot be less than 1."))
+        << errinfo_value(std::to_string(mib));
+
+  bdd_memory_ = mib;
+  return *this;
+}
+
+Settings& Settings::merge_budget(int steps) {
+  if (steps < 0)
+    SCRAM_THROW(SettingsError("The merge budget cannot be negative."))
+        << errinfo_value(std::to_string(steps));
+
+  merge_budget_ = steps;
+  return *this;
+}
+
 Settings& Settings::seed(int s) {
   if (s < 0)
     SCRAM_THROW(SettingsError("The seed for PRNG cannot be negative."))
@@ -161,6 +227,15 @@ Settings& Settings::time_step(double time) {
   return *this;
 }
 
+Settings& Settings::time_tolerance(double tolerance) {
+  if (tolerance < 0 || tolerance >= 1)
+    SCRAM_THROW(SettingsError("The time tolerance must be in [0, 1)."))
+        << errinfo_value(std::to_string(tolerance));
+
+  time_tolerance_ = tolerance;
+  return *this;
+}
+
 Settings& Settings::safety_integrity_levels(bool flag) {
   if (flag && !time_step_)
     SCRAM_THROW(
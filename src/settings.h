@@ -22,7 +22,9 @@
 
 #include <cstdint>
 
+#include <string>
 #include <string_view>
+#include <utility>
 
 namespace scram::core {
 
@@ -38,6 +40,13 @@ enum class Approximation : std::uint8_t { kNone = 0, kRareEvent, kMcub };
 /// String representations for approximations.
 const char* const kApproximationToString[] = {"none", "rare-event", "mcub"};
 
+/// Sampling strategies for uncertainty analysis.
+enum class Sampling : std::uint8_t { kMonteCarlo = 0, kLatinHypercube, kSobol };
+
+/// String representations for sampling strategies.
+const char* const kSamplingToString[] = {"monte-carlo", "latin-hypercube",
+                                         "sobol"};
+
 /// Builder for analysis settings.
 /// Analysis facilities are guaranteed not to throw or fail
 /// with an instance of this class.
@@ -106,6 +115,51 @@ class Settings {
   /// @throws SettingsError  The request is not relevant to the algorithm.
   Settings& prime_implicants(bool flag);
 
+  /// @returns true if BDD variables are to be reordered dynamically.
+  bool reordering() const { return reordering_; }
+
+  /// Sets a flag to reorder variables dynamically with sifting
+  /// upon the construction of BDD.
+  ///
+  /// @param[in] flag  True for the request.
+  ///
+  /// @returns Reference to this object.
+  Settings& reordering(bool flag) {
+    reordering_ = flag;
+    return *this;
+  }
+
+  /// @returns true if input files are to be streamed into the model.
+  bool stream_input() const { return stream_input_; }
+
+  /// Sets a flag to stream input files into the model
+  /// element by element without building the whole XML DOM.
+  /// Streaming trades the parallel parsing of files
+  /// for the memory bounded by the model size.
+  ///
+  /// @param[in] flag  True for the request.
+  ///
+  /// @returns Reference to this object.
+  Settings& stream_input(bool flag) {
+    stream_input_ = flag;
+    return *this;
+  }
+
+  /// @returns The directory for snapshots of validated models
+  ///          or an empty string for no caching.
+  const std::string& model_cache() const { return model_cache_; }
+
+  /// Sets the directory to cache binary snapshots of validated models.
+  /// The snapshots skip the processing of unchanged input files.
+  ///
+  /// @param[in] path  The directory path or an empty string for no caching.
+  ///
+  /// @returns Reference to this object.
+  Settings& model_cache(std::string path) {
+    model_cache_ = std::move(path);
+    return *this;
+  }
+
   /// @returns The limit on the size of products.
   int limit_order() const { return limit_order_; }
 
@@ -143,6 +197,64 @@ class Settings {
   /// @throws SettingsError  The number is less than 1.
   Settings& num_trials(int n);
 
+  /// @returns The target relative error of the mean
+  ///          for early stopping of uncertainty analysis.
+  ///          0 if all the trials are run.
+  double mean_error() const { return mean_error_; }
+
+  /// Sets the target relative error of the mean at 95% confidence.
+  /// The uncertainty analysis stops sampling
+  /// once the confidence interval of the mean is narrow enough.
+  /// The number of trials becomes the upper limit.
+  ///
+  /// @param[in] error  The half-width of the confidence interval
+  ///                   relative to the mean.
+  ///                   0 value disables the early stopping.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The error is not in [0, 1).
+  Settings& mean_error(double error);
+
+  /// @returns The target relative error of the 95th percentile
+  ///          for early stopping of uncertainty analysis.
+  ///          0 if all the trials are run.
+  double quantile_error() const { return quantile_error_; }
+
+  /// Sets the target relative error of the 95th percentile
+  /// at 95% confidence.
+  /// The uncertainty analysis stops sampling
+  /// once the percentile estimate is precise enough.
+  /// The number of trials becomes the upper limit.
+  ///
+  /// @param[in] error  The half-width of the confidence interval
+  ///                   relative to the percentile.
+  ///                   0 value disables the early stopping.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The error is not in [0, 1).
+  Settings& quantile_error(double error);
+
+  /// @returns The sampling strategy for uncertainty analysis.
+  Sampling sampling() const { return sampling_; }
+
+  /// Sets the sampling strategy of the uncertain probabilities.
+  /// Latin hypercube and Sobol sampling map stratified or low-discrepancy
+  /// points through the inverse distribution functions of the deviates
+  /// instead of independent pseudo-random draws.
+  ///
+  /// @param[in] value  The sampling strategy.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The sampling is not recognized
+  ///                        or not supported by this build.
+  /// @{
+  Settings& sampling(Sampling value);
+  Settings& sampling(std::string_view value);
+  /// @}
+
   /// @returns The number of quantiles for distributions.
   int num_quantiles() const { return num_quantiles_; }
 
@@ -167,6 +279,55 @@ class Settings {
   /// @throws SettingsError  The number is less than 1.
   Settings& num_bins(int n);
 
+  /// @returns The number of parallel jobs
+  ///          for analysis targets, BDD construction,
+  ///          and Monte Carlo simulations.
+  int num_jobs() const { return num_jobs_; }
+
+  /// Sets the number of parallel jobs (threads)
+  /// for parsing and validation of input files,
+  /// for analysis of independent targets (top events and sequences),
+  /// for conversion of independent modules into BDD,
+  /// and for Monte Carlo simulations.
+  /// The results of analyses do not depend on the number of jobs.
+  ///
+  /// @param[in] n  A natural number for the number of jobs.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is less than 1.
+  Settings& num_jobs(int n);
+
+  /// @returns The memory budget in MiB for BDD computation caches.
+  int bdd_memory() const { return bdd_memory_; }
+
+  /// Sets the memory budget for BDD Apply computation caches.
+  /// The caches stop growing at the budget
+  /// and start evicting (forgetting) older computation results.
+  ///
+  /// @param[in] mib  A natural number of mebibytes.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is less than 1.
+  Settings& bdd_memory(int mib);
+
+  /// @returns The work budget for merging common arguments of gates.
+  int merge_budget() const { return merge_budget_; }
+
+  /// Sets the work budget for the preprocessing
+  /// that merges common arguments of gates into new gates
+  /// or factors out distributive arguments.
+  /// The budget is counted in compared gates and merge options.
+  /// The merging stops early once the budget is exhausted.
+  ///
+  /// @param[in] steps  A non-negative number of steps; 0 for no limit.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The number is negative.
+  Settings& merge_budget(int steps);
+
   /// @returns The seed of the pseudo-random number generator.
   int seed() const { return seed_; }
 
@@ -207,6 +368,24 @@ class Settings {
   ///                          while the SIL metrics are requested.
   Settings& time_step(double time);
 
+  /// @returns The tolerance on the probability interpolation error
+  ///          for adaptive refinement of time steps.
+  ///          0 if the time steps are uniform.
+  double time_tolerance() const { return time_tolerance_; }
+
+  /// Sets the tolerance for adaptive refinement of time steps.
+  /// The time step becomes the coarsest step,
+  /// which is bisected where linear interpolation of the probability
+  /// deviates from the calculated value by more than the tolerance.
+  ///
+  /// @param[in] tolerance  The absolute error in probability.
+  ///                       0 value disables the refinement.
+  ///
+  /// @returns Reference to this object.
+  ///
+  /// @throws SettingsError  The tolerance is not in [0, 1).
+  Settings& time_tolerance(double tolerance);
+
   /// @returns true if probability analysis is requested.
   bool probability_analysis() const { return probability_analysis_; }
 
@@ -299,18 +478,29 @@ class Settings {
   bool uncertainty_analysis_ = false;  ///< A flag for uncertainty analysis.
   bool ccf_analysis_ = false;  ///< A flag for common-cause analysis.
   bool prime_implicants_ = false;  ///< Calculation of prime implicants.
+  bool reordering_ = false;  ///< Dynamic reordering of BDD variables.
+  bool stream_input_ = false;  ///< Streaming of input files into the model.
+  std::string model_cache_;  ///< The directory for model snapshots.
   /// Qualitative analysis algorithm.
   Algorithm algorithm_ = Algorithm::kBdd;
   /// The approximations for calculations.
   Approximation approximation_ = Approximation::kNone;
+  /// The sampling strategy for uncertainty analysis.
+  Sampling sampling_ = Sampling::kMonteCarlo;
   int limit_order_ = 20;  ///< Limit on the order of products.
   int seed_ = 0;  ///< The seed for the pseudo-random number generator.
   int num_trials_ = 1e3;  ///< The number of trials for Monte Carlo simulations.
   int num_quantiles_ = 20;  ///< The number of quantiles for distributions.
   int num_bins_ = 20;  ///< The number of bins for histograms.
+  int num_jobs_ = 1;  ///< The number of parallel jobs (threads).
+  int bdd_memory_ = 256;  ///< The memory budget in MiB for BDD caches.
+  int merge_budget_ = 10000000;  ///< The work budget for merging gate args.
   double mission_time_ = 8760;  ///< System mission time.
   double time_step_ = 0;  ///< The time step for probability analyses.
-  double cut_off_ = 1e-8;  ///< The cut-off probability for products.
+  double time_tolerance_ = 0;  ///< The tolerance for adaptive time steps.
+  double cut_off_ = 0;  ///< The cut-off probability for products.
+  double mean_error_ = 0;  ///< The target relative error of the mean.
+  double quantile_error_ = 0;  ///< The target relative error of the 95th %.
 };
 
 }  // namespace scram::core
@@ -22,6 +22,14 @@
 
 #include <cmath>
 
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/density.hpp>
 #include <boost/accumulators/statistics/extended_p_square_quantile.hpp>
@@ -31,13 +39,136 @@
 
 #include "event.h"
 #include "expression.h"
+#include "expression/random_deviate.h"
+#include "expression/tape.h"
 #include "logger.h"
+#include "sampling.h"
 
 namespace scram::core {
 
+namespace {
+
+/// The number of consecutive trials sharing a single stream of random numbers.
+/// The value must not depend on the number of jobs
+/// for the results to be reproducible.
+const int kTrialsPerStream = 100;
+
+/// The maximum number of the first samples
+/// cached to determine the bins of the histogram.
+/// The convergence of the statistics is not tested before the cache is full.
+const int kHistogramCacheSize = 1000;
+
+/// The z-score of the 95% confidence for the target errors.
+const double kConfidenceZ = 1.96;
+
+/// The percentile with the target error and its neighborhood
+/// for the density estimation at the percentile.
+const double kTargetPercentile = 0.95;
+const double kPercentileDelta = 0.01;  ///< The neighborhood half-width.
+
+}  // namespace
+
+/// Accumulates the statistics of the samples one by one
+/// without storing the samples.
+class UncertaintyAnalysis::Statistics {
+ public:
+  /// The accumulators of the reported statistics.
+  using Accumulator = boost::accumulators::accumulator_set<
+      double, boost::accumulators::stats<
+                  boost::accumulators::tag::mean,
+                  boost::accumulators::tag::variance,
+                  boost::accumulators::tag::density,
+                  boost::accumulators::tag::extended_p_square_quantile>>;
+
+  /// The P-square estimator of the percentile with the target error.
+  using PercentileAccumulator = boost::accumulators::accumulator_set<
+      double, boost::accumulators::stats<
+                  boost::accumulators::tag::extended_p_square_quantile>>;
+
+  /// @param[in] settings  The analysis settings with the targets.
+  /// @param[in] quantiles  The probabilities of the reported quantiles.
+  Statistics(const Settings& settings, const std::vector<double>& quantiles)
+      : mean_error_(settings.mean_error()),
+        quantile_error_(settings.quantile_error()),
+        cache_size_(std::min(settings.num_trials(), kHistogramCacheSize)),
+        accumulator_(boost::accumulators::tag::density::num_bins =
+                         settings.num_bins(),
+                     boost::accumulators::tag::density::cache_size =
+                         cache_size_,
+                     boost::accumulators::extended_p_square_probabilities =
+                         quantiles),
+        percentile_(boost::accumulators::extended_p_square_probabilities =
+                        std::vector<double>{
+                            kTargetPercentile - kPercentileDelta,
+                            kTargetPercentile,
+                            kTargetPercentile + kPercentileDelta}) {}
+
+  /// Adds a sample to the statistics.
+  ///
+  /// @param[in] sample  The sampled value.
+  void operator()(double sample) noexcept {
+    ++count_;
+    accumulator_(sample);
+    if (quantile_error_)
+      percentile_(sample);
+  }
+
+  /// @returns The number of samples.
+  int count() const { return count_; }
+
+  /// @returns The accumulated statistics.
+  const Accumulator& accumulator() const { return accumulator_; }
+
+  /// @returns true if all the target errors are met.
+  /// @returns false if no targets are given.
+  bool Converged() const noexcept {
+    if (!mean_error_ && !quantile_error_)
+      return false;
+    if (count_ < std::max(cache_size_, 2))
+      return false;
+    if (mean_error_) {
+      double sigma = std::sqrt(count_ * boost::accumulators::variance(
+                                            accumulator_) / (count_ - 1));
+      if (kConfidenceZ * sigma / std::sqrt(count_) >
+          mean_error_ * boost::accumulators::mean(accumulator_)) {
+        return false;
+      }
+    }
+    if (quantile_error_) {
+      using boost::accumulators::quantile;
+      using boost::accumulators::quantile_probability;
+      double lower = quantile(percentile_, quantile_probability =
+                                               kTargetPercentile -
+                                               kPercentileDelta);
+      double upper = quantile(percentile_, quantile_probability =
+                                               kTargetPercentile +
+                                               kPercentileDelta);
+      double value =
+          quantile(percentile_, quantile_probability = kTargetPercentile);
+      // The asymptotic standard error of the sample percentile
+      // with the density estimated from the neighboring percentiles.
+      double error = std::sqrt(kTargetPercentile * (1 - kTargetPercentile) /
+                               count_) *
+                     (upper - lower) / (2 * kPercentileDelta);
+      if (kConfidenceZ * error > quantile_error_ * value)
+        return false;
+    }
+    return true;
+  }
+
+ private:
+  double mean_error_;  ///< The target relative error of the mean.
+  double quantile_error_;  ///< The target relative error of the percentile.
+  int cache_size_;  ///< The number of samples to determine the histogram.
+  int count_ = 0;  ///< The number of samples.
+  Accumulator accumulator_;  ///< The reported statistics.
+  PercentileAccumulator percentile_;  ///< The targeted percentile.
+};
+
 UncertaintyAnalysis::UncertaintyAnalysis(
     const ProbabilityAnalysis* prob_analysis)
     : Analysis(prob_analysis->settings()),
+      num_trials_(0),
       mean_(0),
       sigma_(0),
       error_factor_(1) {}
@@ -46,15 +177,9 @@ void UncertaintyAnalysis::Analyze() noexcept {
   CLOCK(analysis_time);
   CLOCK(sample_time);
   LOG(DEBUG3) << "Sampling probabilities...";
-  // Sample probabilities and generate data.
-  std::vector<double> samples = this->Sample();
+  // Sample probabilities and calculate statistics.
+  this->Sample();
   LOG(DEBUG3) << "Finished sampling probabilities in " << DUR(sample_time);
-
-  {
-    TIMER(DEBUG3, "Calculating statistics");
-    CalculateStatistics(samples);  // Perform statistical analysis.
-  }
-
   Analysis::AddAnalysisTime(DUR(analysis_time));
 }
 
@@ -72,50 +197,137 @@ UncertaintyAnalysis::GatherDeviateExpressions(const Pdag* graph) noexcept {
 
 void UncertaintyAnalysis::SampleExpressions(
     const std::vector<std::pair<int, mef::Expression&>>& deviate_expressions,
-    Pdag::IndexMap<double>* p_vars) noexcept {
-  // Reset distributions.
-  for (const auto& expression : deviate_expressions)
-    expression.second.Reset();
+    mef::ExpressionTape* tape, int num_lanes,
+    ProbabilityBatch* batch) noexcept {
+  tape->Sample(num_lanes);
+  for (int i = 0; i < deviate_expressions.size(); ++i) {
+    const double* samples = tape->lanes(i);
+    assert(samples && "Deviate expressions must vary.");
+    double* lanes = batch->lanes(deviate_expressions[i].first);
+    for (int lane = 0; lane < num_lanes; ++lane) {
+      double prob = samples[lane];
+      lanes[lane] = prob > 1 ? 1 : prob < 0 ? 0 : prob;
+    }
+  }
+}
 
-  // Sample all expressions with distributions.
+void UncertaintyAnalysis::RunTrials(
+    const Pdag* graph, const Pdag::IndexMap<double>& p_vars,
+    const TotalProbabilityCalculator& calculator) {
+  std::vector<std::pair<int, mef::Expression&>> deviate_expressions =
+      GatherDeviateExpressions(graph);
+  int num_trials = Analysis::settings().num_trials();
+  int num_streams = (num_trials + kTrialsPerStream - 1) / kTrialsPerStream;
+  int num_jobs = std::min(Analysis::settings().num_jobs(), num_streams);
+  std::vector<mef::Expression*> expressions;
+  expressions.reserve(deviate_expressions.size());
   for (const auto& expression : deviate_expressions) {
-    double prob = expression.second.Sample();
-    (*p_vars)[expression.first] = prob > 1 ? 1 : prob < 0 ? 0 : prob;
+    expression.second.ReserveSamplingContexts(num_jobs);
+    expressions.push_back(&expression.second);
   }
+
+  // The only random number drawn by the calling thread.
+  unsigned base_seed = mef::RandomDeviate::GenerateSeed();
+  Sampling sampling = Analysis::settings().sampling();
+  std::vector<const mef::RandomDeviate*> deviates;
+  if (sampling != Sampling::kMonteCarlo)
+    deviates = UniformSampler::GatherDeviates(expressions);
+
+  quantiles_.clear();
+  int num_quantiles = Analysis::settings().num_quantiles();
+  double delta = 1.0 / num_quantiles;
+  for (int i = 0; i < num_quantiles; ++i)
+    quantiles_.push_back(delta * (i + 1));
+  Statistics statistics(Analysis::settings(), quantiles_);
+
+  // The streams completed ahead of the streams before them.
+  std::map<int, std::vector<double>> pending_streams;
+  int next_fold = 0;  // The next stream to add to the statistics.
+  std::mutex fold_mutex;
+  std::atomic<bool> converged = false;
+  // Adds the samples of the completed stream to the statistics
+  // strictly in the stream order to keep the results reproducible.
+  auto fold = [&](int stream, std::vector<double>* samples) {
+    std::lock_guard<std::mutex> lock(fold_mutex);
+    if (converged)
+      return;  // The samples beyond the converged stream are discarded.
+    pending_streams.emplace(stream, std::move(*samples));
+    for (auto it = pending_streams.begin();
+         it != pending_streams.end() && it->first == next_fold;
+         it = pending_streams.erase(it), ++next_fold) {
+      for (double sample : it->second)
+        statistics(sample);
+      if (statistics.Converged()) {
+        converged = true;
+        break;
+      }
+    }
+  };
+
+  std::atomic<int> next_stream = 0;
+  auto run_job = [&](int context) {
+    mef::Expression::sampling_context(context);
+    ProbabilityBatch batch(p_vars);  // Private copy!
+    mef::ExpressionTape tape(expressions, ProbabilityBatch::kSize);
+    std::unique_ptr<UniformSampler> sampler =
+        UniformSampler::Create(sampling, deviates, num_trials, base_seed);
+    mef::RandomDeviate::uniform_source(sampler.get());
+    std::vector<double> samples;
+    for (int stream = next_stream++; stream < num_streams && !converged;
+         stream = next_stream++) {
+      std::seed_seq seq{base_seed, static_cast<unsigned>(stream)};
+      mef::RandomDeviate::seed(seq);
+      if (sampler)
+        sampler->Seek(stream * kTrialsPerStream);
+      samples.clear();
+      int end = std::min(num_trials, (stream + 1) * kTrialsPerStream);
+      for (int first = stream * kTrialsPerStream; first < end;
+           first += ProbabilityBatch::kSize) {
+        int num_lanes = std::min(end - first, ProbabilityBatch::kSize);
+        SampleExpressions(deviate_expressions, &tape, num_lanes, &batch);
+        ProbabilityBatch::Results results = calculator(batch);
+        for (int lane = 0; lane < num_lanes; ++lane) {
+          assert(results[lane] >= 0 && results[lane] <= 1);
+          samples.push_back(results[lane]);
+        }
+      }
+      fold(stream, &samples);
+    }
+    mef::RandomDeviate::uniform_source(nullptr);
+  };
+
+  LOG(DEBUG4) << "Running up to " << num_trials << " trials in " << num_jobs
+              << " job(s)...";
+  std::vector<std::thread> jobs;
+  jobs.reserve(num_jobs);
+  for (int i = 0; i < num_jobs; ++i)
+    jobs.emplace_back(run_job, i);
+  for (std::thread& job : jobs)
+    job.join();
+  assert(pending_streams.empty() || converged);
+  LOG(DEBUG4) << "Finished " << statistics.count() << " trials";
+  CalculateStatistics(statistics);
 }
 
 void UncertaintyAnalysis::CalculateStatistics(
-    const std::vector<double>& samples) noexcept {
+    const Statistics& statistics) noexcept {
   using namespace boost;  // NOLINT
   using namespace boost::accumulators;  // NOLINT
   using histogram_type =
       iterator_range<std::vector<std::pair<double, double>>::iterator>;
-  quantiles_.clear();
-  int num_quantiles = Analysis::settings().num_quantiles();
-  double delta = 1.0 / num_quantiles;
-  for (int i = 0; i < num_quantiles; ++i) {
-    quantiles_.push_back(delta * (i + 1));
-  }
-  int num_trials = Analysis::settings().num_trials();
-  accumulator_set<double, stats<tag::mean, tag::variance, tag::density,
-                                tag::extended_p_square_quantile>>
-      acc(tag::density::num_bins = Analysis::settings().num_bins(),
-          tag::density::cache_size = num_trials,
-          extended_p_square_probabilities = quantiles_);
-  for (double sample : samples) {
-    acc(sample);
-  }
+  const Statistics::Accumulator& acc = statistics.accumulator();
+  num_trials_ = statistics.count();
   histogram_type hist = density(acc);
   for (int i = 1; i < hist.size(); i++) {
     distribution_.push_back(hist[i]);
   }
   mean_ = boost::accumulators::mean(acc);
-  sigma_ = std::sqrt(num_trials * variance(acc) / (num_trials - 1));
+  sigma_ = std::sqrt(num_trials_ * variance(acc) / (num_trials_ - 1));
   error_factor_ = std::exp(1.96 * sigma_);
-  confidence_interval_.first = mean_ - sigma_ * 1.96 / std::sqrt(num_trials);
-  confidence_interval_.second = mean_ + sigma_ * 1.96 / std::sqrt(num_trials);
+  confidence_interval_.first = mean_ - sigma_ * 1.96 / std::sqrt(num_trials_);
+  confidence_interval_.second = mean_ + sigma_ * 1.96 / std::sqrt(num_trials_);
 
-  for (int i = 0; i < num_quantiles; ++i) {
+  for (int i = 0; i < quantiles_.size(); ++i) {
     quantiles_[i] = quantile(acc, quantile_probability = quantiles_[i]);
   }
 }
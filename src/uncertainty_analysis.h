@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <functional>
 #include <utility>
 #include <vector>
 
@@ -30,6 +31,7 @@
 
 namespace scram::mef {  // Decouple from the implementation dependence.
 class Expression;
+class ExpressionTape;
 }  // namespace scram::mef
 
 namespace scram::core {
@@ -53,6 +55,11 @@ class UncertaintyAnalysis : public Analysis {
   /// @note  Undefined behavior if analysis called two or more times.
   void Analyze() noexcept;
 
+  /// @returns The number of trials performed,
+  ///          which may be less than requested
+  ///          if the target errors are met early.
+  int num_trials() const { return num_trials_; }
+
   /// @returns Mean of the final distribution.
   double mean() const { return mean_; }
 
@@ -84,27 +91,59 @@ class UncertaintyAnalysis : public Analysis {
   std::vector<std::pair<int, mef::Expression&>>
   GatherDeviateExpressions(const Pdag* graph) noexcept;
 
-  /// Samples uncertain probabilities.
+  /// Samples uncertain probabilities for a batch of trials.
   ///
   /// @param[in] deviate_expressions  A collection of deviate expressions.
-  /// @param[in,out] p_vars  Indices to probabilities mapping with values.
+  /// @param[in,out] tape  The compiled deviate expressions.
+  /// @param[in] num_lanes  The number of trials in the batch.
+  /// @param[in,out] batch  The batch of variable probabilities.
   void SampleExpressions(
       const std::vector<std::pair<int, mef::Expression&>>& deviate_expressions,
-      Pdag::IndexMap<double>* p_vars) noexcept;
+      mef::ExpressionTape* tape, int num_lanes,
+      ProbabilityBatch* batch) noexcept;
+
+  /// Calculator of the total probabilities
+  /// with batches of sampled variable probabilities.
+  using TotalProbabilityCalculator =
+      std::function<ProbabilityBatch::Results(const ProbabilityBatch&)>;
+
+  /// Runs Monte Carlo trials in parallel jobs
+  /// and calculates the statistics of the total probability.
+  /// The trials are partitioned into fixed-size blocks,
+  /// and each block gets its own stream of random numbers
+  /// seeded with the block number and the base seed.
+  /// Therefore, the samples do not depend on the number of jobs.
+  /// Latin hypercube and Sobol points are indexed by the trial
+  /// and are independent of the streams and jobs as well.
+  ///
+  /// The samples are not stored;
+  /// the statistics are updated with the completed blocks
+  /// in the block order,
+  /// and the simulation stops early
+  /// once the target errors of the estimates are met.
+  ///
+  /// @param[in] graph  PDAG with the variables.
+  /// @param[in] p_vars  The default probabilities of the variables.
+  /// @param[in] calculator  The batch total probability calculator
+  ///                        safe to call from concurrent jobs.
+  void RunTrials(const Pdag* graph, const Pdag::IndexMap<double>& p_vars,
+                 const TotalProbabilityCalculator& calculator);
 
  private:
+  /// The streaming statistics of the samples.
+  class Statistics;
+
   /// Performs Monte Carlo Simulation
   /// by sampling the probability distributions
-  /// and providing the final sampled values of the final probability.
-  ///
-  /// @returns Sampled values.
-  virtual std::vector<double> Sample() noexcept = 0;
+  /// and calculating the statistics of the final probability.
+  virtual void Sample() noexcept = 0;
 
   /// Calculates statistical values from the final distribution.
   ///
-  /// @param[in] samples  Gathered samples for statistical analysis.
-  void CalculateStatistics(const std::vector<double>& samples) noexcept;
+  /// @param[in] statistics  The statistics of all the samples.
+  void CalculateStatistics(const Statistics& statistics) noexcept;
 
+  int num_trials_;  ///< The number of performed trials.
   double mean_;  ///< The mean of the final distribution.
   double sigma_;  ///< The standard deviation of the final distribution.
   double error_factor_;  ///< Error factor for 95% confidence level.
@@ -131,29 +170,28 @@ class UncertaintyAnalyzer : public UncertaintyAnalysis {
       : UncertaintyAnalysis(prob_analyzer), prob_analyzer_(prob_analyzer) {}
 
  private:
-  /// @returns Samples of the total probability.
-  std::vector<double> Sample() noexcept override;
+  /// Samples the total probability.
+  void Sample() noexcept override;
 
   /// Calculator of the total probability.
   ProbabilityAnalyzer<Calculator>* prob_analyzer_;
 };
 
 template <class Calculator>
-std::vector<double> UncertaintyAnalyzer<Calculator>::Sample() noexcept {
-  std::vector<std::pair<int, mef::Expression&>> deviate_expressions =
-      UncertaintyAnalysis::GatherDeviateExpressions(prob_analyzer_->graph());
-  Pdag::IndexMap<double> p_vars = prob_analyzer_->p_vars();  // Private copy!
-  std::vector<double> samples;
-  samples.reserve(Analysis::settings().num_trials());
-
-  for (int i = 0; i < Analysis::settings().num_trials(); ++i) {
-    UncertaintyAnalysis::SampleExpressions(deviate_expressions, &p_vars);
-    double result = prob_analyzer_->CalculateTotalProbability(p_vars);
-    assert(result >= 0 && result <= 1);
-    samples.push_back(result);
+void UncertaintyAnalyzer<Calculator>::Sample() noexcept {
+  // Only the variables with deviate expressions change in the trials.
+  std::vector<int> variables;
+  for (const auto& deviate :
+       UncertaintyAnalysis::GatherDeviateExpressions(prob_analyzer_->graph())) {
+    variables.push_back(deviate.first);
   }
-
-  return samples;
+  prob_analyzer_->PrepareBatches(variables);
+  UncertaintyAnalysis::RunTrials(
+      prob_analyzer_->graph(), prob_analyzer_->p_vars(),
+      [this](const ProbabilityBatch& batch) {
+        return prob_analyzer_->CalculateTotalProbabilities(batch);
+      });
+  prob_analyzer_->PrepareBatches();
 }
 
 }  // namespace scram::core
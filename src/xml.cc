@@ -20,11 +20,64 @@
 
 #include "xml.h"
 
+#include <algorithm>
+#include <unordered_set>
+
+#include <libxml/uri.h>
 #include <libxml/xinclude.h>
 
 namespace scram::xml {
 
-Document::Document(const std::string& file_path, Validator* validator)
+namespace {  // Streaming helpers.
+
+/// @returns true if the node is an XInclude directive element.
+bool IsXInclude(const xmlNode* node) noexcept {
+  return node->type == XML_ELEMENT_NODE && node->ns &&
+         (xmlStrEqual(node->ns->href, XINCLUDE_NS) ||
+          xmlStrEqual(node->ns->href, XINCLUDE_OLD_NS));
+}
+
+/// Copies an element into another document
+/// without comments and formatting whitespace.
+///
+/// @param[in] node  The element node to copy.
+/// @param[in,out] doc  The destination document.
+/// @param[out] has_xinclude  Set to true if the copy has XInclude directives.
+///
+/// @returns The unlinked copy of the element.
+///
+/// @throws LogicError  The XML library functions have failed internally.
+xmlNode* CopyElement(xmlNode* node, xmlDoc* doc, bool* has_xinclude) {
+  assert(node->type == XML_ELEMENT_NODE);
+  xmlNode* copy = xmlDocCopyNode(node, doc, 2);  // Attributes only.
+  if (!copy)
+    SCRAM_THROW(LogicError("Failed to copy an XML element"));
+  copy->line = node->line;
+  if (IsXInclude(node))
+    *has_xinclude = true;
+
+  bool has_elements = false;
+  for (xmlNode* child = node->children; child; child = child->next) {
+    if (child->type == XML_ELEMENT_NODE) {
+      has_elements = true;
+      xmlAddChild(copy, CopyElement(child, doc, has_xinclude));
+    }
+  }
+  if (!has_elements) {  // The text is significant only in leaf elements.
+    for (xmlNode* child = node->children; child; child = child->next) {
+      if (child->type == XML_TEXT_NODE ||
+          child->type == XML_CDATA_SECTION_NODE) {
+        xmlAddChild(copy, xmlDocCopyNode(child, doc, 1));
+      }
+    }
+  }
+  return copy;
+}
+
+}  // namespace
+
+Document::Document(const std::string& file_path,
+                   const Validator* validator)
     : doc_(nullptr, &xmlFreeDoc) {
   xmlResetLastError();
   doc_.reset(xmlReadFile(file_path.c_str(), nullptr, kParserOptions));
@@ -44,9 +97,212 @@ Document::Document(const std::string& file_path, Validator* validator)
     validator->validate(*this);
 }
 
+Reader::Reader(const std::string& file_path, const Validator* validator)
+    : reader_(nullptr, &xmlFreeTextReader), doc_(nullptr, &xmlFreeDoc) {
+  xmlResetLastError();
+  reader_.reset(xmlReaderForFile(file_path.c_str(), nullptr, kParserOptions));
+  if (!reader_) {
+    xmlErrorPtr xml_error = xmlGetLastError();
+    if (!xml_error || xml_error->domain == xmlErrorDomain::XML_FROM_IO) {
+      SCRAM_THROW(IOError("Failed to open the XML file"))
+          << boost::errinfo_file_name(file_path)
+          << boost::errinfo_errno(errno) << boost::errinfo_file_open_mode("r");
+    }
+    SCRAM_THROW(detail::GetError<ParseError>(xml_error));
+  }
+  xmlTextReaderSetStructuredErrorHandler(reader_.get(), &RecordError, this);
+  if (validator) {
+    if (xmlTextReaderRelaxNGSetSchema(reader_.get(),
+                                      validator->schema_.get()) != 0)
+      SCRAM_THROW(LogicError("Failed to set the schema for XML streaming"));
+    validate_ = true;
+  }
+  doc_.reset(xmlNewDoc(nullptr));
+  if (!doc_)
+    SCRAM_THROW(LogicError("Failed to create an XML document"));
+  doc_->URL = xmlStrdup(reinterpret_cast<const xmlChar*>(file_path.c_str()));
+  doc_->dict = xmlDictCreate();
+
+  do {
+    if (!Advance(/*skip=*/false))
+      SCRAM_THROW(ParseError("The XML document has no root element"))
+          << boost::errinfo_file_name(file_path);
+  } while (xmlTextReaderNodeType(reader_.get()) != XML_READER_TYPE_ELEMENT);
+
+  xmlNode* node = xmlTextReaderCurrentNode(reader_.get());
+  xmlNode* root = xmlDocCopyNode(node, doc_.get(), 2);
+  if (!root)
+    SCRAM_THROW(LogicError("Failed to copy an XML element"));
+  root->line = node->line;
+  xmlDocSetRootElement(doc_.get(), root);
+  consumed_ = true;
+  skip_ = true;
+}
+
+Reader::~Reader() noexcept { xmlResetError(&error_); }
+
+template <class ErrorPtr>
+void Reader::RecordError(void* reader, ErrorPtr error) noexcept {
+  auto* self = static_cast<Reader*>(reader);
+  if (error->level >= XML_ERR_ERROR && self->error_.code == XML_ERR_OK)
+    xmlCopyError(error, &self->error_);
+}
+
+Element Reader::Enter() {
+  assert(consumed_ && skip_ && "No element to enter.");
+  xmlNode* node = xmlTextReaderCurrentNode(reader_.get());
+  assert(node && node->type == XML_ELEMENT_NODE);
+  xmlNode* head = xmlDocGetRootElement(doc_.get());  // The copy of the root.
+  if (depth_ >= 0) {
+    head = xmlDocCopyNode(node, doc_.get(), 2);
+    if (!head)
+      SCRAM_THROW(LogicError("Failed to copy an XML element"));
+    head->line = node->line;
+    xmlAddChild(xmlDocGetRootElement(doc_.get()), head);
+  }
+
+  if (xmlTextReaderIsEmptyElement(reader_.get())) {
+    end_ = true;
+    return Element(reinterpret_cast<const xmlElement*>(head));
+  }
+  depth_ = xmlTextReaderDepth(reader_.get());
+  skip_ = false;
+  while (std::optional<std::string_view> name = Next()) {
+    if (*name != "label" && *name != "attributes") {
+      consumed_ = false;  // Leave the child to the caller.
+      return Element(reinterpret_cast<const xmlElement*>(head));
+    }
+    Expand();
+    xmlUnlinkNode(last_);
+    xmlAddChild(head, last_);
+    last_ = nullptr;
+  }
+  end_ = true;  // The reader has already left the element.
+  return Element(reinterpret_cast<const xmlElement*>(head));
+}
+
+std::optional<std::string_view> Reader::Next() {
+  ReleaseLast();
+  if (end_) {
+    end_ = false;
+    return {};
+  }
+  for (;;) {
+    if (consumed_) {
+      if (!Advance(skip_))
+        return {};
+      consumed_ = false;
+    }
+    int type = xmlTextReaderNodeType(reader_.get());
+    int depth = xmlTextReaderDepth(reader_.get());
+    consumed_ = true;
+    skip_ = false;
+    if (type == XML_READER_TYPE_END_ELEMENT && depth == depth_) {
+      --depth_;
+      return {};
+    }
+    if (type == XML_READER_TYPE_ELEMENT && depth == depth_ + 1) {
+      skip_ = true;
+      ++index_;
+      return detail::from_utf8(xmlTextReaderConstName(reader_.get()));
+    }
+  }
+}
+
+Element Reader::Expand() {
+  assert(consumed_ && skip_ && "No element to expand.");
+  xmlNode* node = xmlTextReaderExpand(reader_.get());
+  if (!node)
+    SCRAM_THROW(detail::GetError<ParseError>());
+  bool has_xinclude = false;
+  last_ = CopyElement(node, doc_.get(), &has_xinclude);
+  retained_ = false;
+  xmlAddChild(xmlDocGetRootElement(doc_.get()), last_);
+  if (has_xinclude) {  // Only top-level directives are processed by reading.
+    xmlResetLastError();
+    if (xmlXIncludeProcessTreeFlags(last_, kParserOptions) < 0 ||
+        xmlGetLastError())
+      SCRAM_THROW(detail::GetError<XIncludeError>());
+  }
+  // Reading over the subtree validates it.
+  consumed_ = !Advance(/*skip=*/true);
+  skip_ = false;
+  return Element(reinterpret_cast<const xmlElement*>(last_));
+}
+
+void Reader::Retain(const Element& element) {
+  assert(element.get() == reinterpret_cast<const xmlElement*>(last_));
+  retained_ = true;
+}
+
+Reader::Position Reader::Locate(const Element& element) const {
+  Position position{index_, {}};
+  for (auto* node = reinterpret_cast<const xmlNode*>(element.get());
+       node != last_; node = node->parent) {
+    assert(node->parent && "The element is not from the last expansion.");
+    int child_index = 0;
+    for (const xmlNode* it = node->prev; it; it = it->prev) {
+      if (it->type == XML_ELEMENT_NODE)
+        ++child_index;
+    }
+    position.path.push_back(child_index);
+  }
+  std::reverse(position.path.begin(), position.path.end());
+  return position;
+}
+
+bool Reader::Advance(bool skip) {
+  // The library skipping is not used
+  // because it runs past empty elements coming from XInclude.
+  if (skip && xmlTextReaderIsEmptyElement(reader_.get()) == 0) {
+    int depth = xmlTextReaderDepth(reader_.get());
+    while (Read()) {
+      if (xmlTextReaderNodeType(reader_.get()) == XML_READER_TYPE_END_ELEMENT &&
+          xmlTextReaderDepth(reader_.get()) == depth)
+        break;
+    }
+  }
+  return Read();
+}
+
+bool Reader::Read() {
+  int ret = xmlTextReaderRead(reader_.get());
+  if (error_.code == XML_ERR_OK && ret >= 0 &&
+      (!validate_ || xmlTextReaderIsValid(reader_.get()) == 1))
+    return ret == 1;
+
+  if (error_.code == XML_ERR_OK) {  // Unreported failures.
+    SCRAM_THROW(ParseError("Failed to read the XML document"))
+        << boost::errinfo_file_name(detail::from_utf8(doc_->URL))
+        << boost::errinfo_at_line(xmlTextReaderGetParserLineNumber(
+               reader_.get()));
+  }
+  // Unresolved XInclude directives fail the validation silently.
+  if (xmlNode* node = xmlTextReaderCurrentNode(reader_.get());
+      node && IsXInclude(node)) {
+    SCRAM_THROW(XIncludeError("Failed to resolve the XInclude directive"))
+        << boost::errinfo_file_name(detail::from_utf8(doc_->URL))
+        << boost::errinfo_at_line(node->line);
+  }
+  switch (error_.domain) {
+    case xmlErrorDomain::XML_FROM_RELAXNGV:
+      SCRAM_THROW(detail::GetError<ValidityError>(&error_));
+    default:
+      SCRAM_THROW(detail::GetError<ParseError>(&error_));
+  }
+}
+
+void Reader::ReleaseLast() noexcept {
+  if (last_ && !retained_) {
+    xmlUnlinkNode(last_);
+    xmlFreeNode(last_);
+  }
+  last_ = nullptr;
+  retained_ = false;
+}
+
 Validator::Validator(const std::string& rng_file)
-    : schema_(nullptr, &xmlRelaxNGFree),
-      valid_ctxt_(nullptr, &xmlRelaxNGFreeValidCtxt) {
+    : schema_(nullptr, &xmlRelaxNGFree) {
   xmlResetLastError();
   std::unique_ptr<xmlRelaxNGParserCtxt, decltype(&xmlRelaxNGFreeParserCtxt)>
       parser_ctxt(xmlRelaxNGNewParserCtxt(rng_file.c_str()),
@@ -57,10 +313,67 @@ Validator::Validator(const std::string& rng_file)
   schema_.reset(xmlRelaxNGParse(parser_ctxt.get()));
   if (!schema_)
     SCRAM_THROW(detail::GetError<ParseError>());
+}
 
-  valid_ctxt_.reset(xmlRelaxNGNewValidCtxt(schema_.get()));
-  if (!valid_ctxt_)
+void Validator::validate(const Document& doc) const {
+  xmlResetLastError();
+  std::unique_ptr<xmlRelaxNGValidCtxt, decltype(&xmlRelaxNGFreeValidCtxt)>
+      valid_ctxt(xmlRelaxNGNewValidCtxt(schema_.get()),
+                 &xmlRelaxNGFreeValidCtxt);
+  if (!valid_ctxt)
     SCRAM_THROW(detail::GetError<LogicError>());
+
+  int ret =
+      xmlRelaxNGValidateDoc(valid_ctxt.get(), const_cast<xmlDoc*>(doc.get()));
+  if (ret != 0)
+    SCRAM_THROW(detail::GetError<ValidityError>());
+}
+
+std::vector<std::string> FindIncludes(const std::string& file_path) {
+  std::vector<std::string> includes;
+  std::unordered_set<std::string> visited = {file_path};
+  std::vector<std::string> documents = {file_path};
+  while (!documents.empty()) {
+    std::string document = std::move(documents.back());
+    documents.pop_back();
+    xmlResetLastError();
+    std::unique_ptr<xmlTextReader, decltype(&xmlFreeTextReader)> reader(
+        xmlReaderForFile(document.c_str(), nullptr,
+                         kParserOptions & ~XML_PARSE_XINCLUDE),
+        &xmlFreeTextReader);
+    if (!reader) {
+      SCRAM_THROW(IOError("Failed to open the XML file"))
+          << boost::errinfo_file_name(document)
+          << boost::errinfo_errno(errno) << boost::errinfo_file_open_mode("r");
+    }
+    int ret = 0;
+    while ((ret = xmlTextReaderRead(reader.get())) == 1) {
+      xmlNode* node = xmlTextReaderCurrentNode(reader.get());
+      if (node->type != XML_ELEMENT_NODE || !IsXInclude(node))
+        continue;
+      auto attribute = [&node](const char* name) {
+        std::unique_ptr<xmlChar, decltype(xmlFree)> value(
+            xmlGetProp(node, reinterpret_cast<const xmlChar*>(name)), xmlFree);
+        return std::string(value ? detail::from_utf8(value.get()) : "");
+      };
+      std::string href = attribute("href");
+      std::unique_ptr<xmlChar, decltype(xmlFree)> uri(
+          xmlBuildURI(reinterpret_cast<const xmlChar*>(href.c_str()),
+                      xmlTextReaderConstBaseUri(reader.get())),
+          xmlFree);
+      if (!uri)
+        continue;  // Leave malformed directives to the XInclude processing.
+      std::string include(detail::from_utf8(uri.get()));
+      if (!visited.insert(include).second)
+        continue;
+      includes.push_back(include);
+      if (attribute("parse") != "text")
+        documents.push_back(std::move(include));
+    }
+    if (ret < 0)
+      SCRAM_THROW(detail::GetError<ParseError>());
+  }
+  return includes;
 }
 
 }  // namespace scram::xml
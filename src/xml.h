@@ -42,6 +42,7 @@
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <vector>
 
 #include <boost/exception/errinfo_at_line.hpp>
 #include <boost/exception/errinfo_errno.hpp>
@@ -53,6 +54,7 @@
 #include <libxml/parser.h>
 #include <libxml/relaxng.h>
 #include <libxml/tree.h>
+#include <libxml/xmlreader.h>
 
 #include "error.h"
 
@@ -259,6 +261,9 @@ class Element {
   /// @returns The line number of the element.
   int line() const { return XML_GET_LINE(to_node()); }
 
+  /// @returns The underlying data element.
+  const xmlElement* get() const { return element_; }
+
   /// @returns The name of the XML element.
   ///
   /// @pre The element has a name.
@@ -396,6 +401,7 @@ const int kParserOptions = XML_PARSE_XINCLUDE | XML_PARSE_NOBASEFIX |
                            XML_PARSE_COMPACT | XML_PARSE_HUGE;
 
 class Validator;  // Forward declaration for validation upon DOM constructions.
+class Reader;  // Forward declaration for documents with streamed fragments.
 
 /// XML DOM tree document.
 class Document {
@@ -413,7 +419,7 @@ class Document {
   /// @throws XIncludeError  XInclude resolution has failed.
   /// @throws ValidityError  The XML file is not valid.
   explicit Document(const std::string& file_path,
-                    Validator* validator = nullptr);
+                    const Validator* validator = nullptr);
 
   /// @returns The root element of the document.
   ///
@@ -430,10 +436,19 @@ class Document {
   /// @}
 
  private:
+  friend class Reader;
+
+  /// @param[in] doc  The document to take the ownership of.
+  explicit Document(xmlDoc* doc) : doc_(doc, &xmlFreeDoc) {}
+
   std::unique_ptr<xmlDoc, decltype(&xmlFreeDoc)> doc_;  ///< The DOM document.
 };
 
 /// RelaxNG validator.
+///
+/// The compiled schema is shared read-only,
+/// and every validation gets its own validation context,
+/// so documents can be validated concurrently from several threads.
 class Validator {
  public:
   /// @param[in] rng_file  The path to the schema file.
@@ -447,20 +462,159 @@ class Validator {
   /// @param[in] doc  The initialized XML DOM document.
   ///
   /// @throws ValidityError  The document failed schema validation.
-  void validate(const Document& doc) {
-    xmlResetLastError();
-    int ret = xmlRelaxNGValidateDoc(valid_ctxt_.get(),
-                                    const_cast<xmlDoc*>(doc.get()));
-    if (ret != 0)
-      SCRAM_THROW(detail::GetError<ValidityError>());
-  }
+  /// @throws LogicError  The XML library functions have failed internally.
+  void validate(const Document& doc) const;
 
  private:
-  /// The schema used by the validation context.
+  friend class Reader;
+
+  /// The schema used by the validation contexts.
   std::unique_ptr<xmlRelaxNG, decltype(&xmlRelaxNGFree)> schema_;
-  /// The validation context.
-  std::unique_ptr<xmlRelaxNGValidCtxt, decltype(&xmlRelaxNGFreeValidCtxt)>
-      valid_ctxt_;
 };
 
+/// Streaming reader of XML documents.
+///
+/// The reader walks the document element by element
+/// without building the DOM of the whole document.
+/// Container elements are entered to stream their child elements,
+/// and other elements are expanded into compact standalone copies
+/// that live only until the next step of the reader
+/// unless retained for later use.
+/// The validation against the RNG schema proceeds incrementally;
+/// an element is returned only after its whole subtree has been validated.
+///
+/// The copies omit comments and formatting whitespace,
+/// but keep the source file name and line numbers of the elements.
+class Reader {
+ public:
+  /// Opens the XML document and positions the reader at the root element.
+  /// XInclude directives are processed while streaming.
+  ///
+  /// @param[in] file_path  The path to the document file.
+  /// @param[in] validator  Optional validator against the RNG schema.
+  ///
+  /// @throws IOError  The file is not available.
+  /// @throws ParseError  There are XML parsing failures.
+  /// @throws XIncludeError  XInclude resolution has failed.
+  /// @throws ValidityError  The XML file is not valid.
+  /// @throws LogicError  The XML library functions have failed internally.
+  explicit Reader(const std::string& file_path,
+                  const Validator* validator = nullptr);
+
+  ~Reader() noexcept;
+
+  /// Enters the current element (the root or the one found with Next)
+  /// to stream its child elements.
+  /// The leading "label" and "attributes" children are consumed
+  /// into the returned head element.
+  ///
+  /// @returns The retained copy of the element with its attributes,
+  ///          label, and attributes children.
+  ///
+  /// @throws Error  Reading or validation of the children has failed.
+  Element Enter();
+
+  /// Advances to the next child element of the entered element.
+  /// The child is skipped over by the next call
+  /// unless it is entered or expanded.
+  ///
+  /// @returns The name of the child element.
+  ///          std::nullopt if the entered element has no more children,
+  ///          and the reader leaves the element.
+  ///
+  /// @throws Error  Reading or validation has failed.
+  std::optional<std::string_view> Next();
+
+  /// Reads the whole subtree of the current element.
+  ///
+  /// @returns The validated copy of the element
+  ///          that lives until the next call to Next
+  ///          unless retained.
+  ///
+  /// @throws Error  Reading or validation of the subtree has failed.
+  Element Expand();
+
+  /// Retains the last expanded element
+  /// for the lifetime of the released document.
+  ///
+  /// @param[in] element  The element from the last expansion.
+  void Retain(const Element& element);
+
+  /// The position of an element in the document
+  /// to find the element again
+  /// by streaming the document with the same entered elements.
+  struct Position {
+    int index;  ///< The reading order of the expanded element.
+    /// The indices of child elements from the expanded element.
+    std::vector<int> path;
+  };
+
+  /// @returns The number of child elements returned so far.
+  int index() const { return index_; }
+
+  /// @param[in] element  The last expanded element or its descendant.
+  ///
+  /// @returns The position of the element in the document.
+  Position Locate(const Element& element) const;
+
+  /// @returns The document with all the retained elements.
+  ///
+  /// @post The reader must not be used after the release.
+  Document Release() { return Document(doc_.release()); }
+
+ private:
+  /// Advances the underlying reader.
+  ///
+  /// @param[in] skip  Skip the subtree of the current node.
+  ///
+  /// @returns false if the end of the document is reached.
+  ///
+  /// @throws Error  Reading or validation has failed.
+  bool Advance(bool skip);
+
+  /// Reads the next node in the document order.
+  ///
+  /// @returns false if the end of the document is reached.
+  ///
+  /// @throws Error  Reading or validation has failed.
+  bool Read();
+
+  /// Keeps the first error reported by the library while reading.
+  ///
+  /// @tparam ErrorPtr  The error pointer type of the library callback.
+  ///
+  /// @param[in] reader  This reader.
+  /// @param[in] error  The reported error or warning.
+  template <class ErrorPtr>
+  static void RecordError(void* reader, ErrorPtr error) noexcept;
+
+  /// Frees the last expanded copy if it is not retained.
+  void ReleaseLast() noexcept;
+
+  /// The underlying text reader of the library.
+  std::unique_ptr<xmlTextReader, decltype(&xmlFreeTextReader)> reader_;
+  /// The document with copies of elements.
+  std::unique_ptr<xmlDoc, decltype(&xmlFreeDoc)> doc_;
+  int depth_ = -1;  ///< The depth of the entered element.
+  bool validate_ = false;  ///< Validation against the schema is requested.
+  bool consumed_ = false;  ///< The current node has been handed over.
+  bool skip_ = false;  ///< Skip the subtree of the consumed node.
+  bool end_ = false;  ///< The entered element is empty.
+  int index_ = 0;  ///< The number of child elements returned.
+  xmlError error_ = {};  ///< The first reading error.
+  xmlNode* last_ = nullptr;  ///< The last expanded copy.
+  bool retained_ = false;  ///< The last copy is to be kept.
+};
+
+/// Finds the files included into an XML document with XInclude directives.
+/// The directives of the included documents are followed transitively.
+///
+/// @param[in] file_path  The path to the document file.
+///
+/// @returns The paths to the included files in the order of discovery.
+///
+/// @throws IOError  The file is not available.
+/// @throws ParseError  There are XML parsing failures.
+std::vector<std::string> FindIncludes(const std::string& file_path);
+
 }  // namespace scram::xml
@@ -23,9 +23,11 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <numeric>
 
 #include <boost/range/algorithm.hpp>
 
+#include "event.h"
 #include "ext/algorithm.h"
 #include "ext/find_iterator.h"
 #include "logger.h"
@@ -47,6 +49,8 @@ namespace scram::core {
 void Zbdd::Log() noexcept {
   CHECK_ZBDD(false);
   LOG(DEBUG4) << "# of ZBDD nodes created: " << set_id_ - 1;
+  LOG(DEBUG4) << "Memory reserved for ZBDD nodes: "
+              << SetNode::pool_capacity() / 1024 << " KiB";
   LOG(DEBUG4) << "# of entries in unique table: " << unique_table_.size();
   LOG(DEBUG4) << "# of entries in AND table: " << and_table_.size();
   LOG(DEBUG4) << "# of entries in OR table: " << or_table_.size();
@@ -57,15 +61,63 @@ void Zbdd::Log() noexcept {
   ClearMarks(root_, false);
   LOG(DEBUG4) << "# of products: " << CountProducts(root_, false);
   ClearMarks(root_, false);
+  if (p_vars_)
+    LOG(DEBUG4) << "Truncation error: " << truncation_error_;
 }
 
-Zbdd::Zbdd(Bdd* bdd, const Settings& settings) noexcept
-    : Zbdd(bdd->root(), bdd->coherent(), bdd, settings) {
+Zbdd::Probabilities Zbdd::GetProbabilities(const Pdag& graph,
+                                           const Settings& settings) noexcept {
+  if (!settings.probability_analysis() || !settings.cut_off())
+    return nullptr;
+  auto p_vars = std::make_shared<Pdag::IndexMap<double>>();
+  p_vars->reserve(graph.basic_events().size());
+  for (const mef::BasicEvent* event : graph.basic_events())
+    p_vars->push_back(event->p());
+  return p_vars;
+}
+
+double Zbdd::CalculateProbabilitySum(
+    const Pdag::IndexMap<double>& p_vars) const noexcept {
+  std::unordered_map<const SetNode*, int> orders;
+  if (GetExpandedOrder(root_, &orders) <= kSettings_.limit_order()) {
+    std::unordered_map<const SetNode*, double> sums;
+    return SumProbabilities(root_, p_vars, &sums);
+  }
+  // Expanded module products may exceed the limit order.
+  std::unordered_map<const SetNode*, std::vector<double>> sums;
+  std::vector<double> order_sums(kSettings_.limit_order() + 1);
+  AddOrderSums(root_, 0, 1, p_vars, &sums, &order_sums);
+  return std::accumulate(order_sums.begin(), order_sums.end(), 0.0);
+}
+
+bool Zbdd::CalculateProbabilitySums(const double* p_lanes, int num_lanes,
+                                    double* sums) const noexcept {
+  std::unordered_map<const SetNode*, int> orders;
+  if (GetExpandedOrder(root_, &orders) > kSettings_.limit_order())
+    return false;
+  std::unordered_map<const SetNode*, int> offsets;
+  std::vector<double> lanes(2 * num_lanes);  // The empty and base sets.
+  std::fill_n(lanes.begin() + num_lanes, num_lanes, 1);
+  int offset = SumProbabilities(root_, p_lanes, num_lanes, &offsets, &lanes);
+  std::copy_n(&lanes[offset], num_lanes, sums);
+  return true;
+}
+
+double Zbdd::truncation_error() const {
+  double error = truncation_error_;
+  for (const auto& entry : modules_)
+    error += entry.second->truncation_error();
+  return error;
+}
+
+Zbdd::Zbdd(Bdd* bdd, const Settings& settings, const Pdag* graph) noexcept
+    : Zbdd(bdd->root(), bdd->coherent(), bdd, settings,
+           graph ? GetProbabilities(*graph, settings) : nullptr) {
   CHECK_ZBDD(true);
 }
 
 Zbdd::Zbdd(const Pdag* graph, const Settings& settings) noexcept
-    : Zbdd(graph->root(), settings) {
+    : Zbdd(graph->root(), settings, GetProbabilities(*graph, settings)) {
   assert(!graph->complement() && "Complements must be propagated.");
   if (graph->IsTrivial()) {
     const Gate& top_gate = graph->root();
@@ -93,7 +145,7 @@ void Zbdd::Analyze(const Pdag* graph) noexcept {
   for (const auto& entry : modules_)
     entry.second->Analyze();
 
-  Prune(root_, kSettings_.limit_order());
+  root_ = Prune(root_, kSettings_.limit_order(), cut_off());
   if (graph)
     ApplySubstitutions(graph->substitutions());
 
@@ -101,18 +153,22 @@ void Zbdd::Analyze(const Pdag* graph) noexcept {
   LOG(DEBUG3) << "G" << module_index_ << " analysis time: " << DUR(zbdd_time);
 }
 
-Zbdd::Zbdd(const Settings& settings, bool coherent, int module_index) noexcept
+Zbdd::Zbdd(const Settings& settings, bool coherent, int module_index,
+           Probabilities p_vars) noexcept
     : kBase_(new Terminal<SetNode>(true)),
       kEmpty_(new Terminal<SetNode>(false)),
       kSettings_(settings),
       root_(kEmpty_),
       coherent_(coherent),
       module_index_(module_index),
+      p_vars_(std::move(p_vars)),
+      truncation_error_(0),
       set_id_(2) {}
 
 Zbdd::Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
-           const Settings& settings, int module_index) noexcept
-    : Zbdd(settings, coherent, module_index) {
+           const Settings& settings, Probabilities p_vars,
+           int module_index) noexcept
+    : Zbdd(settings, coherent, module_index, std::move(p_vars)) {
   CLOCK(init_time);
   LOG(DEBUG2) << "Creating ZBDD from BDD: G" << module_index;
   LOG(DEBUG4) << "Limit on product order: " << settings.limit_order();
@@ -120,10 +176,16 @@ Zbdd::Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
   root_ = Minimize(ConvertBdd(module.vertex, module.complement, bdd,
                               kSettings_.limit_order(), &ites));
   assert(root_->terminal() || SetNode::Ref(root_).minimal());
+  if (p_vars_) {
+    LOG(DEBUG4) << "Cut-off probability for products: " << cut_off();
+    root_ = Prune(root_, kSettings_.limit_order(), cut_off());
+    ClearTables();
+  }
   Log();
   LOG(DEBUG2) << "Created ZBDD from BDD in " << DUR(init_time);
   std::map<int, std::pair<bool, int>> sub_modules;
   GatherModules(root_, 0, &sub_modules);
+  std::unordered_map<int, double> cut_offs = GatherModuleCutOffs();
   for (const auto& entry : sub_modules) {
     int index = entry.first;
     assert(!modules_.count(index) && "Recalculating modules.");
@@ -138,9 +200,11 @@ Zbdd::Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
     }
     Settings adjusted(settings);
     adjusted.limit_order(limit);
+    if (auto it = ext::find(cut_offs, index))
+      adjusted.cut_off(it->second);
     sub.complement ^= index < 0;
-    JoinModule(index, std::unique_ptr<Zbdd>(new Zbdd(sub, module_coherence, bdd,
-                                                     adjusted, index)));
+    JoinModule(index, std::unique_ptr<Zbdd>(new Zbdd(
+                          sub, module_coherence, bdd, adjusted, p_vars_, index)));
   }
   if (ext::any_of(modules_, [](const ModuleEntry& member) {
         return member.second->root_->terminal();
@@ -151,8 +215,9 @@ Zbdd::Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
   }
 }
 
-Zbdd::Zbdd(const Gate& gate, const Settings& settings) noexcept
-    : Zbdd(settings, gate.coherent(), gate.index()) {
+Zbdd::Zbdd(const Gate& gate, const Settings& settings,
+           Probabilities p_vars) noexcept
+    : Zbdd(settings, gate.coherent(), gate.index(), std::move(p_vars)) {
   if (gate.constant() || gate.type() == kNull)
     return;
   assert(!settings.prime_implicants() && "Not implemented.");
@@ -174,6 +239,7 @@ Zbdd::Zbdd(const Gate& gate, const Settings& settings) noexcept
   LOG(DEBUG3) << "Finished module conversion to ZBDD in " << DUR(init_time);
   std::map<int, std::pair<bool, int>> sub_modules;
   GatherModules(root_, 0, &sub_modules);
+  std::unordered_map<int, double> cut_offs = GatherModuleCutOffs();
   for (const auto& entry : sub_modules) {
     int index = entry.first;
     assert(index > 0 && "No complement gates.");
@@ -188,7 +254,10 @@ Zbdd::Zbdd(const Gate& gate, const Settings& settings) noexcept
     const Gate* module_gate = module_gates.find(index)->second;
     Settings adjusted(settings);
     adjusted.limit_order(limit);
-    JoinModule(index, std::unique_ptr<Zbdd>(new Zbdd(*module_gate, adjusted)));
+    if (auto it = ext::find(cut_offs, index))
+      adjusted.cut_off(it->second);
+    JoinModule(index, std::unique_ptr<Zbdd>(
+                          new Zbdd(*module_gate, adjusted, p_vars_)));
   }
   EliminateConstantModules();
 }
@@ -212,6 +281,12 @@ SetNodePtr Zbdd::FindOrAddVertex(int index, const VertexPtr& high,
   high_order += !MayBeUnity(*node);
   int low_order = low->terminal() ? 0 : SetNode::Ref(low).max_set_order();
   node->max_set_order(std::max(high_order, low_order));
+  double p = GetProbability(*node);
+  double high_min = high->terminal() ? 1 : SetNode::Ref(high).min_p();
+  node->min_p(low->terminal()
+                  ? p * high_min  // The terminal Base set is not minimal.
+                  : std::min(p * high_min, SetNode::Ref(low).min_p()));
+  node->sum_p(p * GetSumProbability(high) + GetSumProbability(low));
 
   in_table = node;
   return node;
@@ -358,7 +433,8 @@ Zbdd::VertexPtr Zbdd::ConvertGraph(
   });
   auto it = args.cbegin();
   for (result = *it++; it != args.cend(); ++it) {
-    result = Apply(gate.type(), result, *it, kSettings_.limit_order());
+    result = Apply(gate.type(), result, *it, kSettings_.limit_order(),
+                   cut_off());
   }
   ClearTables();
   assert(result);
@@ -369,57 +445,78 @@ Zbdd::VertexPtr Zbdd::ConvertGraph(
   return result;
 }
 
-Triplet Zbdd::GetResultKey(const VertexPtr& arg_one, const VertexPtr& arg_two,
-                           int order) noexcept {
+std::pair<Triplet, double> Zbdd::GetResultKey(const VertexPtr& arg_one,
+                                              const VertexPtr& arg_two,
+                                              int order,
+                                              double cut_off) noexcept {
   assert(order >= 0 && "Illegal order for computations.");
   assert(!arg_one->terminal() && !arg_two->terminal());
   assert(arg_one->id() && arg_two->id());
   assert(arg_one->id() != arg_two->id());
   int min_id = std::min(arg_one->id(), arg_two->id());
   int max_id = std::max(arg_one->id(), arg_two->id());
-  return {min_id, max_id, order};
+  return {{min_id, max_id, order}, cut_off};
+}
+
+Zbdd::VertexPtr Zbdd::Discard(double sum_p, double cut_off) noexcept {
+  assert(cut_off > 0 && "Discarding sets without the cut-off.");
+  // The cut-off is relative to the probability of the path to the vertex.
+  truncation_error_ += sum_p * (kSettings_.cut_off() / cut_off);
+  return kEmpty_;
+}
+
+double Zbdd::GetProbability(const SetNode& node) noexcept {
+  if (!p_vars_ || node.module() || MayBeUnity(node))
+    return 1;
+  if (node.index() < 0)
+    return 1 - (*p_vars_)[-node.index()];
+  return (*p_vars_)[node.index()];
 }
 
 /// Forward declarations of interdependent Apply operation specializations.
 /// @{
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
-                                  const VertexPtr& arg_two,
-                                  int limit_order) noexcept;
+                                  const VertexPtr& arg_two, int limit_order,
+                                  double cut_off) noexcept;
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kOr>(const VertexPtr& arg_one,
-                                 const VertexPtr& arg_two,
-                                 int limit_order) noexcept;
+                                 const VertexPtr& arg_two, int limit_order,
+                                 double cut_off) noexcept;
 /// @}
 
 /// Specialization of Apply for AND connective for non-terminal ZBDD vertices.
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kAnd>(const SetNodePtr& arg_one,
-                                  const SetNodePtr& arg_two,
-                                  int limit_order) noexcept {
+                                  const SetNodePtr& arg_two, int limit_order,
+                                  double cut_off) noexcept {
   VertexPtr high;
   VertexPtr low;
   int limit_high = limit_order - !MayBeUnity(*arg_one);
+  double cut_off_high = cut_off / GetProbability(*arg_one);
   if (arg_one->order() == arg_two->order() &&
       arg_one->index() == arg_two->index()) {  // The same variable.
     // (x*f1 + f0) * (x*g1 + g0) = x*(f1*(g1 + g0) + f0*g1) + f0*g0
     high = Apply<kOr>(
         Apply<kAnd>(arg_one->high(),
-                    Apply<kOr>(arg_two->high(), arg_two->low(), limit_high),
-                    limit_high),
-        Apply<kAnd>(arg_one->low(), arg_two->high(), limit_high), limit_high);
-    low = Apply<kAnd>(arg_one->low(), arg_two->low(), limit_order);
+                    Apply<kOr>(arg_two->high(), arg_two->low(), limit_high,
+                               cut_off_high),
+                    limit_high, cut_off_high),
+        Apply<kAnd>(arg_one->low(), arg_two->high(), limit_high, cut_off_high),
+        limit_high, cut_off_high);
+    low = Apply<kAnd>(arg_one->low(), arg_two->low(), limit_order, cut_off);
   } else {
     assert((arg_one->order() < arg_two->order() ||
             arg_one->index() > arg_two->index()) &&
            "Ordering contract failed.");
     if (arg_one->order() == arg_two->order()) {
       // (x*f1 + f0) * (~x*g1 + g0) = x*f1*g0 + f0*(~x*g1 + g0)
-      high = Apply<kAnd>(arg_one->high(), arg_two->low(), limit_high);
+      high = Apply<kAnd>(arg_one->high(), arg_two->low(), limit_high,
+                         cut_off_high);
     } else {
-      high = Apply<kAnd>(arg_one->high(), arg_two, limit_high);
+      high = Apply<kAnd>(arg_one->high(), arg_two, limit_high, cut_off_high);
     }
-    low = Apply<kAnd>(arg_one->low(), arg_two, limit_order);
+    low = Apply<kAnd>(arg_one->low(), arg_two, limit_order, cut_off);
   }
   if (!high->terminal() && SetNode::Ref(high).order() == arg_one->order()) {
     assert(SetNode::Ref(high).index() < arg_one->index());
@@ -431,26 +528,34 @@ Zbdd::VertexPtr Zbdd::Apply<kAnd>(const SetNodePtr& arg_one,
 /// Specialization of Apply for AND connective for any ZBDD vertices.
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
-                                  const VertexPtr& arg_two,
-                                  int limit_order) noexcept {
+                                  const VertexPtr& arg_two, int limit_order,
+                                  double cut_off) noexcept {
   if (limit_order < 0)
     return kEmpty_;
+  // Any product of the sets is not more probable than its factors.
+  double sum_p =
+      std::min(GetSumProbability(arg_one), GetSumProbability(arg_two));
+  if (sum_p < cut_off)
+    return Discard(sum_p, cut_off);
   if (arg_one->terminal()) {
     if (Terminal<SetNode>::Ref(arg_one).value())
-      return Prune(arg_two, limit_order);
+      return Prune(arg_two, limit_order, cut_off);
     return kEmpty_;
   }
   if (arg_two->terminal()) {
     if (Terminal<SetNode>::Ref(arg_two).value())
-      return Prune(arg_one, limit_order);
+      return Prune(arg_one, limit_order, cut_off);
     return kEmpty_;
   }
   if (arg_one->id() == arg_two->id())
-    return Prune(arg_one, limit_order);
+    return Prune(arg_one, limit_order, cut_off);
 
-  VertexPtr& result = and_table_[GetResultKey(arg_one, arg_two, limit_order)];
-  if (result)
-    return result;  // Already computed.
+  Result& result =
+      and_table_[GetResultKey(arg_one, arg_two, limit_order, cut_off)];
+  if (result.first) {  // Already computed.
+    truncation_error_ += result.second;
+    return result.first;
+  }
 
   SetNodePtr set_one = SetNode::Ptr(arg_one);
   SetNodePtr set_two = SetNode::Ptr(arg_two);
@@ -460,24 +565,28 @@ Zbdd::VertexPtr Zbdd::Apply<kAnd>(const VertexPtr& arg_one,
              set_one->index() < set_two->index()) {
     std::swap(set_one, set_two);
   }
-  result = Apply<kAnd>(set_one, set_two, limit_order);
-  assert(result->terminal() ||
-         SetNode::Ref(result).max_set_order() <= limit_order);
-  return result;
+  double init_error = truncation_error_;
+  result.first = Apply<kAnd>(set_one, set_two, limit_order, cut_off);
+  result.second = truncation_error_ - init_error;
+  assert(result.first->terminal() ||
+         SetNode::Ref(result.first).max_set_order() <= limit_order);
+  return result.first;
 }
 
 /// Specialization of Apply for OR connective for non-terminal ZBDD vertices.
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kOr>(const SetNodePtr& arg_one,
-                                 const SetNodePtr& arg_two,
-                                 int limit_order) noexcept {
+                                 const SetNodePtr& arg_two, int limit_order,
+                                 double cut_off) noexcept {
   VertexPtr high;
   VertexPtr low;
   int limit_high = limit_order - !MayBeUnity(*arg_one);
+  double cut_off_high = cut_off / GetProbability(*arg_one);
   if (arg_one->order() == arg_two->order() &&
       arg_one->index() == arg_two->index()) {  // The same variable.
-    high = Apply<kOr>(arg_one->high(), arg_two->high(), limit_high);
-    low = Apply<kOr>(arg_one->low(), arg_two->low(), limit_order);
+    high = Apply<kOr>(arg_one->high(), arg_two->high(), limit_high,
+                      cut_off_high);
+    low = Apply<kOr>(arg_one->low(), arg_two->low(), limit_order, cut_off);
   } else {
     assert((arg_one->order() < arg_two->order() ||
             arg_one->index() > arg_two->index()) &&
@@ -486,8 +595,8 @@ Zbdd::VertexPtr Zbdd::Apply<kOr>(const SetNodePtr& arg_one,
       if (arg_one->high()->terminal() && arg_two->high()->terminal())
         return kBase_;
     }
-    high = Prune(arg_one->high(), limit_high);
-    low = Apply<kOr>(arg_one->low(), arg_two, limit_order);
+    high = Prune(arg_one->high(), limit_high, cut_off_high);
+    low = Apply<kOr>(arg_one->low(), arg_two, limit_order, cut_off);
   }
   if (!high->terminal() && SetNode::Ref(high).order() == arg_one->order()) {
     assert(SetNode::Ref(high).index() < arg_one->index());
@@ -499,26 +608,32 @@ Zbdd::VertexPtr Zbdd::Apply<kOr>(const SetNodePtr& arg_one,
 /// Specialization of Apply for OR connective for any ZBDD vertices.
 template <>
 Zbdd::VertexPtr Zbdd::Apply<kOr>(const VertexPtr& arg_one,
-                                 const VertexPtr& arg_two,
-                                 int limit_order) noexcept {
+                                 const VertexPtr& arg_two, int limit_order,
+                                 double cut_off) noexcept {
   if (limit_order < 0)
     return kEmpty_;
+  double sum_p = GetSumProbability(arg_one) + GetSumProbability(arg_two);
+  if (sum_p < cut_off)
+    return Discard(sum_p, cut_off);
   if (arg_one->terminal()) {
     if (Terminal<SetNode>::Ref(arg_one).value())
       return kBase_;
-    return Prune(arg_two, limit_order);
+    return Prune(arg_two, limit_order, cut_off);
   }
   if (arg_two->terminal()) {
     if (Terminal<SetNode>::Ref(arg_two).value())
       return kBase_;
-    return Prune(arg_one, limit_order);
+    return Prune(arg_one, limit_order, cut_off);
   }
   if (arg_one->id() == arg_two->id())
-    return Prune(arg_one, limit_order);
+    return Prune(arg_one, limit_order, cut_off);
 
-  VertexPtr& result = or_table_[GetResultKey(arg_one, arg_two, limit_order)];
-  if (result)
-    return result;  // Already computed.
+  Result& result =
+      or_table_[GetResultKey(arg_one, arg_two, limit_order, cut_off)];
+  if (result.first) {  // Already computed.
+    truncation_error_ += result.second;
+    return result.first;
+  }
 
   SetNodePtr set_one = SetNode::Ptr(arg_one);
   SetNodePtr set_two = SetNode::Ptr(arg_two);
@@ -528,19 +643,21 @@ Zbdd::VertexPtr Zbdd::Apply<kOr>(const VertexPtr& arg_one,
              set_one->index() < set_two->index()) {
     std::swap(set_one, set_two);
   }
-  result = Apply<kOr>(set_one, set_two, limit_order);
-  assert(result->terminal() ||
-         SetNode::Ref(result).max_set_order() <= limit_order);
-  return result;
+  double init_error = truncation_error_;
+  result.first = Apply<kOr>(set_one, set_two, limit_order, cut_off);
+  result.second = truncation_error_ - init_error;
+  assert(result.first->terminal() ||
+         SetNode::Ref(result.first).max_set_order() <= limit_order);
+  return result.first;
 }
 
 Zbdd::VertexPtr Zbdd::Apply(Connective type, const VertexPtr& arg_one,
-                            const VertexPtr& arg_two,
-                            int limit_order) noexcept {
+                            const VertexPtr& arg_two, int limit_order,
+                            double cut_off) noexcept {
   if (type == kAnd)
-    return Apply<kAnd>(arg_one, arg_two, limit_order);
+    return Apply<kAnd>(arg_one, arg_two, limit_order, cut_off);
   assert(type == kOr && "Only normalized operations in BDD.");
-  return Apply<kOr>(arg_one, arg_two, limit_order);
+  return Apply<kOr>(arg_one, arg_two, limit_order, cut_off);
 }
 
 Zbdd::VertexPtr Zbdd::EliminateComplements(
@@ -567,7 +684,7 @@ Zbdd::VertexPtr Zbdd::EliminateComplement(const SetNodePtr& node,
   assert(low->terminal() ||
          SetNode::Ref(low).max_set_order() <= kSettings_.limit_order());
   if (node->index() < 0 && !(node->module() && !node->coherent()))
-    return Apply<kOr>(high, low, kSettings_.limit_order());
+    return Apply<kOr>(high, low, kSettings_.limit_order(), cut_off());
   return Minimize(GetReducedVertex(node, high, low));
 }
 
@@ -604,7 +721,7 @@ Zbdd::VertexPtr Zbdd::EliminateConstantModule(const SetNodePtr& node,
     if (module->root_->terminal()) {
       if (!Terminal<SetNode>::Ref(module->root_).value())
         return low;
-      return Apply<kOr>(high, low, kSettings_.limit_order());
+      return Apply<kOr>(high, low, kSettings_.limit_order(), cut_off());
     }
   }
   return Minimize(GetReducedVertex(node, high, low));
@@ -676,26 +793,36 @@ Zbdd::VertexPtr Zbdd::Subsume(const VertexPtr& high,
   return computed;
 }
 
-Zbdd::VertexPtr Zbdd::Prune(const VertexPtr& vertex, int limit_order) noexcept {
+Zbdd::VertexPtr Zbdd::Prune(const VertexPtr& vertex, int limit_order,
+                            double cut_off) noexcept {
   if (limit_order < 0)
     return kEmpty_;
+  double sum_p = GetSumProbability(vertex);
+  if (sum_p < cut_off)
+    return Discard(sum_p, cut_off);
   if (vertex->terminal())
     return vertex;
 
   SetNodePtr node = SetNode::Ptr(vertex);
-  if (node->max_set_order() <= limit_order)
+  if (node->max_set_order() <= limit_order && node->min_p() >= cut_off)
     return node;
 
-  VertexPtr& result = prune_results_[{node->id(), limit_order}];
-  if (result)
-    return result;
+  Result& result = prune_results_[{{node->id(), limit_order}, cut_off}];
+  if (result.first) {
+    truncation_error_ += result.second;
+    return result.first;
+  }
 
+  double init_error = truncation_error_;
   int limit_high = limit_order - !MayBeUnity(*node);
-  result = GetReducedVertex(node, Prune(node->high(), limit_high),
-                            Prune(node->low(), limit_order));
-  if (!result->terminal())
-    SetNode::Ref(result).minimal(node->minimal());
-  return result;
+  double cut_off_high = cut_off / GetProbability(*node);
+  result.first = GetReducedVertex(
+      node, Prune(node->high(), limit_high, cut_off_high),
+      Prune(node->low(), limit_order, cut_off));
+  result.second = truncation_error_ - init_error;
+  if (!result.first->terminal())
+    SetNode::Ref(result.first).minimal(node->minimal());
+  return result.first;
 }
 
 bool Zbdd::MayBeUnity(const SetNode& node) noexcept {
@@ -741,6 +868,42 @@ int Zbdd::GatherModules(const VertexPtr& vertex, int current_order,
   return std::min(min_high + contribution, min_low);
 }
 
+std::unordered_map<int, double> Zbdd::GatherModuleCutOffs() noexcept {
+  std::unordered_map<int, double> cut_offs;
+  if (p_vars_) {
+    std::unordered_map<int, double> visits;
+    GatherModuleCutOffs(root_, 1, &visits, &cut_offs);
+  }
+  return cut_offs;
+}
+
+void Zbdd::GatherModuleCutOffs(
+    const VertexPtr& vertex, double path_p,
+    std::unordered_map<int, double>* visits,
+    std::unordered_map<int, double>* cut_offs) noexcept {
+  if (vertex->terminal())
+    return;
+  auto [it_visit, first_visit] = visits->emplace(vertex->id(), path_p);
+  if (!first_visit) {
+    if (it_visit->second >= path_p)
+      return;  // No more probable products through this vertex.
+    it_visit->second = path_p;
+  }
+  SetNode& node = SetNode::Ref(vertex);
+  if (node.module()) {
+    // The module sets are extended with the rest of the product.
+    double context_p = path_p * GetSumProbability(node.high());
+    double cut_off =
+        context_p > kSettings_.cut_off() ? kSettings_.cut_off() / context_p : 1;
+    auto [it, inserted] = cut_offs->emplace(node.index(), cut_off);
+    if (!inserted)
+      it->second = std::min(it->second, cut_off);
+  }
+  GatherModuleCutOffs(node.high(), path_p * GetProbability(node), visits,
+                      cut_offs);
+  GatherModuleCutOffs(node.low(), path_p, visits, cut_offs);
+}
+
 void Zbdd::ApplySubstitutions(
     const std::vector<Pdag::Substitution>& substitutions) noexcept {
   if (substitutions.empty())
@@ -768,14 +931,15 @@ void Zbdd::ApplySubstitutions(
         continue;
       new_product = Apply<kAnd>(
           new_product, FindOrAddVertex(id, kBase_, kEmpty_, std::abs(id)),
-          kSettings_.limit_order());
+          kSettings_.limit_order(), cut_off());
     }
     for (int id : to_add) {
       new_product = Apply<kAnd>(
           new_product, FindOrAddVertex(id, kBase_, kEmpty_, std::abs(id)),
-          kSettings_.limit_order());
+          kSettings_.limit_order(), cut_off());
     }
-    new_root = Apply<kOr>(new_root, new_product, kSettings_.limit_order());
+    new_root =
+        Apply<kOr>(new_root, new_product, kSettings_.limit_order(), cut_off());
   }
   root_ = std::move(new_root);
   root_ = Minimize(root_);
@@ -791,6 +955,117 @@ int Zbdd::CountSetNodes(const VertexPtr& vertex) noexcept {
   return 1 + CountSetNodes(node.high()) + CountSetNodes(node.low());
 }
 
+int Zbdd::GetExpandedOrder(
+    const VertexPtr& vertex,
+    std::unordered_map<const SetNode*, int>* orders) const noexcept {
+  if (vertex->terminal())
+    return 0;
+  const SetNode& node = SetNode::Ref(vertex);
+  if (auto it = orders->find(&node); it != orders->end())
+    return it->second;
+  int order = 1;
+  if (node.module()) {
+    const Zbdd& module = *modules_.find(node.index())->second;
+    order = module.GetExpandedOrder(module.root_, orders);
+  }
+  int result = std::max(order + GetExpandedOrder(node.high(), orders),
+                        GetExpandedOrder(node.low(), orders));
+  orders->emplace(&node, result);
+  return result;
+}
+
+double Zbdd::SumProbabilities(
+    const VertexPtr& vertex, const Pdag::IndexMap<double>& p_vars,
+    std::unordered_map<const SetNode*, double>* sums) const noexcept {
+  if (vertex->terminal())
+    return Terminal<SetNode>::Ref(vertex).value();
+  const SetNode& node = SetNode::Ref(vertex);
+  if (auto it = sums->find(&node); it != sums->end())
+    return it->second;
+  double p = 0;
+  if (node.module()) {
+    const Zbdd& module = *modules_.find(node.index())->second;
+    p = module.SumProbabilities(module.root_, p_vars, sums);
+  } else {
+    assert(node.index() > 0 && "Complements in a product.");
+    p = p_vars[node.index()];
+  }
+  double sum = p * SumProbabilities(node.high(), p_vars, sums) +
+               SumProbabilities(node.low(), p_vars, sums);
+  sums->emplace(&node, sum);
+  return sum;
+}
+
+int Zbdd::SumProbabilities(const VertexPtr& vertex, const double* p_lanes,
+                           int num_lanes,
+                           std::unordered_map<const SetNode*, int>* offsets,
+                           std::vector<double>* sums) const noexcept {
+  if (vertex->terminal())
+    return Terminal<SetNode>::Ref(vertex).value() ? num_lanes : 0;
+  const SetNode& node = SetNode::Ref(vertex);
+  if (auto it = offsets->find(&node); it != offsets->end())
+    return it->second;
+  const double* p = nullptr;
+  int module_offset = 0;
+  if (node.module()) {
+    const Zbdd& module = *modules_.find(node.index())->second;
+    module_offset = module.SumProbabilities(module.root_, p_lanes, num_lanes,
+                                            offsets, sums);
+  } else {
+    assert(node.index() > 0 && "Complements in a product.");
+    p = p_lanes + (node.index() - Pdag::kVariableStartIndex) * num_lanes;
+  }
+  int high = SumProbabilities(node.high(), p_lanes, num_lanes, offsets, sums);
+  int low = SumProbabilities(node.low(), p_lanes, num_lanes, offsets, sums);
+  int offset = sums->size();
+  sums->resize(offset + num_lanes);
+  double* result = &(*sums)[offset];
+  const double* high_sums = &(*sums)[high];
+  const double* low_sums = &(*sums)[low];
+  if (!p)
+    p = &(*sums)[module_offset];
+  for (int lane = 0; lane < num_lanes; ++lane)  // This should get vectorized.
+    result[lane] = p[lane] * high_sums[lane] + low_sums[lane];
+  offsets->emplace(&node, offset);
+  return offset;
+}
+
+void Zbdd::AddOrderSums(
+    const VertexPtr& vertex, int shift, double factor,
+    const Pdag::IndexMap<double>& p_vars,
+    std::unordered_map<const SetNode*, std::vector<double>>* sums,
+    std::vector<double>* result) const noexcept {
+  int limit_order = kSettings_.limit_order();
+  if (vertex->terminal()) {
+    if (Terminal<SetNode>::Ref(vertex).value() && shift <= limit_order)
+      (*result)[shift] += factor;
+    return;
+  }
+  const SetNode& node = SetNode::Ref(vertex);
+  auto it = sums->find(&node);
+  if (it == sums->end()) {
+    std::vector<double> node_sums(limit_order + 1);
+    if (node.module()) {
+      const Zbdd& module = *modules_.find(node.index())->second;
+      std::vector<double> module_sums(limit_order + 1);
+      module.AddOrderSums(module.root_, 0, 1, p_vars, sums, &module_sums);
+      for (int order = 0; order <= limit_order; ++order) {
+        if (module_sums[order])
+          AddOrderSums(node.high(), order, module_sums[order], p_vars, sums,
+                       &node_sums);
+      }
+    } else {
+      assert(node.index() > 0 && "Complements in a product.");
+      AddOrderSums(node.high(), 1, p_vars[node.index()], p_vars, sums,
+                   &node_sums);
+    }
+    AddOrderSums(node.low(), 0, 1, p_vars, sums, &node_sums);
+    it = sums->emplace(&node, std::move(node_sums)).first;
+  }
+  for (int order = 0; order + shift <= limit_order; ++order)
+    (*result)[order + shift] += factor * it->second[order];
+}
+
 std::int64_t Zbdd::CountProducts(const VertexPtr& vertex,
                                  bool modules) noexcept {
   if (vertex->terminal())
@@ -883,8 +1158,9 @@ void Zbdd::TestStructure(const VertexPtr& vertex, bool modules) noexcept {
 namespace zbdd {
 
 CutSetContainer::CutSetContainer(const Settings& settings, int module_index,
-                                 int gate_index_bound) noexcept
-    : Zbdd(settings, /*coherence=*/false, module_index),
+                                 int gate_index_bound,
+                                 Probabilities p_vars) noexcept
+    : Zbdd(settings, /*coherence=*/false, module_index, std::move(p_vars)),
       gate_index_bound_(gate_index_bound) {}
 
 Zbdd::VertexPtr CutSetContainer::ConvertGate(const Gate& gate) noexcept {
@@ -906,7 +1182,8 @@ Zbdd::VertexPtr CutSetContainer::ConvertGate(const Gate& gate) noexcept {
   auto it = args.cbegin();
   VertexPtr result = *it;
   for (++it; it != args.cend(); ++it) {
-    result = Apply(gate.type(), result, *it, settings().limit_order());
+    result =
+        Apply(gate.type(), result, *it, settings().limit_order(), cut_off());
   }
   ClearTables();
   return result;
@@ -930,13 +1207,14 @@ Zbdd::VertexPtr CutSetContainer::ExpandGate(
          SetNode::Ref(gate_zbdd).max_set_order() <= settings().limit_order());
   assert(cut_sets->terminal() ||
          SetNode::Ref(cut_sets).max_set_order() <= settings().limit_order());
-  return Apply<kAnd>(gate_zbdd, cut_sets, settings().limit_order());
+  return Apply<kAnd>(gate_zbdd, cut_sets, settings().limit_order(),
+                     cut_off());
 }
 
 void CutSetContainer::Merge(const VertexPtr& vertex) noexcept {
   assert(vertex->terminal() ||
          SetNode::Ref(vertex).max_set_order() <= settings().limit_order());
-  root(Apply<kOr>(root(), vertex, settings().limit_order()));
+  root(Apply<kOr>(root(), vertex, settings().limit_order(), cut_off()));
   ClearTables();
 }
 
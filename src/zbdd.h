@@ -62,6 +62,26 @@ class SetNode : public NonTerminal<SetNode> {
   /// @param[in] order  The order/size of the largest set.
   void max_set_order(int order) { max_set_order_ = order; }
 
+  /// @returns The upper bound of the probability
+  ///          of the least probable set in the ZBDD.
+  double min_p() const { return min_p_; }
+
+  /// Registers the upper bound of the probability
+  /// of the least probable set in the ZBDD represented by this vertex.
+  ///
+  /// @param[in] p  The probability bound of the least probable set.
+  void min_p(double p) { min_p_ = p; }
+
+  /// @returns The upper bound of the sum of probabilities
+  ///          of the sets in the ZBDD.
+  double sum_p() const { return sum_p_; }
+
+  /// Registers the upper bound of the sum of probabilities
+  /// of the sets in the ZBDD represented by this vertex.
+  ///
+  /// @param[in] p  The upper bound for the sum of set probabilities.
+  void sum_p(double p) { sum_p_ = p; }
+
   /// @returns Whatever count is stored in this node.
   std::int64_t count() const { return count_; }
 
@@ -84,6 +104,8 @@ class SetNode : public NonTerminal<SetNode> {
   bool minimal_ = false;  ///< A flag for minimized collection of sets.
   int max_set_order_ = 0;  ///< The order of the largest set in the ZBDD.
   std::int64_t count_ = 0;  ///< The number of products, nodes, or anything.
+  double min_p_ = 1;  ///< The probability of the least probable set.
+  double sum_p_ = 1;  ///< The sum of probabilities of the sets.
 };
 
 using SetNodePtr = IntrusivePtr<SetNode>;  ///< Shared ZBDD set nodes.
@@ -126,11 +148,40 @@ struct TripletHash {
 template <typename Value>
 using TripletTable = std::unordered_map<Triplet, Value, TripletHash>;
 
+/// Functor for hashing computation keys with the probability cut-off.
+///
+/// @tparam Key  The integer part of the key.
+/// @tparam Hash  The hash functor for the integer part of the key.
+template <class Key, class Hash>
+struct CutOffHash {
+  /// Operator overload for hashing keys with cut-off probabilities.
+  ///
+  /// @param[in] key  The integer key and the cut-off probability.
+  ///
+  /// @returns Hash value of the key.
+  std::size_t operator()(const std::pair<Key, double>& key) const noexcept {
+    std::size_t seed = Hash()(key.first);
+    boost::hash_combine(seed, key.second);
+    return seed;
+  }
+};
+
+/// Hash table with integer keys accompanied by the cut-off probability.
+///
+/// @tparam Key  The integer part of the key.
+/// @tparam Hash  The hash functor for the integer part of the key.
+/// @tparam Value  Type of values to be stored in the table.
+template <class Key, class Hash, typename Value>
+using CutOffTable =
+    std::unordered_map<std::pair<Key, double>, Value, CutOffHash<Key, Hash>>;
+
 /// Zero-Suppressed Binary Decision Diagrams for set manipulations.
 class Zbdd : private boost::noncopyable {
  public:
   using VertexPtr = IntrusivePtr<Vertex<SetNode>>;  ///< ZBDD vertex base.
   using TerminalPtr = IntrusivePtr<Terminal<SetNode>>;  ///< Terminal vertex.
+  /// Shared probabilities of variables for the cut-off on products.
+  using Probabilities = std::shared_ptr<const Pdag::IndexMap<double>>;
 
   /// Iterator over products in a ZBDD container.
   /// The implementation is complicated with the incorporation of modules.
@@ -314,6 +365,9 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] bdd  ROBDD with the ITE vertices.
   /// @param[in] settings  Settings for analysis.
   ///
+  /// @param[in] graph  The optional PDAG with variable probabilities
+  ///                   for the cut-off on products.
+  ///
   /// @pre BDD has attributed edges with only one terminal (1/True).
   ///
   /// @post The input BDD structure is not changed.
@@ -321,7 +375,8 @@ class Zbdd : private boost::noncopyable {
   /// @note The input BDD is not passed as a constant
   ///       because ZBDD needs BDD facilities to calculate prime implicants.
   ///       However, ZBDD guarantees to preserve the original BDD structure.
-  Zbdd(Bdd* bdd, const Settings& settings) noexcept;
+  Zbdd(Bdd* bdd, const Settings& settings,
+       const Pdag* graph = nullptr) noexcept;
 
   /// Constructor with the analysis target.
   /// ZBDD is directly produced from a PDAG.
@@ -364,14 +419,67 @@ class Zbdd : private boost::noncopyable {
   /// @returns true if the ZBDD represents a base/unity set.
   bool base() const { return root_ == kBase_; }
 
+  /// @returns The estimate of the total probability of products
+  ///          discarded by the cut-off (including modules).
+  ///          0 if the cut-off is not applied.
+  double truncation_error() const;
+
+  /// Calculates the sum of probabilities of products
+  /// (the rare-event approximation)
+  /// with memoized traversal of the ZBDD graph including modules.
+  /// In contrast to iteration over products,
+  /// the cost is proportional to the size of the ZBDD.
+  ///
+  /// @param[in] p_vars  Probabilities of variables mapped by their indices.
+  ///
+  /// @returns The sum of probabilities of products.
+  ///
+  /// @pre Products contain no complements.
+  /// @note The graph is not modified,
+  ///       so the calculation can run concurrently.
+  double CalculateProbabilitySum(
+      const Pdag::IndexMap<double>& p_vars) const noexcept;
+
+  /// Calculates the sums of probabilities of products
+  /// for many sets of variable probabilities in one traversal.
+  ///
+  /// @param[in] p_lanes  The lanes of probabilities of variables
+  ///                     laid out variable after variable
+  ///                     in the order of the variable indices.
+  /// @param[in] num_lanes  The number of lanes per variable.
+  /// @param[out] sums  The sums of probabilities of products per lane.
+  ///
+  /// @returns false if expanded module products may exceed the limit order,
+  ///          so the sums must be calculated per set of probabilities.
+  ///
+  /// @pre Products contain no complements.
+  /// @note The graph is not modified,
+  ///       so the calculation can run concurrently.
+  bool CalculateProbabilitySums(const double* p_lanes, int num_lanes,
+                                double* sums) const noexcept;
+
+  /// Gathers the variable probabilities
+  /// if the settings require the cut-off on product probabilities.
+  /// The cut-off applies only with probability analysis,
+  /// for probabilities of events may not be initialized otherwise.
+  ///
+  /// @param[in] graph  The PDAG with the variables.
+  /// @param[in] settings  The analysis settings.
+  ///
+  /// @returns Probabilities of variables mapped by their indices.
+  /// @returns nullptr if the cut-off is not applicable.
+  static Probabilities GetProbabilities(const Pdag& graph,
+                                        const Settings& settings) noexcept;
+
  protected:
   /// The common constructor to initialize member variables.
   ///
   /// @param[in] settings  Settings that control analysis complexity.
   /// @param[in] coherent  A flag for coherent modular functions.
   /// @param[in] module_index  The index of a module if known.
+  /// @param[in] p_vars  Variable probabilities for the cut-off on products.
   explicit Zbdd(const Settings& settings, bool coherent = false,
-                int module_index = 0) noexcept;
+                int module_index = 0, Probabilities p_vars = nullptr) noexcept;
 
   /// @returns Current root vertex of the ZBDD.
   const VertexPtr& root() const { return root_; }
@@ -384,6 +492,13 @@ class Zbdd : private boost::noncopyable {
   /// @returns Analysis setting with this ZBDD.
   const Settings& settings() const { return kSettings_; }
 
+  /// @returns The cut-off probability applied to products.
+  ///          0 if no cut-off is applied.
+  double cut_off() const { return p_vars_ ? kSettings_.cut_off() : 0; }
+
+  /// @returns Variable probabilities for the cut-off on products.
+  const Probabilities& p_vars() const { return p_vars_; }
+
   /// @returns A set of registered and fully processed modules;
   const std::map<int, std::unique_ptr<Zbdd>>& modules() const {
     return modules_;
@@ -432,13 +547,15 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] arg_one  First argument ZBDD set.
   /// @param[in] arg_two  Second argument ZBDD set.
   /// @param[in] limit_order  The limit on the order for the computations.
+  /// @param[in] cut_off  The cut-off probability for the computations.
   ///
   /// @returns The resulting ZBDD vertex.
   ///
   /// @post The limit on the set order is guaranteed.
+  /// @post The upper bound of set probabilities is not below the cut-off.
   template <Connective Type>
   VertexPtr Apply(const VertexPtr& arg_one, const VertexPtr& arg_two,
-                  int limit_order) noexcept;
+                  int limit_order, double cut_off) noexcept;
 
   /// Applies Boolean operation to two vertices representing sets.
   /// This is a convenience function
@@ -448,14 +565,17 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] arg_one  First argument ZBDD set.
   /// @param[in] arg_two  Second argument ZBDD set.
   /// @param[in] limit_order  The limit on the order for the computations.
+  /// @param[in] cut_off  The cut-off probability for the computations.
   ///
   /// @returns The resulting ZBDD vertex.
   ///
   /// @pre The connective is either AND or OR.
   ///
   /// @post The limit on the set order is guaranteed.
+  /// @post The upper bound of set probabilities is not below the cut-off.
   VertexPtr Apply(Connective type, const VertexPtr& arg_one,
-                  const VertexPtr& arg_two, int limit_order) noexcept;
+                  const VertexPtr& arg_two, int limit_order,
+                  double cut_off) noexcept;
 
   /// Applies Boolean operation to ZBDD graph non-terminal vertices.
   ///
@@ -464,13 +584,14 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] arg_one  First argument set vertex.
   /// @param[in] arg_two  Second argument set vertex.
   /// @param[in] limit_order  The limit on the order for the computations.
+  /// @param[in] cut_off  The cut-off probability for the computations.
   ///
   /// @returns The resulting ZBDD vertex.
   ///
   /// @pre Argument vertices are ordered.
   template <Connective Type>
   VertexPtr Apply(const SetNodePtr& arg_one, const SetNodePtr& arg_two,
-                  int limit_order) noexcept;
+                  int limit_order, double cut_off) noexcept;
 
   /// Removes complements of variables from products.
   /// This procedure only needs to be performed for non-coherent graphs
@@ -517,6 +638,14 @@ class Zbdd : private boost::noncopyable {
   int GatherModules(const VertexPtr& vertex, int current_order,
                     std::map<int, std::pair<bool, int>>* modules) noexcept;
 
+  /// Finds the cut-off probabilities for modules
+  /// adjusted to the most probable products containing the modules.
+  /// Modules within modules are not gathered.
+  ///
+  /// @returns A map of module indices and adjusted cut-off probabilities.
+  /// @returns Empty map if the cut-off is not applied.
+  std::unordered_map<int, double> GatherModuleCutOffs() noexcept;
+
   /// Applies non-declarative substitutions at the end of analysis.
   ///
   /// @param[in] substitutions  The substitutions defined in PDAG.
@@ -567,7 +696,10 @@ class Zbdd : private boost::noncopyable {
 
  private:
   using SetNodeWeakPtr = WeakIntrusivePtr<SetNode>;  ///< Pointer for tables.
-  using ComputeTable = TripletTable<VertexPtr>;  ///< General computation table.
+  /// Computation results with the probability of the discarded sets.
+  using Result = std::pair<VertexPtr, double>;
+  /// General computation table.
+  using ComputeTable = CutOffTable<Triplet, TripletHash, Result>;
   /// Module entry in the tables with its original gate index.
   using ModuleEntry = std::pair<const int, std::unique_ptr<Zbdd>>;
 
@@ -578,6 +710,7 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] coherent  A flag for coherent modular functions.
   /// @param[in] bdd  ROBDD with the ITE vertices.
   /// @param[in] settings  Settings for analysis.
+  /// @param[in] p_vars  Variable probabilities for the cut-off on products.
   /// @param[in] module_index  The of a module if known.
   ///
   /// @pre BDD has attributed edges with only one terminal (1/True).
@@ -588,7 +721,8 @@ class Zbdd : private boost::noncopyable {
   ///       because ZBDD needs BDD facilities to calculate prime implicants.
   ///       However, ZBDD guarantees to preserve the original BDD structure.
   Zbdd(const Bdd::Function& module, bool coherent, Bdd* bdd,
-       const Settings& settings, int module_index = 0) noexcept;
+       const Settings& settings, Probabilities p_vars,
+       int module_index = 0) noexcept;
 
   /// Constructs ZBDD from modular PDAGs.
   /// This constructor does not handle constant or single variable graphs.
@@ -600,10 +734,12 @@ class Zbdd : private boost::noncopyable {
   ///
   /// @param[in] gate  The root gate of a module.
   /// @param[in] settings  Analysis settings.
+  /// @param[in] p_vars  Variable probabilities for the cut-off on products.
   ///
   /// @post The root vertex pointer is uninitialized
   ///       if the PDAG is constant or single variable.
-  Zbdd(const Gate& gate, const Settings& settings) noexcept;
+  Zbdd(const Gate& gate, const Settings& settings,
+       Probabilities p_vars) noexcept;
 
   /// Finds a replacement for an existing node
   /// or adds a new node based on an existing node.
@@ -648,15 +784,18 @@ class Zbdd : private boost::noncopyable {
   /// @param[in] arg_one  First argument.
   /// @param[in] arg_two  Second argument.
   /// @param[in] limit_order  The limit on the order for the computations.
+  /// @param[in] cut_off  The cut-off probability for the computations.
   ///
-  /// @returns A triplet of integers for the computation key.
+  /// @returns A triplet of integers and the cut-off for the computation key.
   ///
   /// @pre The arguments are not the same functions.
   ///      Equal ID functions are handled by the reduction.
   /// @pre Even though the arguments are not SetNodePtr type,
   ///      they are ZBDD SetNode vertices.
-  Triplet GetResultKey(const VertexPtr& arg_one, const VertexPtr& arg_two,
-                       int limit_order) noexcept;
+  std::pair<Triplet, double> GetResultKey(const VertexPtr& arg_one,
+                                          const VertexPtr& arg_two,
+                                          int limit_order,
+                                          double cut_off) noexcept;
 
   /// Converts BDD graph into ZBDD graph.
   ///
@@ -768,16 +907,57 @@ class Zbdd : private boost::noncopyable {
   /// @returns Minimized high branch for a variable.
   VertexPtr Subsume(const VertexPtr& high, const VertexPtr& low) noexcept;
 
-  /// Prunes the ZBDD graph with the cut-off.
+  /// Prunes the ZBDD graph with the cut-offs.
   ///
   /// @param[in] vertex  The root vertex of the ZBDD.
   /// @param[in] limit_order  The cut-off order for the sets.
+  /// @param[in] cut_off  The cut-off probability for the sets.
   ///
   /// @returns The root vertex of the pruned ZBDD.
   ///
   /// @post If the ZBDD is minimal,
   ///       the resultant pruned ZBDD is minimal.
-  VertexPtr Prune(const VertexPtr& vertex, int limit_order) noexcept;
+  VertexPtr Prune(const VertexPtr& vertex, int limit_order,
+                  double cut_off) noexcept;
+
+  /// Discards sets with probabilities below the cut-off.
+  /// The probability of the discarded sets
+  /// is accounted in the truncation error.
+  ///
+  /// @param[in] sum_p  The upper bound of the sum of discarded probabilities.
+  /// @param[in] cut_off  The cut-off probability for the computations.
+  ///
+  /// @returns The terminal Empty set.
+  VertexPtr Discard(double sum_p, double cut_off) noexcept;
+
+  /// @param[in] vertex  The ZBDD vertex.
+  ///
+  /// @returns The upper bound of the sum of set probabilities.
+  static double GetSumProbability(const VertexPtr& vertex) noexcept {
+    if (vertex->terminal())
+      return Terminal<SetNode>::Ref(vertex).value();
+    return SetNode::Ref(vertex).sum_p();
+  }
+
+  /// Provides the probability of a node variable in products.
+  /// Gates, modules, and variables that may be approximated to Unity
+  /// are conservatively considered certain.
+  ///
+  /// @param[in] node  The set node with the variable.
+  ///
+  /// @returns The upper bound of the probability of the variable.
+  /// @returns 1 if the cut-off is not applied.
+  double GetProbability(const SetNode& node) noexcept;
+
+  /// Traverses ZBDD to find the cut-off probabilities for modules.
+  ///
+  /// @param[in] vertex  The root vertex to start with.
+  /// @param[in] path_p  The probability of the product from the top.
+  /// @param[in,out] visits  The most probable paths to the visited vertices.
+  /// @param[in,out] cut_offs  A map of module indices and cut-offs.
+  void GatherModuleCutOffs(const VertexPtr& vertex, double path_p,
+                           std::unordered_map<int, double>* visits,
+                           std::unordered_map<int, double>* cut_offs) noexcept;
 
   /// Checks if a set node represents a gate.
   /// Apply operations and truncation operations
@@ -817,6 +997,58 @@ class Zbdd : private boost::noncopyable {
   /// @pre SetNode marks are clear (false).
   std::int64_t CountProducts(const VertexPtr& vertex, bool modules) noexcept;
 
+  /// Finds the order of the largest product with modules expanded.
+  ///
+  /// @param[in] vertex  The root vertex of ZBDD.
+  /// @param[in,out] orders  The memoized orders of the visited nodes.
+  ///
+  /// @returns The upper bound for the order of the expanded products.
+  int GetExpandedOrder(
+      const VertexPtr& vertex,
+      std::unordered_map<const SetNode*, int>* orders) const noexcept;
+
+  /// Sums probabilities of all products in ZBDD.
+  ///
+  /// @param[in] vertex  The root vertex of ZBDD.
+  /// @param[in] p_vars  Probabilities of variables mapped by their indices.
+  /// @param[in,out] sums  The memoized sums of the visited nodes.
+  ///
+  /// @returns The sum of probabilities of products.
+  double SumProbabilities(
+      const VertexPtr& vertex, const Pdag::IndexMap<double>& p_vars,
+      std::unordered_map<const SetNode*, double>* sums) const noexcept;
+
+  /// Sums probabilities of all products in ZBDD across lanes.
+  ///
+  /// @param[in] vertex  The root vertex of ZBDD.
+  /// @param[in] p_lanes  The lanes of probabilities of variables.
+  /// @param[in] num_lanes  The number of lanes per variable.
+  /// @param[in,out] offsets  The memoized positions of the node sums.
+  /// @param[in,out] sums  The lanes of sums with the terminal sums upfront.
+  ///
+  /// @returns The position of the lanes of the sums in the container.
+  int SumProbabilities(const VertexPtr& vertex, const double* p_lanes,
+                       int num_lanes,
+                       std::unordered_map<const SetNode*, int>* offsets,
+                       std::vector<double>* sums) const noexcept;
+
+  /// Sums probabilities of products grouped by the order of products
+  /// with modules expanded.
+  /// Products above the limit order are not included
+  /// as they are not produced by iterators.
+  ///
+  /// @param[in] vertex  The root vertex of ZBDD.
+  /// @param[in] shift  The order shift for the products of the vertex.
+  /// @param[in] factor  The factor for probabilities of the products.
+  /// @param[in] p_vars  Probabilities of variables mapped by their indices.
+  /// @param[in,out] sums  The memoized sums of the visited nodes.
+  /// @param[in,out] result  The sums by order to add the products into.
+  void AddOrderSums(
+      const VertexPtr& vertex, int shift, double factor,
+      const Pdag::IndexMap<double>& p_vars,
+      std::unordered_map<const SetNode*, std::vector<double>>* sums,
+      std::vector<double>* result) const noexcept;
+
   /// Cleans up non-terminal vertex marks
   /// by setting them to "false".
   ///
@@ -850,6 +1082,8 @@ class Zbdd : private boost::noncopyable {
   VertexPtr root_;  ///< The root vertex of ZBDD.
   bool coherent_;  ///< Inherited coherence from BDD.
   int module_index_;  ///< Identifier for a module if any.
+  Probabilities p_vars_;  ///< Variable probabilities for the cut-off.
+  double truncation_error_;  ///< The probability of discarded sets.
 
   /// Table of unique SetNodes denoting sets.
   /// The key consists of (index, id_high, id_low) triplet.
@@ -870,7 +1104,7 @@ class Zbdd : private boost::noncopyable {
   /// The results of subsume operations over sets.
   PairTable<VertexPtr> subsume_table_;
   /// The results of pruning operations.
-  PairTable<VertexPtr> prune_results_;
+  CutOffTable<std::pair<int, int>, PairHash, Result> prune_results_;
 
   std::map<int, std::unique_ptr<Zbdd>> modules_;  ///< Module graphs.
   int set_id_;  ///< Identification assignment for new set graphs.
@@ -889,6 +1123,7 @@ class CutSetContainer : public Zbdd {
   /// @param[in] settings  Settings that control analysis complexity.
   /// @param[in] module_index  The of a module if known.
   /// @param[in] gate_index_bound  The exclusive lower bound for gate indices.
+  /// @param[in] p_vars  Variable probabilities for the cut-off on products.
   ///
   /// @pre No complements of gates.
   /// @pre Gates are indexed sequentially
@@ -896,7 +1131,8 @@ class CutSetContainer : public Zbdd {
   /// @pre Basic events are indexed sequentially
   ///      up to a number less than or equal to the given lower bound.
   CutSetContainer(const Settings& settings, int module_index,
-                  int gate_index_bound) noexcept;
+                  int gate_index_bound,
+                  Probabilities p_vars = nullptr) noexcept;
 
   /// Converts a PDAG gate into intermediate cut sets.
   ///
@@ -984,6 +1220,11 @@ class CutSetContainer : public Zbdd {
     return modules;
   }
 
+  /// @returns A map of module indices and adjusted cut-off probabilities.
+  std::unordered_map<int, double> GatherModuleCutOffs() noexcept {
+    return Zbdd::GatherModuleCutOffs();
+  }
+
   using Zbdd::JoinModule;  ///< Joins fully processed modules.
   using Zbdd::Log;  ///< Logs properties of the container.
 
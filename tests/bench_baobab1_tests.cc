@@ -53,6 +53,91 @@ TEST_P(RiskAnalysisTest, Baobab1L8) {
   EXPECT_EQ(distr, ProductDistribution());
 }
 
+TEST_F(RiskAnalysisTest, Baobab1L8BddMemory) {
+  std::vector<std::string> input_files = {
+      "input/Baobab/baobab1.xml", "input/Baobab/baobab1-basic-events.xml"};
+  settings.algorithm("bdd").limit_order(8).bdd_memory(1);
+  ASSERT_NO_THROW(ProcessInputFiles(input_files));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_EQ(25892, products().size());
+  std::vector<int> distr = {0, 1, 1, 70, 400, 2212, 14748, 8460};
+  EXPECT_EQ(distr, ProductDistribution());
+  std::optional<CacheStatistics> statistics =
+      analysis->results().front().fault_tree_analysis->cache_statistics();
+  ASSERT_TRUE(statistics);
+  EXPECT_TRUE(statistics->hits > 0);
+  EXPECT_TRUE(statistics->evictions > 0);  // The cache is full.
+}
+
+TEST_P(RiskAnalysisTest, Baobab1PreprocessorProfile) {
+  std::vector<std::string> input_files = {
+      "input/Baobab/baobab1.xml", "input/Baobab/baobab1-basic-events.xml"};
+  settings.limit_order(4);
+  ASSERT_NO_THROW(ProcessInputFiles(input_files));
+  ASSERT_NO_THROW(analysis->Analyze());
+  const std::vector<PassProfile>& profile =
+      analysis->results().front().fault_tree_analysis->preprocessor_profile();
+  REQUIRE_FALSE(profile.empty());
+  EXPECT_EQ(std::string("process-multiple-definitions"), profile.front().name);
+  EXPECT_EQ(2, profile.front().phase);
+  // The passes account for all the changes of the graph.
+  for (auto it = profile.begin(); it != profile.end(); ++it) {
+    CHECK(it->time >= 0);
+    CHECK(it->changes >= 0);
+    if (it->changes == 0) {
+      EXPECT_EQ(it->gates_before, it->gates_after);
+      EXPECT_EQ(it->variables_before, it->variables_after);
+    }
+    if (it != profile.begin()) {
+      EXPECT_EQ(std::prev(it)->gates_after, it->gates_before);
+      EXPECT_EQ(std::prev(it)->variables_after, it->variables_before);
+    }
+  }
+  // No pass is applied to the graph it has left at a fixed point.
+  std::set<std::string> idempotent = {"process-multiple-definitions",
+                                      "detect-modules", "coalesce-gates",
+                                      "coalesce-common-gates"};
+  std::set<std::string> fixed_points;
+  for (const PassProfile& pass : profile) {
+    CHECK(fixed_points.count(pass.name) == 0);
+    if (pass.changes)
+      fixed_points.clear();
+    if (idempotent.count(pass.name) || pass.changes == 0)
+      fixed_points.insert(pass.name);
+  }
+  EXPECT_EQ(72, products().size());
+}
+
+TEST_F(RiskAnalysisTest, Baobab1Reordering) {
+  std::vector<std::string> input_files = {
+      "input/Baobab/baobab1.xml", "input/Baobab/baobab1-basic-events.xml"};
+  settings.algorithm("bdd").reordering(true).probability_analysis(true);
+  ASSERT_NO_THROW(ProcessInputFiles(input_files));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_NEAR(1.2823e-6, p_total(), 1e-8);
+  EXPECT_EQ(46188, products().size());
+  std::vector<int> distr = {0,     1,    1,     70,   400, 2212,
+                            14748, 8460, 10624, 6600, 3072};
+  EXPECT_EQ(distr, ProductDistribution());
+}
+
+TEST_P(RiskAnalysisTest, Baobab1CutOff) {
+  std::vector<std::string> input_files = {
+      "input/Baobab/baobab1.xml", "input/Baobab/baobab1-basic-events.xml"};
+  settings.probability_analysis(true).cut_off(1e-10);
+  ASSERT_NO_THROW(ProcessInputFiles(input_files));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_EQ(1613, products().size());
+  std::vector<int> distr = {0, 1, 0, 52, 68, 708, 784};
+  EXPECT_EQ(distr, ProductDistribution());
+  for (const auto& product : product_probability())
+    CHECK(product.second >= 1e-10);
+  EXPECT_TRUE(analysis->results()
+                  .front()
+                  .fault_tree_analysis->products()
+                  .truncation_error() > 0);
+}
+
 TEST_P(RiskAnalysisTest, Baobab1L4Importance) {
   std::vector<std::string> input_files = {
       "input/Baobab/baobab1.xml", "input/Baobab/baobab1-basic-events.xml"};
@@ -17,6 +17,12 @@
 
 #include "risk_analysis_tests.h"
 
+#include <cmath>
+
+#include <vector>
+
+#include <boost/version.hpp>
+
 namespace scram::core::test {
 
 // Benchmark Tests for BSCU fault tree from XFTA.
@@ -41,11 +47,12 @@ TEST_P(RiskAnalysisTest, BSCU) {
 
   EXPECT_EQ(10, products().size());
   EXPECT_EQ(mcs, products());
+  EXPECT_EQ(10000, num_trials());
 
   if (settings.approximation() == Approximation::kRareEvent) {
     EXPECT_NEAR(0.135372, p_total(), 1e-4);
     EXPECT_NEAR(0.137, mean(), 5e-3);
-    EXPECT_NEAR(0.217, sigma(), 5e-3);
+    EXPECT_NEAR(0.215, sigma(), 5e-3);
   } else {
     EXPECT_NEAR(0.1124087, p_total(), 1e-4);
     EXPECT_NEAR(0.117, mean(), 5e-3);
@@ -53,4 +60,68 @@ TEST_P(RiskAnalysisTest, BSCU) {
   }
 }
 
+// The results of simulations must not depend on the number of jobs.
+TEST_P(RiskAnalysisTest, BSCUParallelJobs) {
+  std::string tree_input = "input/BSCU/BSCU.xml";
+  settings.uncertainty_analysis(true);
+  settings.num_trials(1000);
+  settings.seed(123);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  double serial_mean = mean();
+  double serial_sigma = sigma();
+
+  settings.num_jobs(4);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_EQ(serial_mean, mean());
+  EXPECT_EQ(serial_sigma, sigma());
+}
+
+// Stratified and low-discrepancy sampling converges with fewer trials,
+// and the points must not depend on the number of jobs either.
+TEST_P(RiskAnalysisTest, BSCUSampling) {
+  std::string tree_input = "input/BSCU/BSCU.xml";
+  double expected_mean =
+      settings.approximation() == Approximation::kRareEvent ? 0.137 : 0.117;
+  std::vector<const char*> samplings = {"latin-hypercube"};
+#if BOOST_VERSION >= 107100
+  samplings.push_back("sobol");
+#endif
+  for (const char* sampling : samplings) {
+    INFO(sampling);
+    settings.uncertainty_analysis(true).num_jobs(1);
+    settings.sampling(sampling).num_trials(1024).seed(123);
+    ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+    ASSERT_NO_THROW(analysis->Analyze());
+    EXPECT_NEAR(expected_mean, mean(), 5e-3);
+    double serial_mean = mean();
+
+    settings.num_jobs(4);
+    ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+    ASSERT_NO_THROW(analysis->Analyze());
+    EXPECT_EQ(serial_mean, mean());
+  }
+}
+
+// The simulations stop once the target error of the mean is met.
+TEST_P(RiskAnalysisTest, BSCUEarlyStopping) {
+  std::string tree_input = "input/BSCU/BSCU.xml";
+  settings.uncertainty_analysis(true);
+  settings.num_trials(100000).mean_error(0.05).seed(123);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  int serial_trials = num_trials();
+  double serial_mean = mean();
+  CHECK(serial_trials < 100000);
+  CHECK(serial_trials >= 1000);
+  CHECK(1.96 * sigma() / std::sqrt(serial_trials) <= 0.05 * mean());
+
+  settings.num_jobs(4);
+  ASSERT_NO_THROW(ProcessInputFiles({tree_input}));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_EQ(serial_trials, num_trials());
+  EXPECT_EQ(serial_mean, mean());
+}
+
 }  // namespace scram::core::test
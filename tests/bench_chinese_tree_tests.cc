@@ -89,4 +89,40 @@ TEST_P(RiskAnalysisTest, ChineseTree) {
   EXPECT_EQ(distr, ProductDistribution());
 }
 
+// The modules are converted into BDD in parallel jobs.
+TEST_F(RiskAnalysisTest, ChineseTreeJobs) {
+  std::vector<std::string> input_files = {
+      "input/Chinese/chinese.xml", "input/Chinese/chinese-basic-events.xml"};
+  settings.algorithm("bdd").num_jobs(4).importance_analysis(true);
+  ASSERT_NO_THROW(ProcessInputFiles(input_files));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_NEAR(0.0045691, p_total(), 1e-5);
+  TestImportance(
+      {{"e1", {40, 0.0745557, 0.326332, 0.339805, 16.9902, 1.48441}},
+       {"e4", {21, 0.0553923, 0.242453, 0.257604, 12.8802, 1.32005}},
+       {"e8", {180, 0.000181647, 0.000795073, 0.0207792, 1.03896, 1.0008}},
+       {"e22", {154, 1.03582e-05, 4.5338e-05, 0.0200444, 1.00222, 1.00005}}});
+  EXPECT_EQ(392, products().size());
+  std::vector<int> distr = {0, 12, 0, 24, 188, 168};
+  EXPECT_EQ(distr, ProductDistribution());
+}
+
+// The rare-event calculation on the ZBDD graph
+// must exclude module products beyond the limit order.
+TEST_P(RiskAnalysisTest, ChineseTreeLimitOrderRareEvent) {
+  std::vector<std::string> input_files = {
+      "input/Chinese/chinese.xml", "input/Chinese/chinese-basic-events.xml"};
+  settings.probability_analysis(true).limit_order(4);
+  ASSERT_NO_THROW(ProcessInputFiles(input_files));
+  ASSERT_NO_THROW(analysis->Analyze());
+  EXPECT_EQ(36, products().size());
+  if (settings.approximation() == Approximation::kRareEvent) {
+    double sum = 0;
+    for (const auto& entry : product_probability())
+      sum += entry.second;
+    EXPECT_DOUBLE_EQ(sum, p_total());
+    EXPECT_NEAR(0.00480384, p_total(), 1e-8);
+  }
+}
+
 }  // namespace scram::core::test
@@ -67,11 +67,15 @@ TEST_CASE("ConfigTest.FullSettings", "[config]") {
   CHECK(settings.ccf_analysis());
   CHECK(settings.safety_integrity_levels());
   CHECK(settings.approximation() == core::Approximation::kRareEvent);
+  CHECK(settings.sampling() == core::Sampling::kLatinHypercube);
   CHECK(settings.limit_order() == 11);
   CHECK(settings.mission_time() == 48);
   CHECK(settings.time_step() == 1);
+  CHECK(settings.time_tolerance() == 0.001);
   CHECK(settings.cut_off() == 0.009);
   CHECK(settings.num_trials() == 777);
+  CHECK(settings.mean_error() == 0.05);
+  CHECK(settings.quantile_error() == 0.1);
   CHECK(settings.num_quantiles() == 13);
   CHECK(settings.num_bins() == 31);
   CHECK(settings.seed() == 97531);
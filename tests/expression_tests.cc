@@ -22,8 +22,11 @@
 #include "expression/exponential.h"
 #include "expression/numerical.h"
 #include "expression/random_deviate.h"
+#include "expression/tape.h"
 #include "parameter.h"
 
+#include <cmath>
+
 #include <catch.hpp>
 
 #include "error.h"
@@ -583,6 +586,44 @@ TEST_CASE("ExpressionTest.Histogram", "[mef::expression]") {
   CHECK_FALSE(dev->Sample() == sampled_value);
 }
 
+// The inverse distribution functions of the deviates.
+TEST_CASE("ExpressionTest.DeviateQuantiles", "[mef::expression]") {
+  OpenExpression one(1);
+  OpenExpression two(2);
+  OpenExpression five(5);
+  OpenExpression ten(10);
+  OpenExpression zero(0);
+  CHECK(UniformDeviate(&one, &five).Quantile(0.25) == Approx(2));
+  NormalDeviate normal(&ten, &five);
+  CHECK(normal.Quantile(0.5) == Approx(10));
+  CHECK(normal.Quantile(0.975) == Approx(10 + 5 * 1.959964));
+  CHECK(LognormalDeviate(&zero, &one).Quantile(0.5) == Approx(1));
+  CHECK(GammaDeviate(&one, &two).Quantile(0.5) == Approx(2 * std::log(2)));
+  CHECK(BetaDeviate(&one, &one).Quantile(0.3) == Approx(0.3));
+
+  OpenExpression four(4);
+  OpenExpression three(3);
+  Histogram histogram({&zero, &one, &three}, {&two, &four});
+  CHECK(histogram.Quantile(1.0 / 6) == Approx(0.5));
+  CHECK(histogram.Quantile(0.5) == Approx(1.5));
+  CHECK(histogram.Quantile(1) == Approx(3));
+
+  // Sampling with the uniform numbers from the source instead of the RNG.
+  struct FixedSource : public RandomDeviate::UniformSource {
+    void NextTrial() noexcept override { ++num_trials; }
+    double Next(const RandomDeviate&) noexcept override { return 0.25; }
+    int num_trials = 0;
+  } source;
+  UniformDeviate uniform(&one, &five);
+  RandomDeviate::uniform_source(&source);
+  RandomDeviate::StartTrial();
+  CHECK(uniform.Sample() == Approx(2));
+  RandomDeviate::uniform_source(nullptr);
+  CHECK(source.num_trials == 1);
+  uniform.Reset();
+  CHECK_FALSE(uniform.Sample() == Approx(2));
+}
+
 // Test for negation of an expression.
 TEST_CASE("ExpressionTest.Neg", "[mef::expression]") {
   OpenExpression expression(10, 8);
@@ -1193,4 +1234,66 @@ TEST_CASE("ExpressionTest.Switch", "[mef::expression]") {
   EXPECT_DOUBLE_EQ(10, Switch({}, &arg_three).value());
 }
 
+TEST_CASE("ExpressionTest.TapeOverTime", "[mef::expression]") {
+  MissionTime mission_time(10);
+  ConstantExpression lambda(0.1);
+  ConstantExpression threshold(4);
+  Exponential exponential(&lambda, &mission_time);
+  Parameter param("param");
+  param.expression(&exponential);
+  Mul scaled({&param, &threshold});
+  Add constant({&lambda, &threshold});
+  Gt late(&mission_time, &threshold);
+  Ite conditional(&late, &scaled, &param);
+
+  std::vector<Expression*> outputs = {&param, &constant, &scaled,
+                                      &conditional};
+  ExpressionTape tape(outputs, &mission_time, 4);
+  CHECK(tape.size() == 3);  // Exponential, Mul, Ite.
+  CHECK(tape.lanes(1) == nullptr);
+
+  std::vector<double> times = {0, 1, 5, 10, 20};
+  tape.Evaluate(times.data(), 3);
+  tape.Evaluate(&times[2], 3);  // Partial batch with stale lanes.
+  CHECK(mission_time.value() == 10);
+  for (int lane = 0; lane < 3; ++lane) {
+    mission_time.value(times[2 + lane]);
+    for (int i : {0, 2, 3})
+      CHECK(tape.lanes(i)[lane] == outputs[i]->value());
+  }
+}
+
+TEST_CASE("ExpressionTest.TapeSampling", "[mef::expression]") {
+  ConstantExpression zero(0);
+  ConstantExpression one(1);
+  ConstantExpression half(0.5);
+  UniformDeviate uniform(&zero, &one);
+  NormalDeviate normal(&half, &one);
+  Parameter param("param");
+  param.expression(&uniform);
+  Mul product({&param, &half});
+  Add sum({&param, &normal, &one});
+  Lt test(&param, &half);
+  Ite conditional(&test, &normal, &product);
+
+  std::vector<Expression*> outputs = {&sum, &product, &conditional};
+  ExpressionTape tape(outputs, 4);
+  std::seed_seq seq{42};
+  RandomDeviate::seed(seq);
+  tape.Sample(4);
+  std::vector<std::vector<double>> samples;
+  for (int i = 0; i < outputs.size(); ++i) {
+    REQUIRE(tape.lanes(i));
+    samples.emplace_back(tape.lanes(i), tape.lanes(i) + 4);
+  }
+
+  RandomDeviate::seed(seq);
+  for (int lane = 0; lane < 4; ++lane) {
+    for (Expression* output : outputs)
+      output->Reset();
+    for (int i = 0; i < outputs.size(); ++i)
+      CHECK(samples[i][lane] == outputs[i]->Sample());
+  }
+}
+
 }  // namespace scram::mef::test
@@ -17,11 +17,16 @@
 
 #include "initializer.h"
 
+#include <fstream>
+
+#include <boost/filesystem.hpp>
 #include <catch.hpp>
 
 #include "error.h"
 #include "settings.h"
 
+namespace fs = boost::filesystem;
+
 namespace scram::mef::test {
 
 // Test if the XML is well formed.
@@ -223,6 +228,148 @@ TEST_CASE("InitializerTest.IncorrectInclude", "[mef::initializer]") {
   }
 }
 
+// Input files parsed in parallel jobs must report errors
+// as if the files were parsed sequentially.
+TEST_CASE("InitializerTest.ParallelParsing", "[mef::initializer]") {
+  core::Settings settings;
+  settings.num_jobs(4);
+  CHECK_NOTHROW(
+      Initializer({"input/TwoTrain/two_train.xml",
+                   "input/EventTrees/gas_leak/gas_leak_reactive.xml",
+                   "input/EventTrees/gas_leak/gas_leak.xml"},
+                  settings));
+  CHECK_THROWS_AS(Initializer({"input/TwoTrain/two_train.xml",
+                               "tests/input/xml_formatting_error.xml",
+                               "tests/input/schema_fail.xml"},
+                              settings),
+                  xml::ParseError);
+  CHECK_THROWS_AS(Initializer({"input/TwoTrain/two_train.xml",
+                               "tests/input/schema_fail.xml",
+                               "tests/input/xml_formatting_error.xml"},
+                              settings),
+                  xml::ValidityError);
+}
+
+// Streamed input files must produce the same models and errors
+// as the input files loaded into XML DOM.
+TEST_CASE("InitializerTest.StreamInput", "[mef::initializer]") {
+  core::Settings settings;
+  settings.stream_input(true);
+  std::string dir = "tests/input/";
+  const char* correct_inputs[] = {
+      "xinclude.xml",
+      "xinclude_transitive.xml",
+      "fta/correct_tree_input_with_probs.xml",
+      "fta/component_definition.xml",
+      "fta/labels_and_attributes.xml",
+      "fta/correct_expressions.xml",
+      "eta/link_in_rule.xml",
+      "eta/test_functional_event.xml",
+  };
+  for (const auto& input : correct_inputs) {
+    CAPTURE(input);
+    CHECK_NOTHROW(Initializer({dir + input}, settings));
+  }
+  CHECK_NOTHROW(
+      Initializer({"input/EventTrees/gas_leak/gas_leak_reactive.xml",
+                   "input/EventTrees/gas_leak/gas_leak.xml"},
+                  settings));
+
+  const char* incorrect_inputs[] = {
+      "fta/undefined_gate.xml",      "fta/doubly_defined_basic.xml",
+      "fta/cyclic_expression.xml",   "fta/invalid_expression.xml",
+      "eta/undefined_sequence.xml",  "eta/cyclic_link_transitive.xml",
+  };
+  for (const auto& input : incorrect_inputs) {
+    CAPTURE(input);
+    CHECK_THROWS_AS(Initializer({dir + input}, settings), ValidityError);
+  }
+  CHECK_THROWS_AS(Initializer({dir + "schema_fail.xml"}, settings),
+                  xml::ValidityError);
+  CHECK_THROWS_AS(Initializer({dir + "xml_formatting_error.xml"}, settings),
+                  xml::Error);
+  CHECK_THROWS_AS(Initializer({dir + "xinclude_no_file.xml"}, settings),
+                  xml::XIncludeError);
+}
+
+// Models loaded from snapshots must be the same as the processed models.
+TEST_CASE("InitializerTest.ModelCache", "[mef::initializer]") {
+  fs::path cache_dir =
+      fs::temp_directory_path() / ("scram_test-" + fs::unique_path().string());
+  core::Settings settings;
+  settings.model_cache(cache_dir.string());
+  auto summary = [&settings](const std::vector<std::string>& inputs) {
+    std::unique_ptr<Model> model = Initializer(inputs, settings).model();
+    std::vector<std::size_t> sizes = {
+        model->parameters().size(),   model->house_events().size(),
+        model->basic_events().size(), model->gates().size(),
+        model->ccf_groups().size(),   model->fault_trees().size(),
+        model->event_trees().size(),  model->sequences().size(),
+        model->rules().size(),        model->alignments().size(),
+        model->substitutions().size()};
+    return std::pair(model->GetOptionalName(), sizes);
+  };
+  std::string dir = "tests/input/";
+  const char* correct_inputs[] = {
+      "xinclude.xml",
+      "fta/correct_tree_input_with_probs.xml",
+      "fta/component_definition.xml",
+      "fta/labels_and_attributes.xml",
+      "fta/correct_expressions.xml",
+      "fta/ccf_unordered_factors.xml",
+      "eta/link_in_rule.xml",
+      "eta/test_functional_event.xml",
+      "model/valid_alignment.xml",
+      "model/substitution_types.xml",
+  };
+  settings.approximation(core::Approximation::kRareEvent);
+  for (const auto& input : correct_inputs) {
+    CAPTURE(input);
+    auto processed = summary({dir + input});
+    CHECK(fs::exists(ModelCache(cache_dir.string(), {dir + input}).file()));
+    CHECK(summary({dir + input}) == processed);
+  }
+  settings.approximation(core::Approximation::kNone);
+  std::vector<std::string> gas_leak = {
+      "input/EventTrees/gas_leak/gas_leak_reactive.xml",
+      "input/EventTrees/gas_leak/gas_leak.xml"};
+  auto processed = summary(gas_leak);
+  CHECK(summary(gas_leak) == processed);
+
+  // The snapshots are invalidated with the changes in included files.
+  fs::path input = cache_dir / "input.xml";
+  fs::path include = cache_dir / "include.xml";
+  auto write_include = [&include](const char* gate) {
+    std::ofstream(include.string())
+        << "<opsa-mef><define-fault-tree name='ft'><define-gate name='"
+        << gate << "'><or><basic-event name='a'/><basic-event name='b'/>"
+        << "</or></define-gate><define-basic-event name='a'/>"
+        << "<define-basic-event name='b'/></define-fault-tree></opsa-mef>";
+  };
+  std::ofstream(input.string())
+      << "<opsa-mef xmlns:xi='http://www.w3.org/2001/XInclude'>"
+      << "<xi:include href='include.xml' xpointer='xpointer(/opsa-mef/*)'/>"
+      << "</opsa-mef>";
+  write_include("top");
+  CHECK(Initializer({input.string()}, settings).model()->gates().count("top"));
+  write_include("root");
+  CHECK(Initializer({input.string()}, settings).model()->gates().count("root"));
+
+  // Corrupted snapshots are ignored.
+  std::string snapshot = ModelCache(cache_dir.string(), gas_leak).file();
+  fs::resize_file(snapshot, fs::file_size(snapshot) / 2);
+  CHECK(summary(gas_leak) == processed);
+  std::ofstream(snapshot, std::ios::app) << "garbage";
+  CHECK(summary(gas_leak) == processed);
+
+  // Models with missing probabilities are processed for the analysis.
+  settings.probability_analysis(true);
+  CHECK_NOTHROW(Initializer({dir + "fta/correct_tree_input_with_probs.xml"},
+                            settings));
+  CHECK_THROWS_AS(Initializer({dir + "xinclude.xml"}, settings), ValidityError);
+  fs::remove_all(cache_dir);
+}
+
 // Test correct inputs with probability information.
 TEST_CASE("InitializerTest.CorrectProbabilityInputs", "[mef::initializer]") {
   std::string dir = "tests/input/fta/";
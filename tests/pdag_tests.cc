@@ -103,6 +103,62 @@ TEST_CASE("PdagTest.Cardinality", "[mef::pdag]") {
   }
 }
 
+TEST_CASE("PdagTest.ClearMarks", "[mef::pdag]") {
+  Pdag graph;
+  auto root = std::make_shared<Gate>(kAnd, &graph);
+  auto arg_gate = std::make_shared<Gate>(kOr, &graph);
+  auto var_one = std::make_shared<Variable>(&graph);
+  auto var_two = std::make_shared<Variable>(&graph);
+  arg_gate->AddArg(var_one);
+  arg_gate->AddArg(var_two);
+  root->AddArg(arg_gate);
+  root->AddArg(var_one);
+  graph.root(root);
+
+  SECTION("Gate marks") {
+    CHECK_FALSE(root->mark());
+    TraverseGates(root, [](const GatePtr&) {});
+    CHECK(root->mark());
+    CHECK(arg_gate->mark());
+    auto detached = std::make_shared<Gate>(kOr, &graph);
+    detached->mark(true);
+    graph.Clear<Pdag::kGateMark>();
+    CHECK_FALSE(root->mark());
+    CHECK_FALSE(arg_gate->mark());
+    CHECK_FALSE(detached->mark());  // All gates of the graph are cleared.
+    arg_gate->mark(true);
+    CHECK(arg_gate->mark());
+    arg_gate->mark(false);
+    CHECK_FALSE(arg_gate->mark());
+  }
+
+  SECTION("Node visits") {
+    CHECK_FALSE(var_one->Visit(1));
+    CHECK_FALSE(var_one->Visit(2));
+    CHECK(var_one->Visit(3));
+    CHECK(var_one->Revisited());
+    CHECK(var_one->LastVisit() == 3);
+    graph.Clear<Pdag::kVisit>();
+    CHECK_FALSE(var_one->Visited());
+    CHECK(var_one->EnterTime() == 0);
+    CHECK(var_one->LastVisit() == 0);
+    CHECK_FALSE(var_one->Visit(4));
+    CHECK(var_one->EnterTime() == 4);
+    CHECK(var_one->ExitTime() == 0);
+    CHECK_FALSE(var_one->Revisited());
+  }
+
+  SECTION("Other marks") {
+    var_one->opti_value(1);
+    arg_gate->opti_value(2);
+    TraverseGates(root, [](const GatePtr&) {});
+    graph.Clear<Pdag::kOptiValue>();
+    CHECK(var_one->opti_value() == 0);
+    CHECK(arg_gate->opti_value() == 0);
+    CHECK_FALSE(root->mark());  // The traversal marks are cleared as well.
+  }
+}
+
 static_assert(kNumConnectives == 8, "New gate types are not considered!");
 
 class GateTest {
@@ -59,7 +59,7 @@ TEST_CASE("regression test BDD/ZBDD", "[object_size]") {
   CHECK(sizeof(Vertex<Ite>) == 16);
   CHECK(sizeof(NonTerminal<Ite>) == 48);
   CHECK(sizeof(Ite) == 64);
-  CHECK(sizeof(SetNode) == 56);
+  CHECK(sizeof(SetNode) == 72);
 }
 #endif
 
@@ -18,9 +18,11 @@
 #include "risk_analysis_tests.h"
 
 #include <utility>
+#include <vector>
 
 #include <boost/filesystem.hpp>
 
+#include "bdd.h"
 #include "env.h"
 #include "error.h"
 #include "initializer.h"
@@ -97,9 +99,12 @@ const std::map<std::set<std::string>, double>&
 RiskAnalysisTest::product_probability() {
   assert(analysis->results().size() == 1);
   if (result_.product_probability.empty()) {
-    for (const Product& product :
-         analysis->results().front().fault_tree_analysis->products()) {
+    const auto& result = analysis->results().front();
+    for (const Product& product : result.fault_tree_analysis->products()) {
       result_.product_probability.emplace(Convert(product), product.p());
+      // The analysis snapshot must agree with the event expressions.
+      if (result.probability_analysis)
+        CHECK(product.p(result.probability_analysis->p_vars()) == product.p());
     }
   }
   return result_.product_probability;
@@ -378,6 +383,82 @@ TEST_P(RiskAnalysisTest, AnalyzeProbabilityOverTime) {
   REQUIRE(time);
 }
 
+// The curve is calculated in batches of time points
+// with the same arithmetic as the single total probability.
+TEST_F(RiskAnalysisTest, ProbabilityOverTimeApproximations) {
+  std::string tree_input = "input/BSCU/BSCU.xml";
+  for (const char* approximation : {"rare-event", "mcub"}) {
+    INFO(approximation);
+    settings.approximation(approximation).probability_analysis(true);
+    settings.time_step(100).mission_time(2000);
+    REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+    REQUIRE_NOTHROW(analysis->Analyze());
+    const auto& p_time =
+        analysis->results().front().probability_analysis->p_time();
+    REQUIRE(p_time.size() == 21);
+    CHECK(p_time.back().second == 2000);
+    CHECK(p_time.back().first == p_total());
+    for (int i = 1; i < p_time.size(); ++i)
+      CHECK(p_time[i - 1].first <= p_time[i].first);
+  }
+}
+
+// The batch calculations restricted to the varying variables
+// must reuse the cached results of the other BDD vertices exactly.
+TEST_F(RiskAnalysisTest, IncrementalBddBatches) {
+  std::string tree_input = "input/BSCU/BSCU.xml";
+  settings.probability_analysis(true);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  auto* analyzer = const_cast<ProbabilityAnalyzer<Bdd>*>(
+      dynamic_cast<const ProbabilityAnalyzer<Bdd>*>(
+          analysis->results().front().probability_analysis.get()));
+  REQUIRE(analyzer);
+
+  ProbabilityBatch batch(analyzer->p_vars());
+  std::vector<int> variables = {Pdag::kVariableStartIndex,
+                                Pdag::kVariableStartIndex + 3};
+  for (int index : variables) {
+    double* lanes = batch.lanes(index);
+    for (int lane = 0; lane < ProbabilityBatch::kSize; ++lane)
+      lanes[lane] = 0.1 * (lane + 1);
+  }
+  ProbabilityBatch::Results full = analyzer->CalculateTotalProbabilities(batch);
+  analyzer->PrepareBatches(variables);
+  ProbabilityBatch::Results partial =
+      analyzer->CalculateTotalProbabilities(batch);
+  analyzer->PrepareBatches();
+  CHECK(partial == full);
+  CHECK_FALSE(full.front() == full.back());
+
+  analyzer->PrepareBatches({});  // Nothing varies.
+  ProbabilityBatch nominal(analyzer->p_vars());
+  for (double p : analyzer->CalculateTotalProbabilities(nominal))
+    CHECK(p == Approx(p_total()));
+  analyzer->PrepareBatches();
+}
+
+// Periodic tests produce sharp drops in the probability curve.
+TEST_F(RiskAnalysisTest, AdaptiveTimeSteps) {
+  std::string tree_input = "input/HIPPS/HIPPS.xml";
+  settings.time_step(1).safety_integrity_levels(true);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  Sil fine_sil = analysis->results().front().probability_analysis->sil();
+
+  settings.time_step(1000).time_tolerance(1e-6);
+  REQUIRE_NOTHROW(ProcessInputFiles({tree_input}));
+  REQUIRE_NOTHROW(analysis->Analyze());
+  const auto& prob_an = *analysis->results().front().probability_analysis;
+  CHECK(prob_an.p_time().size() < 400);
+  CHECK(prob_an.p_time().front().second == 0);
+  CHECK(prob_an.p_time().back().second == settings.mission_time());
+  for (int i = 1; i < prob_an.p_time().size(); ++i)
+    CHECK(prob_an.p_time()[i - 1].second < prob_an.p_time()[i].second);
+  CHECK(prob_an.sil().pfd_avg == Approx(fine_sil.pfd_avg).epsilon(1e-3));
+  CHECK(prob_an.sil().pfh_avg == Approx(fine_sil.pfh_avg).epsilon(1e-2));
+}
+
 TEST_P(RiskAnalysisTest, AnalyzeSil) {
   std::string tree_input = "tests/input/core/single_exponential.xml";
   settings.time_step(24).safety_integrity_levels(true);
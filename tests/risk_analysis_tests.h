@@ -133,6 +133,12 @@ class RiskAnalysisTest {
     return analysis->results().front().uncertainty_analysis->sigma();
   }
 
+  int num_trials() {
+    assert(analysis->results().size() == 1);
+    assert(analysis->results().front().uncertainty_analysis);
+    return analysis->results().front().uncertainty_analysis->num_trials();
+  }
+
   /// @returns The event-tree analysis sequence results.
   std::map<std::string, double> sequences();
 
@@ -29,6 +29,13 @@ TEST_CASE("SettingsTest IncorrectSetup", "[settings]") {
   CHECK_THROWS_AS(s.algorithm("the-best"), SettingsError);
   // Incorrect approximation argument.
   CHECK_THROWS_AS(s.approximation("approx"), SettingsError);
+  // Incorrect target errors for early stopping.
+  CHECK_THROWS_AS(s.mean_error(-0.1), SettingsError);
+  CHECK_THROWS_AS(s.mean_error(1), SettingsError);
+  CHECK_THROWS_AS(s.quantile_error(-0.1), SettingsError);
+  CHECK_THROWS_AS(s.quantile_error(1), SettingsError);
+  // Incorrect sampling strategy.
+  CHECK_THROWS_AS(s.sampling("quasi"), SettingsError);
   // Incorrect limit order for products.
   CHECK_THROWS_AS(s.limit_order(-1), SettingsError);
   // Incorrect cut-off probability.
@@ -43,12 +50,23 @@ TEST_CASE("SettingsTest IncorrectSetup", "[settings]") {
   // Incorrect number of bins.
   CHECK_THROWS_AS(s.num_bins(-10), SettingsError);
   CHECK_THROWS_AS(s.num_bins(0), SettingsError);
+  // Incorrect number of jobs.
+  CHECK_THROWS_AS(s.num_jobs(-1), SettingsError);
+  CHECK_THROWS_AS(s.num_jobs(0), SettingsError);
+  // Incorrect memory budget for BDD caches.
+  CHECK_THROWS_AS(s.bdd_memory(-1), SettingsError);
+  CHECK_THROWS_AS(s.bdd_memory(0), SettingsError);
+  // Incorrect work budget for merging.
+  CHECK_THROWS_AS(s.merge_budget(-1), SettingsError);
   // Incorrect seed.
   CHECK_THROWS_AS(s.seed(-1), SettingsError);
   // Incorrect mission time.
   CHECK_THROWS_AS(s.mission_time(-10), SettingsError);
   // Incorrect time step.
   CHECK_THROWS_AS(s.time_step(-1), SettingsError);
+  // Incorrect time tolerance.
+  CHECK_THROWS_AS(s.time_tolerance(-1e-3), SettingsError);
+  CHECK_THROWS_AS(s.time_tolerance(1), SettingsError);
   // The time step is not set for the SIL calculations.
   CHECK_THROWS_AS(s.safety_integrity_levels(true), SettingsError);
   // Disable time step while the SIL is requested.
@@ -68,6 +86,18 @@ TEST_CASE("SettingsTest CorrectSetup", "[settings]") {
   CHECK_NOTHROW(s.approximation("rare-event"));
   CHECK_NOTHROW(s.approximation("mcub"));
 
+  // Correct target errors for early stopping.
+  CHECK_NOTHROW(s.mean_error(0));
+  CHECK_NOTHROW(s.mean_error(0.01));
+  CHECK_NOTHROW(s.quantile_error(0));
+  CHECK_NOTHROW(s.quantile_error(0.05));
+
+  // Correct sampling strategy.
+  CHECK_NOTHROW(s.sampling("latin-hypercube"));
+  CHECK(s.sampling() == Sampling::kLatinHypercube);
+  CHECK_NOTHROW(s.sampling("monte-carlo"));
+  CHECK(s.sampling() == Sampling::kMonteCarlo);
+
   // Correct limit order for products.
   CHECK_NOTHROW(s.limit_order(1));
   CHECK_NOTHROW(s.limit_order(32));
@@ -90,6 +120,16 @@ TEST_CASE("SettingsTest CorrectSetup", "[settings]") {
   CHECK_NOTHROW(s.num_bins(1));
   CHECK_NOTHROW(s.num_bins(10));
 
+  // Correct number of jobs.
+  CHECK_NOTHROW(s.num_jobs(1));
+  CHECK_NOTHROW(s.num_jobs(4));
+  // Correct memory budget for BDD caches.
+  CHECK_NOTHROW(s.bdd_memory(1));
+  CHECK_NOTHROW(s.bdd_memory(1024));
+  // Correct work budget for merging.
+  CHECK_NOTHROW(s.merge_budget(0));
+  CHECK_NOTHROW(s.merge_budget(1000));
+
   // Correct seed.
   CHECK_NOTHROW(s.seed(1));
 
@@ -103,6 +143,10 @@ TEST_CASE("SettingsTest CorrectSetup", "[settings]") {
   CHECK_NOTHROW(s.time_step(10));
   CHECK_NOTHROW(s.time_step(1e6));
 
+  // Correct time tolerance.
+  CHECK_NOTHROW(s.time_tolerance(0));
+  CHECK_NOTHROW(s.time_tolerance(1e-6));
+
   // Correct request for the SIL.
   CHECK_NOTHROW(s.safety_integrity_levels(true));
   CHECK_NOTHROW(s.safety_integrity_levels(false));
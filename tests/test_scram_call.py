@@ -14,6 +14,7 @@
 # along with this program.  If not, see <http://www.gnu.org/licenses/>.
 """Tests to command-line SCRAM with correct and incorrect arguments."""
 
+import json
 import os
 from subprocess import call
 
@@ -77,6 +78,14 @@ def test_fta_no_prob(tmpdir):
         # Test the uncertainty
         (["--uncertainty", "true", "--num-bins", "20", "--num-quantiles", "20"],
          True),
+        (["--uncertainty", "true", "--jobs", "2"], True),
+        (["--uncertainty", "true", "--jobs", "0"], False),
+        (["--bdd-memory", "1"], True),
+        (["--bdd-memory", "0"], False),
+        (["--merge-budget", "0"], True),
+        (["--merge-budget", "-1"], False),
+        (["--reorder"], True),
+        (["--stream-input"], True),
         # Test calls for prime implicants
         (["--prime-implicants", "--mocus"], False),
         (["--prime-implicants", "--rare-event"], False),
@@ -94,6 +103,27 @@ def test_fta_calls(cmd, status):
         assert ret != 0
 
 
+def test_preprocessor_profile(tmpdir):
+    """Tests the JSON output of the preprocessor profile."""
+    profile_temp = str(tmpdir / "profile_temp.json")
+    cmd = [
+        "scram", "input/fta/correct_tree_input.xml", "--preprocessor-profile",
+        profile_temp, "-o",
+        str(tmpdir / "output_temp.xml")
+    ]
+    assert call(cmd) == 0
+    with open(profile_temp) as profile_file:
+        profile = json.load(profile_file)
+    assert len(profile["analyses"]) == 1
+    passes = profile["analyses"][0]["passes"]
+    assert passes
+    for preprocessing_pass in passes:
+        assert preprocessing_pass["changes"] >= 0
+        assert len(preprocessing_pass["gates"]) == 2
+    cmd[3] = str(tmpdir / "missing" / "profile.json")
+    assert call(cmd) != 0
+
+
 def test_config_file_output(tmpdir):
     """Tests calls with configuration files."""
     # Test with a configuration file